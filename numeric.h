@@ -10,6 +10,21 @@
 
 // Include for all subset headers.
 #include "numeric/subset/subset.h"
+#include "numeric/subset/solver_table.h"
+#include "numeric/subset/solver_arena.h"
+#include "numeric/subset/fleet_solver.h"
+#include "numeric/subset/amount_subset.h"
+#include "numeric/subset/bitset_solver.h"
+#include "numeric/subset/change_solver.h"
+#include "numeric/subset/solution_cache.h"
+#include "numeric/subset/solver_threads.h"
+#include "numeric/subset/solver_service.h"
+#include "numeric/subset/meet_middle_solver.h"
+#include "numeric/subset/solution_enumerator.h"
+#include "numeric/subset/branch_bound_solver.h"
+#include "numeric/subset/concurrent_inventory.h"
+#include "numeric/subset/even_depletion_solver.h"
+#include "numeric/subset/parallel_branch_bound.h"
 
 // Include for all decimal headers.
 #include "numeric/decimal/decimal.h"
@@ -23,14 +38,20 @@
 #include "numeric/units/hours.h"
 #include "numeric/units/miles.h"
 #include "numeric/units/speed.h"
+#include "numeric/units/power.h"
+#include "numeric/units/watts.h"
 #include "numeric/units/inches.h"
 #include "numeric/units/kmpace.h"
 #include "numeric/units/meters.h"
 #include "numeric/units/pounds.h"
+#include "numeric/units/energy.h"
+#include "numeric/units/joules.h"
 #include "numeric/units/minutes.h"
 #include "numeric/units/seconds.h"
 #include "numeric/units/milepace.h"
 #include "numeric/units/timeutil.h"
+#include "numeric/units/calendar.h"
+#include "numeric/units/quantity.h"
 #include "numeric/units/unit_math.h"
 #include "numeric/units/kilograms.h"
 #include "numeric/units/kilometers.h"
@@ -38,4 +59,6 @@
 #include "numeric/units/millimeters.h"
 #include "numeric/units/milesperhour.h"
 #include "numeric/units/milliseconds.h"
+#include "numeric/units/kilocalories.h"
+#include "numeric/units/quantity_table.h"
 #include "numeric/units/kilometersperhour.h"
@@ -0,0 +1,124 @@
+/*******************************************************************************
+
+    \file   allocation_counter.h
+
+    \brief  Heap allocation counter shared by the benchmarks.
+
+            Counting replaces the global operator new and operator delete, so
+            it is turned on in exactly one translation unit, by defining
+            UNITLIBBENCH_COUNT_ALLOCATIONS or SUBSETBENCH_COUNT_ALLOCATIONS
+            before the first benchmark header is included.  Either turns on
+            the same counter, so both benchmarks can be built together.
+
+*******************************************************************************/
+
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+// Standard Library Dependancies.
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+
+// General Dependancies.
+#include "subset/solver_threads.h"
+
+#if defined(UNITLIBBENCH_COUNT_ALLOCATIONS) || \
+    defined(SUBSETBENCH_COUNT_ALLOCATIONS)
+#define BENCH_COUNT_ALLOCATIONS
+#endif
+
+// Keeps a function out of line where the compiler allows it.
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \brief  The counter itself, atomic since solver threads allocate too.
+            It is a long, so on windows it wraps after 2^32 allocations.
+
+*******************************************************************************/
+inline solver_atomic & BenchAllocationCounter()
+{
+    static solver_atomic allocationCount;
+    return allocationCount;
+}
+
+/*******************************************************************************
+
+    \brief  Number of heap allocations made since the program started.
+
+*******************************************************************************/
+inline unsigned long long BenchAllocationCount()
+{
+    return (unsigned long) BenchAllocationCounter().Load();
+}
+
+/*******************************************************************************
+
+    \brief  True when the global operator new is counting allocations.
+
+*******************************************************************************/
+inline bool BenchCountsAllocations()
+{
+#ifdef BENCH_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+}
+
+#ifdef BENCH_COUNT_ALLOCATIONS
+// Counting replacements for the global allocation functions.
+void * operator new(size_t size)
+{
+    numeric::BenchAllocationCounter().Add(1);
+
+    void * memory = malloc(size == 0 ? 1 : size);
+    if(memory == 0) throw std::bad_alloc();
+
+    return memory;
+}
+
+void * operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+// Every delete form frees here.  Inlined into a caller, GCC would pair the
+// free() with the operator new it came from and warn under
+// -Wmismatched-new-delete, though the new above does use malloc().
+BENCH_NOINLINE void BenchFree(void * memory) throw()
+{
+    free(memory);
+}
+
+void operator delete(void * memory) throw()
+{
+    BenchFree(memory);
+}
+
+void operator delete[](void * memory) throw()
+{
+    BenchFree(memory);
+}
+
+// Sized forms, called instead of the above from C++14 on.
+void operator delete(void * memory, size_t) throw()
+{
+    BenchFree(memory);
+}
+
+void operator delete[](void * memory, size_t) throw()
+{
+    BenchFree(memory);
+}
+#endif
+
+#endif
@@ -153,6 +153,18 @@ public:
         return LLONG_MIN / (long long) pow(10.0, (double) (PRECISION + 1));
     }
 
+    // Gets the scaled integer that represents this number.
+    long long GetRawData() const
+    {
+        return data;
+    }
+
+    // Sets the scaled integer that represents this number.
+    void SetRawData(long long newData)
+    {
+        SetData(newData);
+    }
+
     // Multiplication between this object and a object of the same type.
     decimal<PRECISION> operator*(const decimal<PRECISION> & rhs) const
     {
@@ -0,0 +1,361 @@
+/*******************************************************************************
+
+    \file   amount_subset.h
+
+    \brief  Subset solver over any amount type.
+
+            Amounts are turned into 64 bit scaled integer keys by
+            amount_traits, the raw data for a decimal and the number itself
+            for the integer types.  The keys are divided by the greatest
+            common divisor of the values, so values like 500, 2500 and 10000
+            minor units solve as 1, 5 and 20 and every table is that much
+            smaller.  The int subset solver does the work, falling back to
+            its change table for targets past the block range.  Targets too
+            large for a table are solved with 64 bit sums by
+            meet_middle_solver, and by branch and bound if that gives up.
+
+*******************************************************************************/
+
+#ifndef AMOUNT_SUBSET_H
+#define AMOUNT_SUBSET_H
+
+#include <map>
+#include <vector>
+#include <climits>
+#include <algorithm>
+#include <exception>
+
+#include "subset.h"
+#include "meet_middle_solver.h"
+#include "branch_bound_solver.h"
+#include "../decimal/decimal.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  amount_traits
+
+    \brief  Turns an amount into a 64 bit key and back.  Integer types are
+            their own key.
+
+*******************************************************************************/
+template<class TAmount>
+struct amount_traits
+{
+    static long long ToKey(const TAmount & amount)
+    {
+        return (long long) amount;
+    }
+
+    static TAmount FromKey(long long key)
+    {
+        return (TAmount) key;
+    }
+};
+
+/*******************************************************************************
+
+    \class  amount_traits
+
+    \brief  A decimal is keyed by its scaled integer, so no rounding happens.
+
+*******************************************************************************/
+template<unsigned int PRECISION>
+struct amount_traits<decimal<PRECISION> >
+{
+    static long long ToKey(const decimal<PRECISION> & amount)
+    {
+        return amount.GetRawData();
+    }
+
+    static decimal<PRECISION> FromKey(long long key)
+    {
+        decimal<PRECISION> amount;
+        amount.SetRawData(key);
+        return amount;
+    }
+};
+
+/*******************************************************************************
+
+    \class  amount_subset
+
+    \brief  Solves subsets of amounts of any type amount_traits knows.
+
+            Every value, divided by the greatest common divisor of the
+            values, must fit an int, the subset solver works in ints.
+            Targets and sums may go past an int.
+
+*******************************************************************************/
+template<class TAmount>
+class amount_subset
+{
+public:
+
+    // Most bytes a change table may take.  It holds an int for every value
+    // and sum, and three more rows, see GetMaxTableTarget().
+    enum { MAX_TABLE_BYTES = 1 << 26 };
+
+    // Map of amounts to counts.
+    typedef std::map<TAmount, int> TAmountMap;
+
+    // The amounts that make up a solution.
+    typedef std::vector<TAmount> TAmountSolution;
+
+    // Constructor.
+    amount_subset(const TAmountMap & values);
+
+    // Destructor.
+    virtual ~amount_subset();
+
+    // Solves for the target, false if there is no solution.
+    bool Solve(const TAmount & target,
+               TAmountSolution & solution,
+               TSolveMode mode = SOLVE_RECURSIVE);
+
+    // Greatest common divisor of the value keys.
+    long long GetDivisor() const;
+
+    // Largest reduced target solved with a change table.
+    long long GetMaxTableTarget() const;
+
+private:
+
+    // Not copyable, owns the int solver.
+    amount_subset(const amount_subset &);
+    amount_subset & operator=(const amount_subset &);
+
+    // Greatest common divisor of two positive numbers.
+    static long long Gcd(long long a, long long b);
+
+    // Turns reduced values back into amounts.
+    void Expand(const std::vector<int> & reduced,
+                TAmountSolution & solution) const;
+
+    // Every key is a multiple of this.
+    long long divisor;
+
+    // The reduced values the solver kept, ascending, and their counts.
+    std::vector<int> denominations;
+    std::vector<int> counts;
+
+    // Sum of every number, in reduced units.
+    long long total;
+
+    // Largest reduced target whose change table fits MAX_TABLE_BYTES.
+    long long max_table_target;
+
+    // Solves the targets that fit an int.
+    subset * core;
+};
+
+/*******************************************************************************
+
+    \brief  Constructor
+
+    \param  const TAmountMap & - The values, all positive, and their counts.
+
+    \note   Throws if a reduced value does not fit an int.
+
+*******************************************************************************/
+template<class TAmount>
+inline amount_subset<TAmount>::amount_subset(const TAmountMap & values)
+    :
+    divisor(0),
+    total(0),
+    max_table_target(0),
+    core(0)
+{
+    std::vector<long long> keys;
+    std::vector<int> key_counts;
+    for(typename TAmountMap::const_iterator iter = values.begin() ;
+        iter != values.end() ;
+        ++iter)
+    {
+        const long long key = amount_traits<TAmount>::ToKey(iter->first);
+        if(key <= 0) throw std::exception();
+
+        keys.push_back(key);
+        key_counts.push_back(iter->second > 0 ? iter->second : 0);
+        divisor = Gcd(divisor, key);
+    }
+
+    if(keys.empty()) throw std::exception();
+
+    TValueMap reduced;
+    for(size_t i = 0 ; i < keys.size() ; ++i)
+    {
+        const long long value = keys[i] / divisor;
+        if(value > INT_MAX) throw std::exception();
+
+        reduced[(int) value] = key_counts[i];
+    }
+
+    core = new subset(reduced);
+
+    // The solver drops values with no count, and LeastCountSolve() answers
+    // in the order of what it kept, so the denominations come from there.
+    TValueMap kept;
+    core->GetValueMap(kept);
+    for(TValueMap::const_iterator iter = kept.begin() ;
+        iter != kept.end() ;
+        ++iter)
+    {
+        denominations.push_back(iter->first);
+        counts.push_back(iter->second);
+
+        // Only an upper bound, so saturate rather than overflow.
+        const long long sum = (long long) iter->first * iter->second;
+        total = (total > LLONG_MAX - sum) ? LLONG_MAX : total + sum;
+    }
+
+    // One row of sums per value, and the best, previous and window rows.
+    const long long row_bytes =
+        (long long) (denominations.size() + 3) * (long long) sizeof(int);
+    max_table_target = std::min((long long) MAX_TABLE_BYTES / row_bytes - 1,
+                                (long long) INT_MAX);
+}
+
+/*******************************************************************************
+
+    \brief  Destructor
+
+*******************************************************************************/
+template<class TAmount>
+inline amount_subset<TAmount>::~amount_subset()
+{
+    delete core;
+}
+
+/*******************************************************************************
+
+    \brief  Greatest common divisor, gcd(0, b) is b.
+
+*******************************************************************************/
+template<class TAmount>
+inline long long amount_subset<TAmount>::Gcd(long long a, long long b)
+{
+    while(b != 0)
+    {
+        const long long remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+
+    return a;
+}
+
+/*******************************************************************************
+
+    \brief  Turns reduced values back into amounts.
+
+*******************************************************************************/
+template<class TAmount>
+inline void amount_subset<TAmount>::Expand(const std::vector<int> & reduced,
+                                           TAmountSolution & solution) const
+{
+    solution.clear();
+    for(size_t i = 0 ; i < reduced.size() ; ++i)
+    {
+        solution.push_back(
+            amount_traits<TAmount>::FromKey(reduced[i] * divisor));
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Solves for the target.
+
+    \param  const TAmount & - The target amount.
+    \param  TAmountSolution & - The amounts that sum to the target.
+    \param  TSolveMode - How AnilaoSolve() searches the whole block.
+
+    \return bool - True if a solution was found.
+
+    \note   Targets past GetMaxTableTarget() that AnilaoSolve() misses are
+            solved by meet_middle_solver.  If it gives up, past about 50
+            values with a count of one, branch and bound searches targets
+            that fit an int, and larger targets return false.
+
+*******************************************************************************/
+template<class TAmount>
+inline bool amount_subset<TAmount>::Solve(const TAmount & target,
+                                          TAmountSolution & solution,
+                                          TSolveMode mode)
+{
+    solution.clear();
+
+    const long long key = amount_traits<TAmount>::ToKey(target);
+    if(key == 0) return true;
+    if(key < 0 || key % divisor != 0) return false;
+
+    const long long reduced = key / divisor;
+    if(reduced > total) return false;
+
+    std::vector<int> found;
+    if(reduced <= INT_MAX)
+    {
+        found = core->AnilaoSolve((int) reduced, mode);
+    }
+
+    // Past the block range, or past an int.
+    std::vector<int> solution_counts;
+    if(found.empty() && reduced <= max_table_target)
+    {
+        solution_counts = core->LeastCountSolve((int) reduced);
+        if(solution_counts.empty()) return false;
+    }
+    else if(found.empty())
+    {
+        meet_middle_solver solver;
+        solver.Solve(denominations, counts, reduced, solution_counts);
+        if(solver.GaveUp() && reduced <= INT_MAX)
+        {
+            bool optimal = true;
+            branch_bound_solver searcher;
+            searcher.Solve(denominations,
+                           counts,
+                           (int) reduced,
+                           solve_budget(),
+                           solution_counts,
+                           optimal);
+        }
+
+        if(solution_counts.empty()) return false;
+    }
+
+    for(size_t i = 0 ; i < solution_counts.size() ; ++i)
+    {
+        found.insert(found.end(), solution_counts[i], denominations[i]);
+    }
+
+    Expand(found, solution);
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+template<class TAmount>
+inline long long amount_subset<TAmount>::GetDivisor() const
+{
+    return divisor;
+}
+
+/*******************************************************************************
+
+    \brief  Largest reduced target solved with a change table.  Bigger
+            targets go to meet_middle_solver.
+
+*******************************************************************************/
+template<class TAmount>
+inline long long amount_subset<TAmount>::GetMaxTableTarget() const
+{
+    return max_table_target;
+}
+}
+
+#endif
@@ -0,0 +1,196 @@
+/*******************************************************************************
+
+    \file   bitset_solver.h
+
+    \brief  Bounded subset sum solver using word parallel reachability.
+
+            Reachable sums are kept as a bitset, 64 sums per word.  Adding an
+            item is a shift-or of the whole bitset, so n items against a
+            target cost O(n * target / 64).  The first item that made each sum
+            reachable is recorded so one subset can be rebuilt afterwards.
+
+*******************************************************************************/
+
+#ifndef BITSET_SOLVER_H
+#define BITSET_SOLVER_H
+
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  bitset_solver
+
+    \brief  Finds a group of items, each used at most once, that sums to a
+            target number.
+
+*******************************************************************************/
+class bitset_solver
+{
+private:
+
+    // One word of the reachability bitset.
+    typedef unsigned long long TWord;
+
+    // Number of sums held by one word.
+    enum { WORD_BITS = 64 };
+
+    // Bit i is set when the sum i can be made from the items seen so far.
+    std::vector<TWord> reachable;
+
+    // For each sum, the index of the item that first made it reachable.
+    std::vector<int> parent;
+
+    // The items, largest first.
+    std::vector<int> items;
+
+public:
+
+    // Constructor.
+    bitset_solver();
+
+    // Destructor.
+    virtual ~bitset_solver();
+
+    // Solves for the target, returns false if no subset sums to it.
+    bool Solve(const std::vector<int> & numbers,
+               int target,
+               std::vector<int> & solution);
+
+private:
+
+    // Index of the lowest set bit of a non zero word.
+    static int LowestBit(TWord word);
+};
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline bitset_solver::bitset_solver() {}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline bitset_solver::~bitset_solver() {}
+
+/*******************************************************************************
+
+    \brief  Index of the lowest set bit of a non zero word.
+
+*******************************************************************************/
+inline int bitset_solver::LowestBit(TWord word)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int index = 0;
+    while((word & 1ULL) == 0)
+    {
+        word >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+/*******************************************************************************
+
+    \brief  Solves for the target.
+
+    \param  const std::vector<int> & - The items, each may be used once.
+    \param  int - The target number.
+    \param  std::vector<int> & - The items that sum to the target, smallest
+                                 first.  Empty if there is no solution.
+
+    \return bool - True if a solution was found.
+
+*******************************************************************************/
+inline bool bitset_solver::Solve(const std::vector<int> & numbers,
+                                 int target,
+                                 std::vector<int> & solution)
+{
+    solution.clear();
+
+    if(target < 0) return false;
+    if(target == 0) return true;
+
+    // Large items first, the first path found to a sum then tends to use
+    // fewer items.
+    items.assign(numbers.begin(), numbers.end());
+    std::sort(items.begin(), items.end(), std::greater<int>());
+
+    const size_t word_count = (size_t) target / WORD_BITS + 1;
+    const int last_bits = (target % WORD_BITS) + 1;
+    const TWord last_mask = last_bits == WORD_BITS ?
+                            ~0ULL : ((1ULL << last_bits) - 1ULL);
+
+    reachable.assign(word_count, 0ULL);
+    parent.assign((size_t) target + 1, -1);
+
+    // The empty subset reaches zero.
+    reachable[0] = 1ULL;
+
+    for(size_t i = 0 ; i < items.size() ; ++i)
+    {
+        const int value = items[i];
+
+        // Items that are too large or not positive can never be part of
+        // the solution.
+        if(value <= 0 || value > target) continue;
+
+        const size_t word_shift = (size_t) value / WORD_BITS;
+        const int bit_shift = value % WORD_BITS;
+
+        // Walk from the top down so every word is shifted from the old
+        // values, each item is then used at most once.
+        for(size_t w = word_count ; w-- > word_shift ; )
+        {
+            TWord shifted = reachable[w - word_shift] << bit_shift;
+            if(bit_shift != 0 && w > word_shift)
+            {
+                shifted |= reachable[w - word_shift - 1] >>
+                           (WORD_BITS - bit_shift);
+            }
+
+            if(w == word_count - 1) shifted &= last_mask;
+
+            // Record the item for every sum it made reachable.
+            TWord fresh = shifted & ~reachable[w];
+            while(fresh != 0)
+            {
+                parent[w * WORD_BITS + LowestBit(fresh)] = (int) i;
+                fresh &= fresh - 1;
+            }
+
+            reachable[w] |= shifted;
+        }
+
+        // Stop as soon as the target is reachable.
+        if(parent[target] >= 0) break;
+    }
+
+    if(parent[target] < 0) return false;
+
+    // Each sum was first reached by adding an item to a sum that was
+    // reachable with earlier items only, so the walk uses every item once.
+    for(int sum = target ; sum > 0 ; )
+    {
+        const int value = items[parent[sum]];
+        solution.push_back(value);
+        sum -= value;
+    }
+
+    std::sort(solution.begin(), solution.end());
+
+    return true;
+}
+}
+
+#endif
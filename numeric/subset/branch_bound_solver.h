@@ -0,0 +1,304 @@
+/*******************************************************************************
+
+    \file   branch_bound_solver.h
+
+    \brief  Anytime branch and bound search for the fewest numbers that sum
+            to a target.
+
+            Values are tried largest first and counts highest first, so a
+            solution with few numbers is usually found early.  Branches are
+            cut when the sum left is more than the smaller values can hold,
+            or when even using the largest value left for the rest cannot
+            beat the best so far.  The search stops when its budget runs out
+            and hands back the best it has, with a flag saying whether the
+            whole tree was covered.
+
+*******************************************************************************/
+
+#ifndef BRANCH_BOUND_SOLVER_H
+#define BRANCH_BOUND_SOLVER_H
+
+#include <ctime>
+#include <vector>
+#include <climits>
+#include <algorithm>
+#include <exception>
+
+#ifdef _WIN32
+   #include <windows.h>
+#endif
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \brief  Limits on how long a search may run.  Zero means no limit.
+
+*******************************************************************************/
+struct solve_budget
+{
+    // Wall clock limit in microseconds.
+    unsigned long long microseconds;
+
+    // Most search nodes to visit.
+    unsigned long long operations;
+
+    solve_budget(unsigned long long budget_microseconds = 0,
+                 unsigned long long budget_operations = 0)
+        :
+        microseconds(budget_microseconds),
+        operations(budget_operations)
+    {}
+};
+
+/*******************************************************************************
+
+    \class  branch_bound_solver
+
+    \brief  Fewest numbers with bounded counts, within a budget.
+
+*******************************************************************************/
+class branch_bound_solver
+{
+private:
+
+    // Nodes between clock reads.
+    enum { CLOCK_INTERVAL = 1024 };
+
+    // The distinct values, ascending, and how many of each can be used.
+    std::vector<int> denominations;
+    std::vector<int> limits;
+
+    // Sum the values up to and including an index can hold.
+    std::vector<long long> capacity;
+
+    // Counts on the current branch and of the best solution.
+    std::vector<int> current;
+    std::vector<int> best;
+
+    // Numbers in the best solution, INT_MAX until one is found.
+    int best_items;
+
+    // Nodes visited.
+    unsigned long long operations;
+
+    // Budget of the running search.
+    solve_budget limit;
+    unsigned long long start_time;
+
+    // True once the budget ran out.
+    bool stopped;
+
+public:
+
+    // Constructor.
+    branch_bound_solver();
+
+    // Destructor.
+    virtual ~branch_bound_solver();
+
+    // Searches within the budget, false if no solution was found.
+    bool Solve(const std::vector<int> & values,
+               const std::vector<int> & counts,
+               int target,
+               const solve_budget & budget,
+               std::vector<int> & solution_counts,
+               bool & optimal);
+
+    // Nodes visited by the last Solve().
+    unsigned long long GetOperations() const;
+
+    // Monotonic clock in microseconds.
+    static unsigned long long Now();
+
+private:
+
+    // Tries every count of the value at index, then the smaller values.
+    void Search(int index, int sum_left, int items);
+
+    // Counts one node, true when the budget has run out.
+    bool IsOutOfBudget();
+};
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline branch_bound_solver::branch_bound_solver()
+    :
+    best_items(INT_MAX),
+    operations(0),
+    start_time(0),
+    stopped(false)
+{}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline branch_bound_solver::~branch_bound_solver() {}
+
+/*******************************************************************************
+
+    \brief  Monotonic clock in microseconds.
+
+*******************************************************************************/
+inline unsigned long long branch_bound_solver::Now()
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (unsigned long long) (counter.QuadPart * 1000000LL /
+                                 frequency.QuadPart);
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long) now.tv_sec * 1000000ULL +
+           (unsigned long long) now.tv_nsec / 1000ULL;
+#endif
+}
+
+/*******************************************************************************
+
+    \brief  Nodes visited by the last Solve().
+
+*******************************************************************************/
+inline unsigned long long branch_bound_solver::GetOperations() const
+{
+    return operations;
+}
+
+/*******************************************************************************
+
+    \brief  Counts one node, true when the budget has run out.
+
+*******************************************************************************/
+inline bool branch_bound_solver::IsOutOfBudget()
+{
+    ++operations;
+
+    if(limit.operations != 0 && operations > limit.operations)
+    {
+        stopped = true;
+    }
+    else if(limit.microseconds != 0 && operations % CLOCK_INTERVAL == 0 &&
+            Now() - start_time >= limit.microseconds)
+    {
+        stopped = true;
+    }
+
+    return stopped;
+}
+
+/*******************************************************************************
+
+    \brief  Searches within the budget.
+
+    \param  const std::vector<int> & - The distinct values, ascending.
+    \param  const std::vector<int> & - How many of each value can be used.
+    \param  int - The target number.
+    \param  const solve_budget & - How long the search may run.
+    \param  std::vector<int> & - Counts of the best solution found, in the
+                                 order of the values.
+    \param  bool & - True if the search finished, the solution then has the
+                     fewest numbers, or there is none.
+
+    \return bool - True if a solution was found.
+
+*******************************************************************************/
+inline bool branch_bound_solver::Solve(const std::vector<int> & values,
+                                       const std::vector<int> & counts,
+                                       int target,
+                                       const solve_budget & budget,
+                                       std::vector<int> & solution_counts,
+                                       bool & optimal)
+{
+    if(values.size() != counts.size()) throw std::exception();
+
+    denominations = values;
+    limits = counts;
+    capacity.assign(values.size(), 0);
+
+    long long held = 0;
+    for(size_t i = 0 ; i < values.size() ; ++i)
+    {
+        if(values[i] <= 0 || (i > 0 && values[i] <= values[i - 1]))
+        {
+            throw std::exception();
+        }
+
+        if(limits[i] < 0) limits[i] = 0;
+
+        held += (long long) values[i] * limits[i];
+        capacity[i] = held;
+    }
+
+    current.assign(values.size(), 0);
+    best.clear();
+    best_items = INT_MAX;
+    operations = 0;
+    limit = budget;
+    start_time = Now();
+    stopped = false;
+
+    if(target >= 0) Search((int) values.size() - 1, target, 0);
+
+    optimal = !stopped;
+
+    if(best_items == INT_MAX)
+    {
+        solution_counts.clear();
+        return false;
+    }
+
+    solution_counts = best;
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief  Tries every count of the value at index, highest first, then the
+            smaller values.
+
+    \param  int - Index of the value to choose a count for.
+    \param  int - Sum still needed.
+    \param  int - Numbers used so far.
+
+*******************************************************************************/
+inline void branch_bound_solver::Search(int index, int sum_left, int items)
+{
+    if(IsOutOfBudget()) return;
+
+    if(sum_left == 0)
+    {
+        if(items < best_items)
+        {
+            best_items = items;
+            best = current;
+        }
+        return;
+    }
+
+    // Nothing left to use, or not enough left to reach the sum.
+    if(index < 0 || sum_left > capacity[index]) return;
+
+    // Even the largest value left for the rest cannot beat the best.
+    const int value = denominations[index];
+    const int fewest = (sum_left + value - 1) / value;
+    if(best_items != INT_MAX && items + fewest >= best_items) return;
+
+    const int most = std::min(limits[index], sum_left / value);
+    for(int count = most ; count >= 0 && !stopped ; --count)
+    {
+        current[index] = count;
+        Search(index - 1, sum_left - count * value, items + count);
+    }
+
+    current[index] = 0;
+}
+}
+
+#endif
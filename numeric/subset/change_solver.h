@@ -0,0 +1,278 @@
+/*******************************************************************************
+
+    \file   change_solver.h
+
+    \brief  Bounded change making solver.
+
+            Finds the fewest numbers that sum to a target when each value can
+            only be used up to its count.  Values are added one at a time;
+            for a value v with count c the new table is
+
+                best'[s] = min over 0 <= k <= c of best[s - k * v] + k
+
+            Sums that share a remainder modulo v form a chain, and along each
+            chain this is a sliding window minimum.  A monotone queue answers
+            each window in amortized constant time, so the whole solve is
+            O(distinct values * target) regardless of the counts.
+
+*******************************************************************************/
+
+#ifndef CHANGE_SOLVER_H
+#define CHANGE_SOLVER_H
+
+#include <vector>
+#include <climits>
+#include <exception>
+
+#include "branch_bound_solver.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  change_solver
+
+    \brief  Minimum number of items change making with bounded counts.
+
+*******************************************************************************/
+class change_solver
+{
+private:
+
+    // Marks a sum that cannot be reached.
+    enum { UNREACHABLE = INT_MAX };
+
+    // Sums filled between looks at the clock when Build() has a deadline.
+    enum { DEADLINE_CHECK_SUMS = 1 << 16 };
+
+    // Fewest numbers needed for each sum with the values added so far.
+    std::vector<int> best;
+
+    // The table before the current value was added.
+    std::vector<int> previous;
+
+    // For each value and sum, how many of that value the best uses.
+    std::vector<int> taken;
+
+    // Monotone queue of chain positions.
+    std::vector<int> window;
+
+    // Values the tables were built for.
+    std::vector<int> table_values;
+
+    // Largest sum the tables cover.
+    int table_target;
+
+public:
+
+    // Constructor.
+    change_solver();
+
+    // Destructor.
+    virtual ~change_solver();
+
+    // Builds the tables for every sum up to the target, false if the
+    // deadline passed first.  Zero is no deadline.
+    bool Build(const std::vector<int> & values,
+               const std::vector<int> & counts,
+               int target,
+               unsigned long long deadline = 0);
+
+    // Solves for a target covered by the last Build().
+    bool Lookup(int target, std::vector<int> & solution_counts) const;
+
+    // Fewest numbers for a target covered by the last Build(), -1 if none.
+    int GetLeastCount(int target) const;
+
+    // Builds the tables and solves for the target.
+    bool Solve(const std::vector<int> & values,
+               const std::vector<int> & counts,
+               int target,
+               std::vector<int> & solution_counts);
+};
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline change_solver::change_solver() : table_target(-1) {}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline change_solver::~change_solver() {}
+
+/*******************************************************************************
+
+    \brief  Builds the tables for every sum up to the target.
+
+    \param  const std::vector<int> & - The values, all positive.
+    \param  const std::vector<int> & - How many of each value can be used.
+    \param  int - The largest sum to solve for.
+    \param  unsigned long long - branch_bound_solver::Now() to stop at, zero
+                                 for no limit.
+
+    \return bool - False if the deadline passed, the tables then cover no
+                   sums.
+
+*******************************************************************************/
+inline bool change_solver::Build(const std::vector<int> & values,
+                                 const std::vector<int> & counts,
+                                 int target,
+                                 unsigned long long deadline)
+{
+    if(values.size() != counts.size() || target < 0) throw std::exception();
+
+    const size_t sums = (size_t) target + 1;
+
+    table_values = values;
+    table_target = target;
+
+    // Only the empty sum is reachable before any value is added.
+    best.assign(sums, (int) UNREACHABLE);
+    best[0] = 0;
+    taken.assign(values.size() * sums, 0);
+    window.resize(sums);
+
+    size_t until_check = DEADLINE_CHECK_SUMS;
+    for(size_t d = 0 ; d < values.size() ; ++d)
+    {
+        const int value = values[d];
+        const int count = counts[d];
+
+        if(value <= 0) throw std::exception();
+        if(count <= 0 || value > target) continue;
+
+        previous = best;
+        int * take = &taken[d * sums];
+
+        // Walk each chain of sums that share a remainder modulo the value.
+        for(int remainder = 0 ;
+            remainder < value && remainder <= target ;
+            ++remainder)
+        {
+            size_t head = 0;
+            size_t tail = 0;
+
+            for(int j = 0, sum = remainder ; sum <= target ; ++j, sum += value)
+            {
+                if(deadline != 0 && --until_check == 0)
+                {
+                    until_check = DEADLINE_CHECK_SUMS;
+                    if(branch_bound_solver::Now() >= deadline)
+                    {
+                        table_target = -1;
+                        return false;
+                    }
+                }
+
+                // Chain position j costs previous[sum] - j, the window holds
+                // the positions within count of j with the lowest cost.
+                if(previous[sum] != (int) UNREACHABLE)
+                {
+                    const int cost = previous[sum] - j;
+                    while(tail > head)
+                    {
+                        const int back = window[tail - 1];
+                        const int back_sum = remainder + back * value;
+                        if(previous[back_sum] - back < cost) break;
+                        --tail;
+                    }
+                    window[tail++] = j;
+                }
+
+                // Drop positions that would need more than count items.
+                while(tail > head && window[head] < j - count) ++head;
+
+                if(tail > head)
+                {
+                    const int front = window[head];
+                    best[sum] = previous[remainder + front * value] - front + j;
+                    take[sum] = j - front;
+                }
+                else
+                {
+                    best[sum] = (int) UNREACHABLE;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief  Fewest numbers for a target covered by the last Build().
+
+*******************************************************************************/
+inline int change_solver::GetLeastCount(int target) const
+{
+    if(target < 0 || target > table_target) throw std::exception();
+
+    return best[target] == (int) UNREACHABLE ? -1 : best[target];
+}
+
+/*******************************************************************************
+
+    \brief  Solves for a target covered by the last Build().
+
+    \param  int - The target number.
+    \param  std::vector<int> & - How many of each value are used, in the same
+                                 order as the values.
+
+    \return bool - True if a solution was found.
+
+*******************************************************************************/
+inline bool change_solver::Lookup(int target,
+                                  std::vector<int> & solution_counts) const
+{
+    solution_counts.assign(table_values.size(), 0);
+
+    if(GetLeastCount(target) < 0)
+    {
+        solution_counts.clear();
+        return false;
+    }
+
+    // Peel the values off in the reverse order they were added.
+    const size_t sums = (size_t) table_target + 1;
+    int sum = target;
+    for(size_t d = table_values.size() ; d-- > 0 && sum > 0 ; )
+    {
+        // Values skipped by Build() never wrote their take table.
+        if(table_values[d] > table_target) continue;
+
+        const int count = taken[d * sums + sum];
+        solution_counts[d] = count;
+        sum -= count * table_values[d];
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief  Builds the tables and solves for the target.
+
+*******************************************************************************/
+inline bool change_solver::Solve(const std::vector<int> & values,
+                                 const std::vector<int> & counts,
+                                 int target,
+                                 std::vector<int> & solution_counts)
+{
+    if(target < 0)
+    {
+        solution_counts.clear();
+        return false;
+    }
+
+    Build(values, counts, target);
+    return Lookup(target, solution_counts);
+}
+}
+
+#endif
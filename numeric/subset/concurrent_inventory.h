@@ -0,0 +1,434 @@
+/*******************************************************************************
+
+    \file   concurrent_inventory.h
+
+    \brief  Inventory that several threads can dispense from at once.
+
+            Each value's count is a solver_atomic.  A dispense reads the
+            counts, solves against that snapshot with no lock held, then
+            reserves what the solution needs one value at a time with a
+            compare and swap that refuses to take a count below zero.  If
+            another thread got there first the values already reserved are
+            put back and the dispense solves again against fresh counts.
+            Counts can never be oversubscribed, and threads only wait on each
+            other when they actually want the same units.
+
+            Every change to the counts is bracketed by the writers and
+            version counters, so a snapshot that saw no writer and no version
+            change is one the counts really held, and "no solution" from it
+            is a true answer, not a half done reservation.  A dispense gives
+            up after MAX_DISPENSE_ATTEMPTS, backing off between attempts, and
+            says so with DISPENSE_CONTENDED so the caller can try again
+            rather than take it for "no solution".
+
+            The set of values is fixed when the inventory is made, a count may
+            drop to zero and come back.
+
+*******************************************************************************/
+
+#ifndef CONCURRENT_INVENTORY_H
+#define CONCURRENT_INVENTORY_H
+
+#include <vector>
+#include <exception>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sched.h>
+#endif
+
+#include "subset.h"
+#include "solver_threads.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \brief  How a dispense went.
+
+            DISPENSE_OK          - The solution is reserved.
+            DISPENSE_NO_SOLUTION - Counts the inventory really held have no
+                                   solution for the target.
+            DISPENSE_CONTENDED   - Other threads kept changing the counts
+                                   for MAX_DISPENSE_ATTEMPTS, there may well
+                                   be a solution.
+
+*******************************************************************************/
+enum TDispenseStatus
+{
+    DISPENSE_OK = 0,
+    DISPENSE_NO_SOLUTION = 1,
+    DISPENSE_CONTENDED = 2
+};
+
+/*******************************************************************************
+
+    \class  concurrent_inventory
+
+    \brief  Thread safe counts with optimistic solve and atomic reservation.
+
+*******************************************************************************/
+class concurrent_inventory
+{
+public:
+
+    // Snapshots and reservations a dispense tries before giving up.
+    enum { MAX_DISPENSE_ATTEMPTS = 64 };
+
+    // Constructor.
+    concurrent_inventory(const TValueMap & values);
+
+    // Destructor.
+    virtual ~concurrent_inventory();
+
+    // Gets the current counts, values at zero included, false if a
+    // reservation or deposit was under way and the counts may not agree.
+    bool GetSnapshot(TValueMap & snapshot) const;
+
+    // Solves and reserves the numbers, see TDispenseStatus.
+    TDispenseStatus Dispense(int target,
+                             TSolution & solution,
+                             TSolveMode mode = SOLVE_RECURSIVE);
+
+    // Reserves exactly these numbers, false if there are not enough.
+    bool Reserve(const TSolution & solution);
+
+    // Adds numbers of a value that the inventory holds.
+    void Deposit(int value, int count);
+
+    // Reservations that had to be retried.
+    unsigned long long GetConflicts() const;
+
+    // Dispenses that gave up after MAX_DISPENSE_ATTEMPTS.
+    unsigned long long GetAbandoned() const;
+
+private:
+
+    // Not copyable, threads hold it by address.
+    concurrent_inventory(const concurrent_inventory &);
+    concurrent_inventory & operator=(const concurrent_inventory &);
+
+    // Index of a value, -1 if the inventory does not hold it.
+    int FindValue(int value) const;
+
+    // Takes count from one value unless that would go below zero.
+    bool TryTake(size_t index, long count);
+
+    // Reserves per value counts, all or nothing.
+    bool ReserveCounts(const std::vector<long> & needed);
+
+    // Brackets a change to the counts.
+    void BeginWrite();
+    void EndWrite();
+
+    // Gives other threads a turn, longer for later attempts.
+    static void Backoff(unsigned attempt);
+
+    // The values, ascending.
+    std::vector<int> denominations;
+
+    // One count per value.
+    solver_atomic * counts;
+
+    // Changes to the counts under way, and finished.
+    solver_atomic writers;
+    solver_atomic version;
+
+    // Reservations that lost a race.
+    solver_atomic conflicts;
+
+    // Dispenses that ran out of attempts.
+    solver_atomic abandoned;
+};
+
+/*******************************************************************************
+
+    \brief  Constructor
+
+    \param  const TValueMap & - The values and their starting counts.
+
+*******************************************************************************/
+inline concurrent_inventory::concurrent_inventory(const TValueMap & values)
+    :
+    counts(0),
+    writers(0),
+    version(0),
+    conflicts(0),
+    abandoned(0)
+{
+    for(TValueMap::const_iterator iter = values.begin() ;
+        iter != values.end() ;
+        ++iter)
+    {
+        if(iter->first <= 0) throw std::exception();
+        denominations.push_back(iter->first);
+    }
+
+    if(denominations.empty()) throw std::exception();
+
+    counts = new solver_atomic[denominations.size()];
+
+    size_t index = 0;
+    for(TValueMap::const_iterator iter = values.begin() ;
+        iter != values.end() ;
+        ++iter, ++index)
+    {
+        counts[index].Store(std::max(iter->second, 0));
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Destructor
+
+*******************************************************************************/
+inline concurrent_inventory::~concurrent_inventory()
+{
+    delete [] counts;
+}
+
+/*******************************************************************************
+
+    \brief  Gets the current counts.
+
+    \return bool - True if no change to the counts overlapped the read, so
+                   the snapshot is counts the inventory really held.
+
+*******************************************************************************/
+inline bool concurrent_inventory::GetSnapshot(TValueMap & snapshot) const
+{
+    const long before = version.Load();
+    const bool idle = writers.Load() == 0;
+
+    snapshot.clear();
+    for(size_t i = 0 ; i < denominations.size() ; ++i)
+    {
+        snapshot[denominations[i]] = (int) counts[i].Load();
+    }
+
+    // A writer bumps the version before it leaves, so one that started
+    // after the first check is still counted here or has moved the version.
+    return idle && writers.Load() == 0 && version.Load() == before;
+}
+
+/*******************************************************************************
+
+    \brief  Starts a change to the counts, see GetSnapshot().
+
+*******************************************************************************/
+inline void concurrent_inventory::BeginWrite()
+{
+    writers.Add(1);
+}
+
+/*******************************************************************************
+
+    \brief  Ends a change to the counts.  The version moves before the
+            writer count drops.
+
+*******************************************************************************/
+inline void concurrent_inventory::EndWrite()
+{
+    version.Add(1);
+    writers.Add(-1);
+}
+
+/*******************************************************************************
+
+    \brief  Yields the processor, twice as many times for each attempt up to
+            64.
+
+*******************************************************************************/
+inline void concurrent_inventory::Backoff(unsigned attempt)
+{
+    const unsigned yields = 1u << std::min(attempt, 6u);
+    for(unsigned i = 0 ; i < yields ; ++i)
+    {
+#ifdef _WIN32
+        SwitchToThread();
+#else
+        sched_yield();
+#endif
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Index of a value, -1 if the inventory does not hold it.
+
+*******************************************************************************/
+inline int concurrent_inventory::FindValue(int value) const
+{
+    std::vector<int>::const_iterator found =
+        std::lower_bound(denominations.begin(), denominations.end(), value);
+
+    if(found == denominations.end() || *found != value) return -1;
+
+    return (int) (found - denominations.begin());
+}
+
+/*******************************************************************************
+
+    \brief  Takes count from one value unless that would go below zero.
+
+*******************************************************************************/
+inline bool concurrent_inventory::TryTake(size_t index, long count)
+{
+    long seen = counts[index].Load();
+    while(seen >= count)
+    {
+        if(counts[index].CompareExchange(seen, seen - count)) return true;
+        seen = counts[index].Load();
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+
+    \brief  Reserves per value counts, all or nothing.
+
+*******************************************************************************/
+inline bool concurrent_inventory::ReserveCounts(
+    const std::vector<long> & needed)
+{
+    BeginWrite();
+
+    for(size_t i = 0 ; i < needed.size() ; ++i)
+    {
+        if(needed[i] == 0 || TryTake(i, needed[i])) continue;
+
+        // Put back what was already taken.
+        for(size_t j = 0 ; j < i ; ++j)
+        {
+            if(needed[j] != 0) counts[j].Add(needed[j]);
+        }
+
+        EndWrite();
+        return false;
+    }
+
+    EndWrite();
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief  Reserves exactly these numbers.
+
+    \return bool - False if any value does not have enough left, nothing is
+                   reserved then.
+
+*******************************************************************************/
+inline bool concurrent_inventory::Reserve(const TSolution & solution)
+{
+    std::vector<long> needed(denominations.size(), 0);
+    for(size_t i = 0 ; i < solution.size() ; ++i)
+    {
+        const int index = FindValue(solution[i]);
+        if(index < 0) return false;
+        ++needed[index];
+    }
+
+    return ReserveCounts(needed);
+}
+
+/*******************************************************************************
+
+    \brief  Solves against a snapshot and reserves the numbers, solving again
+            if another thread took them first.
+
+    \param  int - The target number.
+    \param  TSolution & - The numbers reserved.
+    \param  TSolveMode - How AnilaoSolve() searches the whole block.
+
+    \return TDispenseStatus - DISPENSE_OK, DISPENSE_NO_SOLUTION if the
+                              counts have no solution for the target, or
+                              DISPENSE_CONTENDED after MAX_DISPENSE_ATTEMPTS
+                              lost races, see GetAbandoned().
+
+*******************************************************************************/
+inline TDispenseStatus concurrent_inventory::Dispense(int target,
+                                                      TSolution & solution,
+                                                      TSolveMode mode)
+{
+    TValueMap snapshot;
+
+    for(unsigned attempt = 0 ; attempt < MAX_DISPENSE_ATTEMPTS ; ++attempt)
+    {
+        if(attempt != 0) Backoff(attempt);
+
+        solution.clear();
+        const bool consistent = GetSnapshot(snapshot);
+
+        // No lock is held while solving.
+        try
+        {
+            subset local(snapshot);
+            solution = local.AnilaoSolve(target, mode);
+        }
+        catch(...)
+        {
+            // Nothing left to solve with, or the solver gave up.
+            solution.clear();
+        }
+
+        if(solution.empty())
+        {
+            // Only trusted if no reservation was half done during the read.
+            if(consistent)
+            {
+                return target == 0 ? DISPENSE_OK : DISPENSE_NO_SOLUTION;
+            }
+
+            conflicts.Add(1);
+            continue;
+        }
+
+        if(Reserve(solution)) return DISPENSE_OK;
+
+        conflicts.Add(1);
+    }
+
+    solution.clear();
+    abandoned.Add(1);
+    return DISPENSE_CONTENDED;
+}
+
+/*******************************************************************************
+
+    \brief  Adds numbers of a value that the inventory holds.
+
+*******************************************************************************/
+inline void concurrent_inventory::Deposit(int value, int count)
+{
+    const int index = FindValue(value);
+    if(index < 0 || count < 0) throw std::exception();
+
+    BeginWrite();
+    counts[index].Add(count);
+    EndWrite();
+}
+
+/*******************************************************************************
+
+    \brief  Reservations that had to be retried.
+
+*******************************************************************************/
+inline unsigned long long concurrent_inventory::GetConflicts() const
+{
+    return (unsigned long long) conflicts.Load();
+}
+
+/*******************************************************************************
+
+    \brief  Dispenses that gave up after MAX_DISPENSE_ATTEMPTS.
+
+*******************************************************************************/
+inline unsigned long long concurrent_inventory::GetAbandoned() const
+{
+    return (unsigned long long) abandoned.Load();
+}
+}
+
+#endif
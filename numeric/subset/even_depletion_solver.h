@@ -0,0 +1,290 @@
+/*******************************************************************************
+
+    \file   even_depletion_solver.h
+
+    \brief  Solver that depletes the values as evenly as possible.
+
+            Using x of a value that has c left draws it down by x / c.  The
+            solver finds the exact sum whose largest drawdown is the lowest,
+            and among those the one with the fewest numbers.
+
+            A drawdown limit t allows floor(t * c) of each value, and whether
+            the target can be made under those caps only gets easier as t
+            grows.  The only limits worth trying are the fractions k / c, so a
+            heap merges the fractions of every value into one ascending list,
+            handed out lazily.  The search gallops through that list, doubling
+            its step until a limit is feasible, then binary searches the last
+            step.  Each check is one bounded change table, O(distinct values
+            * target), and only O(log n) checks are made for n candidate
+            limits.
+
+*******************************************************************************/
+
+#ifndef EVEN_DEPLETION_SOLVER_H
+#define EVEN_DEPLETION_SOLVER_H
+
+#include <queue>
+#include <vector>
+#include <exception>
+
+#include "change_solver.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  even_depletion_solver
+
+    \brief  Minimizes the largest drawdown of any value for an exact sum.
+
+*******************************************************************************/
+class even_depletion_solver
+{
+private:
+
+    // A drawdown limit, numerator over denominator, and the value whose
+    // next fraction it is.
+    struct fraction
+    {
+        long long numerator;
+        long long denominator;
+        size_t value;
+
+        // Ordered so std::priority_queue hands out the smallest first.
+        bool operator<(const fraction & other) const
+        {
+            return numerator * other.denominator >
+                   other.numerator * denominator;
+        }
+
+        bool operator==(const fraction & other) const
+        {
+            return numerator * other.denominator ==
+                   other.numerator * denominator;
+        }
+    };
+
+    // The values and how many of each there are.
+    std::vector<int> denominations;
+    std::vector<int> limits;
+
+    // Next fraction of every value not yet handed out.
+    std::priority_queue<fraction> pending;
+
+    // The distinct limits handed out so far, ascending.
+    std::vector<fraction> candidates;
+
+    // Caps and table for one check.
+    std::vector<int> caps;
+    change_solver solver;
+
+    // The target number.
+    int target;
+
+    // Drawdown of the last solution.
+    fraction drawdown;
+
+public:
+
+    // Constructor.
+    even_depletion_solver();
+
+    // Destructor.
+    virtual ~even_depletion_solver();
+
+    // Solves for the target, false if no combination sums to it.
+    bool Solve(const std::vector<int> & values,
+               const std::vector<int> & counts,
+               int target_number,
+               std::vector<int> & solution_counts);
+
+    // Largest drawdown of the last solution, from 0 to 1.
+    double GetDrawdown() const;
+
+private:
+
+    // Makes sure the candidate at an index has been handed out.
+    bool HasCandidate(size_t index);
+
+    // True if the target can be made within a drawdown limit.
+    bool IsFeasible(const fraction & limit);
+};
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline even_depletion_solver::even_depletion_solver() : target(0)
+{
+    drawdown.numerator = 0;
+    drawdown.denominator = 1;
+    drawdown.value = 0;
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline even_depletion_solver::~even_depletion_solver() {}
+
+/*******************************************************************************
+
+    \brief  Largest drawdown of the last solution.
+
+*******************************************************************************/
+inline double even_depletion_solver::GetDrawdown() const
+{
+    return (double) drawdown.numerator / (double) drawdown.denominator;
+}
+
+/*******************************************************************************
+
+    \brief  Makes sure the candidate at an index has been handed out, pulling
+            fractions from the heap and skipping equal ones.
+
+    \return bool - False if there are not that many distinct limits.
+
+*******************************************************************************/
+inline bool even_depletion_solver::HasCandidate(size_t index)
+{
+    while(candidates.size() <= index && !pending.empty())
+    {
+        fraction next = pending.top();
+        pending.pop();
+
+        // Queue the next fraction of the same value.
+        if(next.numerator < next.denominator)
+        {
+            fraction following = next;
+            ++following.numerator;
+            pending.push(following);
+        }
+
+        if(candidates.empty() || !(candidates.back() == next))
+        {
+            candidates.push_back(next);
+        }
+    }
+
+    return candidates.size() > index;
+}
+
+/*******************************************************************************
+
+    \brief  True if the target can be made within a drawdown limit.
+
+*******************************************************************************/
+inline bool even_depletion_solver::IsFeasible(const fraction & limit)
+{
+    for(size_t i = 0 ; i < limits.size() ; ++i)
+    {
+        caps[i] = (int) (limit.numerator * limits[i] / limit.denominator);
+    }
+
+    solver.Build(denominations, caps, target);
+    return solver.GetLeastCount(target) >= 0;
+}
+
+/*******************************************************************************
+
+    \brief  Solves for the target.
+
+    \param  const std::vector<int> & - The values, all positive.
+    \param  const std::vector<int> & - How many of each value there are.
+    \param  int - The target number.
+    \param  std::vector<int> & - How many of each value to use.  Of the
+                                 solutions with the lowest drawdown, the one
+                                 with the fewest numbers.
+
+    \return bool - True if a solution was found.
+
+*******************************************************************************/
+inline bool even_depletion_solver::Solve(const std::vector<int> & values,
+                                         const std::vector<int> & counts,
+                                         int target_number,
+                                         std::vector<int> & solution_counts)
+{
+    if(values.size() != counts.size()) throw std::exception();
+
+    denominations = values;
+    limits = counts;
+    target = target_number;
+    caps.assign(values.size(), 0);
+    candidates.clear();
+    pending = std::priority_queue<fraction>();
+
+    drawdown.numerator = 0;
+    drawdown.denominator = 1;
+
+    solution_counts.clear();
+    if(target < 0) return false;
+    if(target == 0)
+    {
+        solution_counts.assign(values.size(), 0);
+        return true;
+    }
+
+    // The first fraction of every value that can be used.
+    for(size_t i = 0 ; i < values.size() ; ++i)
+    {
+        if(limits[i] < 0) limits[i] = 0;
+        if(limits[i] == 0) continue;
+
+        fraction first;
+        first.numerator = 1;
+        first.denominator = limits[i];
+        first.value = i;
+        pending.push(first);
+    }
+
+    // Gallop until a feasible limit is found.
+    size_t low = 0;
+    size_t step = 1;
+    size_t high = 0;
+    bool found = false;
+    while(HasCandidate(low + step - 1))
+    {
+        high = low + step - 1;
+        if(IsFeasible(candidates[high]))
+        {
+            found = true;
+            break;
+        }
+
+        low = high + 1;
+        step *= 2;
+    }
+
+    // The last limit allows every number, try it if the gallop ran past.
+    if(!found)
+    {
+        if(candidates.empty() || low >= candidates.size()) return false;
+
+        high = candidates.size() - 1;
+        if(!IsFeasible(candidates[high])) return false;
+    }
+
+    // Binary search the lowest feasible limit in [low, high].
+    while(low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        if(IsFeasible(candidates[middle]))
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+
+    // Rebuild at the answer and take the fewest numbers.
+    drawdown = candidates[low];
+    IsFeasible(drawdown);
+    return solver.Lookup(target, solution_counts);
+}
+}
+
+#endif
@@ -0,0 +1,591 @@
+/*******************************************************************************
+
+    \file   fleet_solver.h
+
+    \brief  Routes a target to one unit of a fleet of subsets, or a pair.
+
+            Every unit is tried in parallel with even_depletion_solver, and
+            the unit whose largest drawdown would be lowest serves the
+            target, so the fleet runs down evenly.  Only if no single unit
+            can serve it are pairs of units tried, splitting the target
+            between them with the fewest numbers.
+
+            Units with the same values share one unbounded change table, the
+            fewest numbers for every sum when the counts are unlimited.  The
+            values of a unit rarely change, so the table outlives the calls.
+            A sum that table cannot reach cannot be reached with any counts,
+            which rules a unit out before it is solved.
+
+            Units are skipped once the budget runs out, and the best routing
+            found by then is returned.  Table building looks at the clock
+            too, so a small budget is not spent on tables first.  Targets
+            past the maximum given to the constructor are turned down before
+            any table is built, which also caps how large a table can grow,
+            and tables for values no unit has any more are dropped.
+
+*******************************************************************************/
+
+#ifndef FLEET_SOLVER_H
+#define FLEET_SOLVER_H
+
+#include <map>
+#include <vector>
+#include <climits>
+#include <algorithm>
+#include <exception>
+
+#include "subset.h"
+#include "change_solver.h"
+#include "solver_threads.h"
+#include "branch_bound_solver.h"
+#include "even_depletion_solver.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \brief  Which units serve a target and how many of each of their values
+            they give, in the ascending value order of each unit.
+
+*******************************************************************************/
+struct fleet_route
+{
+    std::vector<size_t> units;
+    std::vector<TCountVector> counts;
+};
+
+/*******************************************************************************
+
+    \class  fleet_solver
+
+    \brief  Picks the units of a fleet that serve a target.
+
+*******************************************************************************/
+class fleet_solver
+{
+public:
+
+    // Default largest target Route() accepts.
+    enum { DEFAULT_MAX_TARGET = 1 << 20 };
+
+    // Constructor, zero threads uses the hardware thread count.
+    fleet_solver(unsigned thread_count = 0,
+                 int max_target = DEFAULT_MAX_TARGET);
+
+    // Destructor.
+    virtual ~fleet_solver();
+
+    // Adds a unit, returns its index.  The subset must outlive the solver.
+    size_t AddUnit(subset & unit);
+
+    // Number of units.
+    size_t GetUnitCount() const;
+
+    // Number of shared unbounded tables.
+    size_t GetTableCount() const;
+
+    // Largest target Route() accepts.
+    int GetMaxTarget() const;
+
+    // Routes the target, false if no unit or pair of units can serve it or
+    // the target is past GetMaxTarget().  complete is false if the budget
+    // ran out before every unit was tried.
+    bool Route(int target,
+               const solve_budget & budget,
+               fleet_route & route,
+               bool & complete);
+
+    // Evaluates one unit, or one first unit of the pairs.
+    void operator()(size_t index);
+
+private:
+
+    // What one unit was found to do.
+    struct evaluation
+    {
+        bool tried;
+        bool found;
+        long long drawdown_numerator;
+        long long drawdown_denominator;
+        int items;
+        TCountVector counts;
+
+        // Pair phase, the other unit and this unit's part of the target.
+        size_t partner;
+        int split;
+    };
+
+    // Which phase operator()() is running.
+    enum TPhase
+    {
+        PHASE_SINGLE,
+        PHASE_TABLES,
+        PHASE_PAIRS
+    };
+
+    // Not copyable, threads hold it by address.
+    fleet_solver(const fleet_solver &);
+    fleet_solver & operator=(const fleet_solver &);
+
+    // True once the budget has run out.
+    bool IsExpired() const;
+
+    // Makes sure a unit's shared table covers the target, false if the
+    // budget ran out first.
+    bool PrepareTable(const std::vector<int> & values);
+
+    // Single unit, balanced.
+    void EvaluateSingle(size_t index);
+
+    // Pairs with index as the first unit, fewest numbers.
+    void EvaluatePairs(size_t index);
+
+    // Picks the best single unit, false if none.
+    bool PickSingle(fleet_route & route) const;
+
+    // Picks the best pair, false if none.
+    bool PickPair(fleet_route & route) const;
+
+    unsigned threads;
+    int max_route_target;
+
+    // The units and their values and counts when Route() started.
+    std::vector<subset *> units;
+    std::vector<std::vector<int> > values;
+    std::vector<std::vector<int> > counts;
+
+    // Unbounded fewest numbers per sum, keyed by the values.
+    std::map<std::vector<int>, std::vector<int> > tables;
+
+    // The shared table of each unit, for the threads to read.
+    std::vector<const std::vector<int> *> unit_tables;
+
+    // Bounded tables for the pair phase.
+    std::vector<change_solver> bounded;
+
+    std::vector<evaluation> evaluations;
+
+    TPhase phase;
+    int route_target;
+    unsigned long long deadline;
+};
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline fleet_solver::fleet_solver(unsigned thread_count, int max_target)
+    :
+    threads(thread_count),
+    max_route_target(max_target),
+    phase(PHASE_SINGLE),
+    route_target(0),
+    deadline(0)
+{}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline fleet_solver::~fleet_solver() {}
+
+/*******************************************************************************
+
+    \brief  Adds a unit.
+
+    \return size_t - The unit's index in routes.
+
+*******************************************************************************/
+inline size_t fleet_solver::AddUnit(subset & unit)
+{
+    units.push_back(&unit);
+    return units.size() - 1;
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline size_t fleet_solver::GetUnitCount() const
+{
+    return units.size();
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline size_t fleet_solver::GetTableCount() const
+{
+    return tables.size();
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline int fleet_solver::GetMaxTarget() const
+{
+    return max_route_target;
+}
+
+/*******************************************************************************
+
+    \brief  True once the budget has run out, never without a time budget.
+
+*******************************************************************************/
+inline bool fleet_solver::IsExpired() const
+{
+    return deadline != 0 && branch_bound_solver::Now() >= deadline;
+}
+
+/*******************************************************************************
+
+    \brief  Makes sure the shared table of a set of values covers the target,
+            extending it if an earlier target was smaller.
+
+    \return bool - False if the budget ran out first.  The sums done by then
+                   are kept for the next call.
+
+*******************************************************************************/
+inline bool fleet_solver::PrepareTable(const std::vector<int> & unit_values)
+{
+    std::vector<int> & least = tables[unit_values];
+    if((int) least.size() > route_target) return true;
+
+    // Grown a sum at a time, so running out leaves only finished sums and
+    // no time goes on filling memory the budget never reaches.
+    least.reserve(route_target + 1);
+    if(least.empty()) least.push_back(0);
+
+    for(size_t sum = least.size() ; sum <= (size_t) route_target ; ++sum)
+    {
+        if((sum & 0xFFF) == 0 && IsExpired()) return false;
+
+        int fewest = INT_MAX;
+        for(size_t i = 0 ; i < unit_values.size() ; ++i)
+        {
+            const size_t value = (size_t) unit_values[i];
+            if(value > sum) break;
+
+            if(least[sum - value] != INT_MAX &&
+               least[sum - value] + 1 < fewest)
+            {
+                fewest = least[sum - value] + 1;
+            }
+        }
+
+        least.push_back(fewest);
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief  Solves one unit on its own for the lowest drawdown.
+
+*******************************************************************************/
+inline void fleet_solver::EvaluateSingle(size_t index)
+{
+    evaluation & result = evaluations[index];
+
+    // Not even unlimited counts reach it.
+    if((*unit_tables[index])[route_target] == INT_MAX)
+    {
+        result.tried = true;
+        return;
+    }
+
+    if(IsExpired()) return;
+
+    even_depletion_solver solver;
+    result.tried = true;
+    result.found = solver.Solve(values[index],
+                                counts[index],
+                                route_target,
+                                result.counts);
+    if(!result.found) return;
+
+    // The drawdown as a fraction, kept exact for comparing units.
+    result.drawdown_numerator = 0;
+    result.drawdown_denominator = 1;
+    result.items = 0;
+    for(size_t i = 0 ; i < result.counts.size() ; ++i)
+    {
+        result.items += result.counts[i];
+        if(result.counts[i] == 0) continue;
+
+        const long long numerator = result.counts[i];
+        const long long denominator = counts[index][i];
+        if(numerator * result.drawdown_denominator >
+           result.drawdown_numerator * denominator)
+        {
+            result.drawdown_numerator = numerator;
+            result.drawdown_denominator = denominator;
+        }
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Tries every split of the target between this unit and each later
+            one, keeping the fewest numbers.
+
+*******************************************************************************/
+inline void fleet_solver::EvaluatePairs(size_t index)
+{
+    evaluation & result = evaluations[index];
+    result.found = false;
+    result.items = INT_MAX;
+
+    const change_solver & first = bounded[index];
+    for(size_t other = index + 1 ; other < units.size() ; ++other)
+    {
+        if(IsExpired()) return;
+
+        const change_solver & second = bounded[other];
+        const std::vector<int> & reach = *unit_tables[other];
+        for(int part = 1 ; part < route_target ; ++part)
+        {
+            const int rest = route_target - part;
+            if(reach[rest] == INT_MAX) continue;
+
+            const int first_items = first.GetLeastCount(part);
+            if(first_items < 0) continue;
+
+            const int second_items = second.GetLeastCount(rest);
+            if(second_items < 0) continue;
+
+            if(first_items + second_items < result.items)
+            {
+                result.found = true;
+                result.items = first_items + second_items;
+                result.partner = other;
+                result.split = part;
+            }
+        }
+    }
+
+    result.tried = true;
+}
+
+/*******************************************************************************
+
+    \brief  Runs one unit of the current phase, called by solver_threads.
+
+*******************************************************************************/
+inline void fleet_solver::operator()(size_t index)
+{
+    if(phase == PHASE_SINGLE)
+    {
+        EvaluateSingle(index);
+    }
+    else if(phase == PHASE_TABLES)
+    {
+        if(!IsExpired())
+        {
+            bounded[index].Build(values[index],
+                                 counts[index],
+                                 route_target,
+                                 deadline);
+        }
+    }
+    else
+    {
+        EvaluatePairs(index);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Picks the single unit with the lowest drawdown, then the fewest
+            numbers, then the lowest index.
+
+*******************************************************************************/
+inline bool fleet_solver::PickSingle(fleet_route & route) const
+{
+    const evaluation * best = 0;
+    size_t best_index = 0;
+    for(size_t i = 0 ; i < evaluations.size() ; ++i)
+    {
+        const evaluation & candidate = evaluations[i];
+        if(!candidate.found) continue;
+
+        if(best != 0)
+        {
+            const long long lhs = candidate.drawdown_numerator *
+                                  best->drawdown_denominator;
+            const long long rhs = best->drawdown_numerator *
+                                  candidate.drawdown_denominator;
+            if(lhs > rhs) continue;
+            if(lhs == rhs && candidate.items >= best->items) continue;
+        }
+
+        best = &candidate;
+        best_index = i;
+    }
+
+    if(best == 0) return false;
+
+    route.units.push_back(best_index);
+    route.counts.push_back(best->counts);
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief  Picks the pair with the fewest numbers.
+
+*******************************************************************************/
+inline bool fleet_solver::PickPair(fleet_route & route) const
+{
+    size_t best_index = evaluations.size();
+    for(size_t i = 0 ; i < evaluations.size() ; ++i)
+    {
+        if(!evaluations[i].found) continue;
+        if(best_index == evaluations.size() ||
+           evaluations[i].items < evaluations[best_index].items)
+        {
+            best_index = i;
+        }
+    }
+
+    if(best_index == evaluations.size()) return false;
+
+    const evaluation & best = evaluations[best_index];
+    const int part = best.split;
+
+    route.units.push_back(best_index);
+    route.units.push_back(best.partner);
+    route.counts.resize(2);
+    bounded[best_index].Lookup(part, route.counts[0]);
+    bounded[best.partner].Lookup(route_target - part, route.counts[1]);
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief  Routes the target to the fleet.
+
+    \param  int - The target number.
+    \param  const solve_budget & - How long routing may take.  Only the time
+                                   limit is used.
+    \param  fleet_route & - The units that serve the target and their counts.
+    \param  bool & - False if some units were not tried in time.
+
+    \return bool - True if a routing was found.
+
+*******************************************************************************/
+inline bool fleet_solver::Route(int target,
+                                const solve_budget & budget,
+                                fleet_route & route,
+                                bool & complete)
+{
+    route.units.clear();
+    route.counts.clear();
+    complete = true;
+
+    if(target < 0) throw std::exception();
+    if(target > max_route_target) return false;
+
+    deadline = budget.microseconds == 0 ?
+               0 : branch_bound_solver::Now() + budget.microseconds;
+    route_target = target;
+
+    // The counts are read here, the threads never touch the subsets.
+    const size_t unit_count = units.size();
+    values.assign(unit_count, std::vector<int>());
+    counts.assign(unit_count, std::vector<int>());
+    unit_tables.assign(unit_count, 0);
+    for(size_t i = 0 ; i < unit_count ; ++i)
+    {
+        TValueMap value_map;
+        units[i]->GetValueMap(value_map);
+        for(TValueMap::iterator iter = value_map.begin() ;
+            iter != value_map.end() ;
+            ++iter)
+        {
+            values[i].push_back(iter->first);
+            counts[i].push_back(iter->second > 0 ? iter->second : 0);
+        }
+    }
+
+    // Drop the tables of values that no unit has any more.
+    std::map<std::vector<int>, std::vector<int> >::iterator table =
+        tables.begin();
+    while(table != tables.end())
+    {
+        if(std::find(values.begin(), values.end(), table->first) ==
+           values.end())
+        {
+            tables.erase(table++);
+        }
+        else
+        {
+            ++table;
+        }
+    }
+
+    for(size_t i = 0 ; i < unit_count ; ++i)
+    {
+        if(!PrepareTable(values[i]))
+        {
+            complete = false;
+            return false;
+        }
+
+        unit_tables[i] = &tables[values[i]];
+    }
+
+    evaluation blank;
+    blank.tried = false;
+    blank.found = false;
+    blank.drawdown_numerator = 0;
+    blank.drawdown_denominator = 1;
+    blank.items = 0;
+    blank.partner = 0;
+    blank.split = 0;
+
+    evaluations.assign(unit_count, blank);
+    phase = PHASE_SINGLE;
+    solver_threads::Run(unit_count, *this, threads);
+
+    for(size_t i = 0 ; i < unit_count ; ++i)
+    {
+        if(!evaluations[i].tried) complete = false;
+    }
+
+    if(PickSingle(route)) return true;
+    if(unit_count < 2 || target < 2) return false;
+
+    // No unit can serve it alone, split it between two.
+    bounded.assign(unit_count, change_solver());
+    phase = PHASE_TABLES;
+    solver_threads::Run(unit_count, *this, threads);
+
+    if(IsExpired())
+    {
+        complete = false;
+        return false;
+    }
+
+    evaluations.assign(unit_count, blank);
+    phase = PHASE_PAIRS;
+    solver_threads::Run(unit_count - 1, *this, threads);
+
+    for(size_t i = 0 ; i + 1 < unit_count ; ++i)
+    {
+        if(!evaluations[i].tried) complete = false;
+    }
+
+    return PickPair(route);
+}
+}
+
+#endif
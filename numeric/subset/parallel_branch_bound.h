@@ -0,0 +1,471 @@
+/*******************************************************************************
+
+    \file   parallel_branch_bound.h
+
+    \brief  Branch and bound for the fewest numbers split across threads.
+
+            The counts of the largest values, down to a split depth, are fixed
+            up front and each combination that can still reach the target is
+            one task.  Tasks are dealt out to a deque per worker.  A worker
+            takes from the front of its own deque and, once that is empty,
+            steals from the back of the others.  The item count of the best
+            solution is shared through a solver_atomic, so a bound found by
+            one worker prunes the branches of every other.
+
+*******************************************************************************/
+
+#ifndef PARALLEL_BRANCH_BOUND_H
+#define PARALLEL_BRANCH_BOUND_H
+
+#include <deque>
+#include <vector>
+#include <climits>
+#include <algorithm>
+#include <exception>
+
+#include "solver_threads.h"
+#include "branch_bound_solver.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  parallel_branch_bound
+
+    \brief  Fewest numbers with bounded counts, searched on several threads.
+
+*******************************************************************************/
+class parallel_branch_bound
+{
+public:
+
+    // Constructor, zero threads uses the hardware count, zero depth picks one.
+    parallel_branch_bound(unsigned thread_count = 0, int split_depth = 0);
+
+    // Destructor.
+    virtual ~parallel_branch_bound();
+
+    // Searches within the budget, false if no solution was found.
+    bool Solve(const std::vector<int> & values,
+               const std::vector<int> & counts,
+               int target,
+               const solve_budget & budget,
+               std::vector<int> & solution_counts,
+               bool & optimal);
+
+    // Number of tasks the last Solve() split the tree into.
+    size_t GetTaskCount() const;
+
+    // Nodes visited by the last Solve(), over all threads.
+    unsigned long long GetOperations() const;
+
+    // Runs one worker, called by solver_threads::Run().
+    void operator()(size_t worker);
+
+private:
+
+    // Operations a worker counts before adding them to the shared total.
+    enum { OPERATION_BATCH = 1024 };
+
+    // Counts of the values at and above the split, and what is left.
+    struct task
+    {
+        size_t first_count;
+        int sum_left;
+        int items;
+    };
+
+    // One worker's tasks, guarded by its own mutex.
+#ifdef _WIN32
+    typedef WinThread::Mutex TMutex;
+    typedef WinThread::Lock TLock;
+#else
+    typedef PosixThread::Mutex TMutex;
+    typedef PosixThread::Lock TLock;
+#endif
+
+    struct worker_queue
+    {
+        std::deque<task> tasks;
+        TMutex mutex;
+    };
+
+    // Values, ascending, their counts and the sum up to each index.
+    std::vector<int> denominations;
+    std::vector<int> limits;
+    std::vector<long long> capacity;
+
+    // Counts fixed by each task, split_size per task.
+    std::vector<int> prefixes;
+    int split_index;
+    size_t split_size;
+
+    // The task deques.
+    std::vector<worker_queue *> queues;
+
+    // Item count of the best solution, and the solution itself.
+    solver_atomic best_items;
+    std::vector<int> best;
+    TMutex best_mutex;
+
+    // Budget shared by all the workers.
+    solve_budget limit;
+    unsigned long long start_time;
+    solver_atomic operations;
+    solver_atomic stopped;
+
+    unsigned threads;
+    int depth;
+    size_t task_count;
+
+    // Lists the tasks by fixing counts from the largest value down.
+    void Split(int index,
+               int sum_left,
+               int items,
+               std::vector<int> & current,
+               std::vector<task> & found);
+
+    // Takes the next task, own deque first, false when there are none.
+    bool NextTask(size_t worker, task & next);
+
+    // Searches below the split.
+    void Search(int index,
+                int sum_left,
+                int items,
+                std::vector<int> & current,
+                unsigned long long & local_operations);
+
+    // Offers a solution as the new best.
+    void Record(int items, const std::vector<int> & current);
+
+    // Counts one node, true when the budget has run out.
+    bool IsOutOfBudget(unsigned long long & local_operations);
+};
+
+/*******************************************************************************
+
+    \brief  Constructor
+
+    \param  unsigned - Threads to use, zero for the hardware count.
+    \param  int - How many of the largest values are fixed per task, zero
+                  picks enough for several tasks per thread.
+
+*******************************************************************************/
+inline parallel_branch_bound::parallel_branch_bound(unsigned thread_count,
+                                                    int split_depth)
+    :
+    split_index(0),
+    split_size(0),
+    best_items(LONG_MAX),
+    start_time(0),
+    operations(0),
+    stopped(0),
+    threads(thread_count),
+    depth(split_depth),
+    task_count(0)
+{
+    if(threads == 0) threads = solver_threads::GetHardwareThreadCount();
+}
+
+/*******************************************************************************
+
+    \brief  Destructor
+
+*******************************************************************************/
+inline parallel_branch_bound::~parallel_branch_bound()
+{
+    for(size_t i = 0 ; i < queues.size() ; ++i) delete queues[i];
+}
+
+/*******************************************************************************
+
+    \brief  Number of tasks the last Solve() split the tree into.
+
+*******************************************************************************/
+inline size_t parallel_branch_bound::GetTaskCount() const
+{
+    return task_count;
+}
+
+/*******************************************************************************
+
+    \brief  Nodes visited by the last Solve(), over all threads.
+
+*******************************************************************************/
+inline unsigned long long parallel_branch_bound::GetOperations() const
+{
+    return (unsigned long long) operations.Load();
+}
+
+/*******************************************************************************
+
+    \brief  Searches within the budget.
+
+    \param  const std::vector<int> & - The distinct values, ascending.
+    \param  const std::vector<int> & - How many of each value can be used.
+    \param  int - The target number.
+    \param  const solve_budget & - How long the search may run.
+    \param  std::vector<int> & - Counts of the best solution found.
+    \param  bool & - True if the search finished, the solution then has the
+                     fewest numbers, or there is none.
+
+    \return bool - True if a solution was found.
+
+*******************************************************************************/
+inline bool parallel_branch_bound::Solve(const std::vector<int> & values,
+                                         const std::vector<int> & counts,
+                                         int target,
+                                         const solve_budget & budget,
+                                         std::vector<int> & solution_counts,
+                                         bool & optimal)
+{
+    if(values.size() != counts.size()) throw std::exception();
+
+    denominations = values;
+    limits = counts;
+    capacity.assign(values.size(), 0);
+
+    long long held = 0;
+    for(size_t i = 0 ; i < values.size() ; ++i)
+    {
+        if(values[i] <= 0 || (i > 0 && values[i] <= values[i - 1]))
+        {
+            throw std::exception();
+        }
+
+        if(limits[i] < 0) limits[i] = 0;
+
+        held += (long long) values[i] * limits[i];
+        capacity[i] = held;
+    }
+
+    // Reset the shared state.
+    best.clear();
+    best_items.Store(LONG_MAX);
+    operations.Store(0);
+    stopped.Store(0);
+    limit = budget;
+    start_time = branch_bound_solver::Now();
+    task_count = 0;
+
+    solution_counts.clear();
+    optimal = true;
+    if(target < 0 || values.empty()) return target == 0;
+
+    // Fix enough of the largest values to give every thread several tasks.
+    int split_depth = depth;
+    if(split_depth <= 0)
+    {
+        double branches = 1.0;
+        split_depth = 0;
+        while(split_depth < (int) values.size() && branches < threads * 16.0)
+        {
+            branches *= limits[values.size() - 1 - split_depth] + 1;
+            ++split_depth;
+        }
+    }
+    split_depth = std::min(split_depth, (int) values.size());
+
+    split_index = (int) values.size() - split_depth;
+    split_size = (size_t) split_depth;
+
+    std::vector<int> current(values.size(), 0);
+    std::vector<task> found;
+    prefixes.clear();
+    Split((int) values.size() - 1, target, 0, current, found);
+    task_count = found.size();
+
+    // Deal the tasks out in order, so every worker starts on a promising one.
+    for(size_t i = 0 ; i < queues.size() ; ++i) delete queues[i];
+    queues.assign(threads, 0);
+    for(size_t i = 0 ; i < queues.size() ; ++i) queues[i] = new worker_queue;
+    for(size_t i = 0 ; i < found.size() ; ++i)
+    {
+        queues[i % threads]->tasks.push_back(found[i]);
+    }
+
+    solver_threads::Run(threads, *this, threads, 1);
+
+    optimal = stopped.Load() == 0;
+
+    if(best_items.Load() == LONG_MAX) return false;
+
+    solution_counts = best;
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief  Lists the tasks by fixing counts from the largest value down to
+            the split.
+
+*******************************************************************************/
+inline void parallel_branch_bound::Split(int index,
+                                         int sum_left,
+                                         int items,
+                                         std::vector<int> & current,
+                                         std::vector<task> & found)
+{
+    if(index < split_index || sum_left == 0)
+    {
+        task next;
+        next.first_count = prefixes.size();
+        next.sum_left = sum_left;
+        next.items = items;
+        prefixes.insert(prefixes.end(),
+                        current.begin() + split_index,
+                        current.end());
+        found.push_back(next);
+        return;
+    }
+
+    if(sum_left > capacity[index]) return;
+
+    const int value = denominations[index];
+    const int most = std::min(limits[index], sum_left / value);
+    for(int count = most ; count >= 0 ; --count)
+    {
+        current[index] = count;
+        Split(index - 1, sum_left - count * value, items + count, current,
+              found);
+    }
+
+    current[index] = 0;
+}
+
+/*******************************************************************************
+
+    \brief  Takes the next task, own deque first, then steals.
+
+*******************************************************************************/
+inline bool parallel_branch_bound::NextTask(size_t worker, task & next)
+{
+    {
+        TLock lock(queues[worker]->mutex);
+        if(!queues[worker]->tasks.empty())
+        {
+            next = queues[worker]->tasks.front();
+            queues[worker]->tasks.pop_front();
+            return true;
+        }
+    }
+
+    // Steal the least promising task of another worker.
+    for(size_t i = 1 ; i < queues.size() ; ++i)
+    {
+        worker_queue & victim = *queues[(worker + i) % queues.size()];
+        TLock lock(victim.mutex);
+        if(!victim.tasks.empty())
+        {
+            next = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Tasks are only made before the workers start, so nothing more will
+    // turn up.
+    return false;
+}
+
+/*******************************************************************************
+
+    \brief  Runs one worker until there are no tasks left.
+
+*******************************************************************************/
+inline void parallel_branch_bound::operator()(size_t worker)
+{
+    std::vector<int> current(denominations.size(), 0);
+    unsigned long long local_operations = 0;
+
+    task next;
+    while(stopped.Load() == 0 && NextTask(worker, next))
+    {
+        std::fill(current.begin(), current.end(), 0);
+        std::copy(prefixes.begin() + next.first_count,
+                  prefixes.begin() + next.first_count + split_size,
+                  current.begin() + split_index);
+
+        Search(split_index - 1, next.sum_left, next.items, current,
+               local_operations);
+    }
+
+    operations.Add((long) (local_operations % OPERATION_BATCH));
+}
+
+/*******************************************************************************
+
+    \brief  Counts one node, true when the budget has run out.
+
+*******************************************************************************/
+inline bool parallel_branch_bound::IsOutOfBudget(
+    unsigned long long & local_operations)
+{
+    if(++local_operations % OPERATION_BATCH != 0) return false;
+
+    // Only every batch touches the shared state.
+    const long total = operations.Add(OPERATION_BATCH);
+
+    if((limit.operations != 0 &&
+        (unsigned long long) total > limit.operations) ||
+       (limit.microseconds != 0 &&
+        branch_bound_solver::Now() - start_time >= limit.microseconds))
+    {
+        stopped.CompareExchange(0, 1);
+    }
+
+    return stopped.Load() != 0;
+}
+
+/*******************************************************************************
+
+    \brief  Offers a solution as the new best.
+
+*******************************************************************************/
+inline void parallel_branch_bound::Record(int items,
+                                          const std::vector<int> & current)
+{
+    TLock lock(best_mutex);
+
+    // The bound is only lowered under the lock, so it always matches best.
+    if(best_items.StoreMin(items)) best = current;
+}
+
+/*******************************************************************************
+
+    \brief  Searches below the split, pruned against the shared bound.
+
+*******************************************************************************/
+inline void parallel_branch_bound::Search(int index,
+                                          int sum_left,
+                                          int items,
+                                          std::vector<int> & current,
+                                          unsigned long long & local_operations)
+{
+    if(IsOutOfBudget(local_operations)) return;
+
+    if(sum_left == 0)
+    {
+        if(items < best_items.Load()) Record(items, current);
+        return;
+    }
+
+    if(index < 0 || sum_left > capacity[index]) return;
+
+    const int value = denominations[index];
+    const int fewest = (sum_left + value - 1) / value;
+    if(items + fewest >= best_items.Load()) return;
+
+    const int most = std::min(limits[index], sum_left / value);
+    for(int count = most ; count >= 0 && stopped.Load() == 0 ; --count)
+    {
+        current[index] = count;
+        Search(index - 1, sum_left - count * value, items + count, current,
+               local_operations);
+    }
+
+    current[index] = 0;
+}
+}
+
+#endif
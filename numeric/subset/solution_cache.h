@@ -0,0 +1,321 @@
+/*******************************************************************************
+
+    \file   solution_cache.h
+
+    \brief  Least recently used cache of solutions.
+
+            Entries are keyed by a 64 bit fingerprint of the counts, the
+            target and the solver that made them.  A change to the counts
+            changes the fingerprint, so old entries can never be returned for
+            the new counts, they just age out.  When the counts go back to an
+            earlier state its entries are good again.
+
+*******************************************************************************/
+
+#ifndef SOLUTION_CACHE_H
+#define SOLUTION_CACHE_H
+
+#include <map>
+#include <vector>
+#include <cstddef>
+
+// FNV-1a 64 bit starting value for solution_cache::Fingerprint().
+#define SOLUTION_CACHE_FINGERPRINT_START 14695981039346656037ULL
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  solution_cache
+
+    \brief  Maps a fingerprint, target and solver to a solution.
+
+*******************************************************************************/
+class solution_cache
+{
+public:
+
+    // Constructor, a capacity of zero turns the cache off.
+    solution_cache(size_t entry_capacity = 0);
+
+    // Destructor.
+    virtual ~solution_cache();
+
+    // Folds a number into a fingerprint.
+    static unsigned long long Fingerprint(unsigned long long fingerprint,
+                                          long long number);
+
+    // Looks up a solution, true on a hit.
+    bool Find(unsigned long long fingerprint,
+              int target,
+              int solver,
+              std::vector<int> & solution);
+
+    // Stores a solution, evicting the least recently used if full.
+    void Insert(unsigned long long fingerprint,
+                int target,
+                int solver,
+                const std::vector<int> & solution);
+
+    // Changes the capacity, evicting as needed.
+    void SetCapacity(size_t entry_capacity);
+
+    // Gets the capacity.
+    size_t GetCapacity() const;
+
+    // Drops every entry, the counters are kept.
+    void Clear();
+
+    // Number of entries.
+    size_t GetSize() const;
+
+    // Lookups that found an entry.
+    unsigned long long GetHits() const;
+
+    // Lookups that did not.
+    unsigned long long GetMisses() const;
+
+private:
+
+    // Identifies one solve.
+    struct key
+    {
+        unsigned long long fingerprint;
+        int target;
+        int solver;
+
+        bool operator<(const key & other) const
+        {
+            if(fingerprint != other.fingerprint)
+            {
+                return fingerprint < other.fingerprint;
+            }
+            if(target != other.target) return target < other.target;
+            return solver < other.solver;
+        }
+    };
+
+    // A solution and when it was last used.
+    struct entry
+    {
+        std::vector<int> solution;
+        unsigned long long last_used;
+    };
+
+    // The entries, and their keys by last use, oldest first.
+    std::map<key, entry> entries;
+    std::map<unsigned long long, key> recency;
+
+    // Bumped on every use.
+    unsigned long long clock;
+
+    size_t capacity;
+    unsigned long long hits;
+    unsigned long long misses;
+
+    // Marks an entry as just used.
+    void Touch(const key & id, entry & used);
+
+    // Evicts the oldest entries until there is room.
+    void Evict(size_t keep);
+};
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline solution_cache::solution_cache(size_t entry_capacity)
+    :
+    clock(0),
+    capacity(entry_capacity),
+    hits(0),
+    misses(0)
+{}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline solution_cache::~solution_cache() {}
+
+/*******************************************************************************
+
+    \brief  Folds a number into an FNV-1a fingerprint, a byte at a time.
+
+*******************************************************************************/
+inline unsigned long long
+solution_cache::Fingerprint(unsigned long long fingerprint, long long number)
+{
+    unsigned long long bits = (unsigned long long) number;
+    for(int i = 0 ; i < 8 ; ++i)
+    {
+        fingerprint ^= bits & 0xFFULL;
+        fingerprint *= 1099511628211ULL;
+        bits >>= 8;
+    }
+
+    return fingerprint;
+}
+
+/*******************************************************************************
+
+    \brief  Marks an entry as just used.
+
+*******************************************************************************/
+inline void solution_cache::Touch(const key & id, entry & used)
+{
+    recency.erase(used.last_used);
+    used.last_used = ++clock;
+    recency[used.last_used] = id;
+}
+
+/*******************************************************************************
+
+    \brief  Evicts the oldest entries until no more than keep are left.
+
+*******************************************************************************/
+inline void solution_cache::Evict(size_t keep)
+{
+    while(entries.size() > keep)
+    {
+        std::map<unsigned long long, key>::iterator oldest = recency.begin();
+        entries.erase(oldest->second);
+        recency.erase(oldest);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Looks up a solution.
+
+    \param  unsigned long long - Fingerprint of the counts.
+    \param  int - The target number.
+    \param  int - Which solver, chosen by the caller.
+    \param  std::vector<int> & - The solution on a hit.
+
+    \return bool - True on a hit.
+
+*******************************************************************************/
+inline bool solution_cache::Find(unsigned long long fingerprint,
+                                 int target,
+                                 int solver,
+                                 std::vector<int> & solution)
+{
+    if(capacity == 0) return false;
+
+    key id;
+    id.fingerprint = fingerprint;
+    id.target = target;
+    id.solver = solver;
+
+    std::map<key, entry>::iterator found = entries.find(id);
+    if(found == entries.end())
+    {
+        ++misses;
+        return false;
+    }
+
+    ++hits;
+    Touch(id, found->second);
+    solution = found->second.solution;
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief  Stores a solution, evicting the least recently used if full.
+
+*******************************************************************************/
+inline void solution_cache::Insert(unsigned long long fingerprint,
+                                   int target,
+                                   int solver,
+                                   const std::vector<int> & solution)
+{
+    if(capacity == 0) return;
+
+    key id;
+    id.fingerprint = fingerprint;
+    id.target = target;
+    id.solver = solver;
+
+    std::map<key, entry>::iterator found = entries.find(id);
+    if(found == entries.end())
+    {
+        Evict(capacity - 1);
+
+        entry fresh;
+        fresh.last_used = 0;
+        found = entries.insert(std::make_pair(id, fresh)).first;
+        recency[0] = id;
+    }
+
+    found->second.solution = solution;
+    Touch(id, found->second);
+}
+
+/*******************************************************************************
+
+    \brief  Changes the capacity, evicting as needed.
+
+*******************************************************************************/
+inline void solution_cache::SetCapacity(size_t entry_capacity)
+{
+    capacity = entry_capacity;
+    Evict(capacity);
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline size_t solution_cache::GetCapacity() const
+{
+    return capacity;
+}
+
+/*******************************************************************************
+
+    \brief  Drops every entry, the counters are kept.
+
+*******************************************************************************/
+inline void solution_cache::Clear()
+{
+    entries.clear();
+    recency.clear();
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline size_t solution_cache::GetSize() const
+{
+    return entries.size();
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline unsigned long long solution_cache::GetHits() const
+{
+    return hits;
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline unsigned long long solution_cache::GetMisses() const
+{
+    return misses;
+}
+}
+
+#endif
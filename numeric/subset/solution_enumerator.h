@@ -0,0 +1,384 @@
+/*******************************************************************************
+
+    \file   solution_enumerator.h
+
+    \brief  Lazy enumeration of the solutions to a target, fewest numbers
+            first.
+
+            Solutions are count vectors, one count per distinct value, so a
+            group of equal numbers is never listed twice.  The enumerator
+            searches one item count at a time and keeps only the current
+            count vector, memory is O(distinct values) however many
+            solutions there are.  Within an item count the solutions come in
+            the order an include first search over the ascending numbers would
+            find them, more of the smaller values first.
+
+            Reset() starts a new enumeration in the same object, reusing its
+            memory, so a kept enumerator searches without allocating.
+
+*******************************************************************************/
+
+#ifndef SOLUTION_ENUMERATOR_H
+#define SOLUTION_ENUMERATOR_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <exception>
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  solution_enumerator
+
+    \brief  Yields the solutions to a target one at a time.
+
+*******************************************************************************/
+class solution_enumerator
+{
+private:
+
+    // The distinct values, ascending.
+    std::vector<int> denominations;
+
+    // How many of each value can be used.
+    std::vector<int> limits;
+
+    // Items and sum that the values from an index onwards can hold.
+    std::vector<long long> suffix_items;
+    std::vector<long long> suffix_sums;
+
+    // The target number.
+    int target;
+
+    // Item count being searched, and the largest worth searching.
+    int level;
+    int last_level;
+
+    // Search state, one entry per value.
+    std::vector<int> counts;
+    std::vector<int> lowest;
+    std::vector<int> items_left;
+    std::vector<int> sum_left;
+
+    // Depth of the search, -1 when the level is exhausted.
+    int depth;
+
+    // True once the current level has been set up.
+    bool level_started;
+
+    // Scratch for merging the values in Reset().
+    std::vector<std::pair<int, int> > merged;
+
+public:
+
+    // Constructor, lists nothing until Reset().
+    solution_enumerator();
+
+    // Constructor.
+    solution_enumerator(const std::vector<int> & values,
+                        const std::vector<int> & value_counts,
+                        int target_number);
+
+    // Destructor.
+    virtual ~solution_enumerator();
+
+    // Starts over on new values, counts and target.
+    void Reset(const std::vector<int> & values,
+               const std::vector<int> & value_counts,
+               int target_number);
+
+    // Gets the next solution, false when there are no more.
+    bool Next(std::vector<int> & solution_counts);
+
+    // Gets the distinct values the counts refer to, ascending.
+    const std::vector<int> & GetValues() const;
+
+    // Expands a count vector into the numbers, smallest first.
+    void Expand(const std::vector<int> & solution_counts,
+                std::vector<int> & solution) const;
+
+private:
+
+    // True if items numbers from index onwards can sum to sum.
+    bool IsFeasible(size_t index, int items, int sum) const;
+
+    // Sets the choices for a depth from what is left.
+    void EnterDepth(int index, int items, int sum);
+};
+
+/*******************************************************************************
+
+    \brief  Constructor, lists nothing until Reset().
+
+*******************************************************************************/
+inline solution_enumerator::solution_enumerator()
+    :
+    target(0),
+    level(0),
+    last_level(-1),
+    depth(-1),
+    level_started(false)
+{}
+
+/*******************************************************************************
+
+    \brief  Constructor
+
+    \param  const std::vector<int> & - The values.
+    \param  const std::vector<int> & - How many of each value can be used.
+    \param  int - The target number.
+
+*******************************************************************************/
+inline solution_enumerator::solution_enumerator(
+    const std::vector<int> & values,
+    const std::vector<int> & value_counts,
+    int target_number)
+{
+    Reset(values, value_counts, target_number);
+}
+
+/*******************************************************************************
+
+    \brief  Starts over on new values, counts and target.  The member vectors
+            keep their capacity, so once they are big enough nothing is
+            allocated.
+
+    \param  const std::vector<int> & - The values.
+    \param  const std::vector<int> & - How many of each value can be used.
+    \param  int - The target number.
+
+*******************************************************************************/
+inline void solution_enumerator::Reset(const std::vector<int> & values,
+                                       const std::vector<int> & value_counts,
+                                       int target_number)
+{
+    if(values.size() != value_counts.size()) throw std::exception();
+
+    target = target_number;
+    level = 0;
+    last_level = -1;
+    depth = -1;
+    level_started = false;
+
+    // Merge equal values and drop the ones that cannot take part.
+    merged.clear();
+    for(size_t i = 0 ; i < values.size() ; ++i)
+    {
+        if(values[i] > 0 && value_counts[i] > 0)
+        {
+            merged.push_back(std::make_pair(values[i], value_counts[i]));
+        }
+    }
+    std::sort(merged.begin(), merged.end());
+
+    denominations.clear();
+    limits.clear();
+    for(size_t i = 0 ; i < merged.size() ; ++i)
+    {
+        if(!denominations.empty() && denominations.back() == merged[i].first)
+        {
+            limits.back() += merged[i].second;
+        }
+        else
+        {
+            denominations.push_back(merged[i].first);
+            limits.push_back(merged[i].second);
+        }
+    }
+
+    const size_t size = denominations.size();
+    suffix_items.assign(size + 1, 0);
+    suffix_sums.assign(size + 1, 0);
+    for(size_t i = size ; i-- > 0 ; )
+    {
+        suffix_items[i] = suffix_items[i + 1] + limits[i];
+        suffix_sums[i] = suffix_sums[i + 1] +
+                         (long long) limits[i] * denominations[i];
+    }
+
+    counts.assign(size, 0);
+    lowest.assign(size, 0);
+    items_left.assign(size, 0);
+    sum_left.assign(size, 0);
+
+    if(target < 0) return;
+
+    // No solution can use more numbers than there are, or than it takes
+    // of the smallest value to pass the target.
+    if(size == 0)
+    {
+        last_level = 0;
+    }
+    else
+    {
+        long long most = (long long) target / denominations[0];
+        last_level = (int) std::min<long long>(most, suffix_items[0]);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Destructor
+
+*******************************************************************************/
+inline solution_enumerator::~solution_enumerator() {}
+
+/*******************************************************************************
+
+    \brief  True if items numbers from index onwards can sum to sum.
+
+*******************************************************************************/
+inline bool solution_enumerator::IsFeasible(size_t index,
+                                            int items,
+                                            int sum) const
+{
+    if(items == 0) return sum == 0;
+    if(index >= denominations.size()) return false;
+
+    // Values are ascending, so items numbers from here sum to at least
+    // items of this value and at most items of the largest.
+    return items <= suffix_items[index] &&
+           sum <= suffix_sums[index] &&
+           (long long) items * denominations[index] <= sum &&
+           (long long) items * denominations.back() >= sum;
+}
+
+/*******************************************************************************
+
+    \brief  Sets the choices for a depth.  Counts are tried from the highest
+            down, so the last value is forced to whatever is left.
+
+*******************************************************************************/
+inline void solution_enumerator::EnterDepth(int index, int items, int sum)
+{
+    items_left[index] = items;
+    sum_left[index] = sum;
+
+    const int value = denominations[index];
+
+    int highest = std::min(std::min(limits[index], items), sum / value);
+    int low = 0;
+
+    if(index == (int) denominations.size() - 1)
+    {
+        // Everything left has to be this value.
+        if(items <= limits[index] && (long long) items * value == sum)
+        {
+            highest = items;
+            low = items;
+        }
+        else
+        {
+            highest = -1;
+            low = 0;
+        }
+    }
+
+    // The first decrement lands on the highest count.
+    counts[index] = highest + 1;
+    lowest[index] = low;
+}
+
+/*******************************************************************************
+
+    \brief  Gets the next solution.
+
+    \param  std::vector<int> & - How many of each value the solution uses,
+                                 in the order of GetValues().
+
+    \return bool - False when there are no more solutions.
+
+*******************************************************************************/
+inline bool solution_enumerator::Next(std::vector<int> & solution_counts)
+{
+    while(level <= last_level)
+    {
+        if(!level_started)
+        {
+            level_started = true;
+
+            if(denominations.empty())
+            {
+                // Only the empty solution, and only for zero.
+                ++level;
+                if(target == 0)
+                {
+                    solution_counts.clear();
+                    return true;
+                }
+                continue;
+            }
+
+            depth = -1;
+            if(IsFeasible(0, level, target))
+            {
+                EnterDepth(0, level, target);
+                depth = 0;
+            }
+        }
+
+        while(depth >= 0)
+        {
+            if(counts[depth] <= lowest[depth])
+            {
+                // Every count at this depth has been tried.
+                --depth;
+                continue;
+            }
+
+            const int count = --counts[depth];
+            const int items = items_left[depth] - count;
+            const int sum = sum_left[depth] - count * denominations[depth];
+
+            if(depth == (int) denominations.size() - 1)
+            {
+                // The last count was forced, this is a solution.
+                solution_counts = counts;
+                return true;
+            }
+
+            if(IsFeasible(depth + 1, items, sum))
+            {
+                ++depth;
+                EnterDepth(depth, items, sum);
+            }
+        }
+
+        // This item count is done, move on to the next.
+        ++level;
+        level_started = false;
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+
+    \brief  Gets the distinct values the counts refer to, ascending.
+
+*******************************************************************************/
+inline const std::vector<int> & solution_enumerator::GetValues() const
+{
+    return denominations;
+}
+
+/*******************************************************************************
+
+    \brief  Expands a count vector into the numbers, smallest first.
+
+*******************************************************************************/
+inline void solution_enumerator::Expand(
+    const std::vector<int> & solution_counts,
+    std::vector<int> & solution) const
+{
+    solution.clear();
+    for(size_t i = 0 ; i < solution_counts.size() ; ++i)
+    {
+        solution.insert(solution.end(), solution_counts[i], denominations[i]);
+    }
+}
+}
+
+#endif
@@ -0,0 +1,217 @@
+/*******************************************************************************
+
+    \file   solver_arena.h
+
+    \brief  Scratch memory for solves, one arena per thread.
+
+            A solve that needs working vectors takes them from the arena of
+            its thread instead of making new ones.  The vectors keep their
+            capacity between solves, so once they have grown to the largest
+            problem seen the solve path does not allocate at all.  The arena
+            of a thread is made on first use and freed when the thread ends.
+
+*******************************************************************************/
+
+#ifndef SOLVER_ARENA_H
+#define SOLVER_ARENA_H
+
+#include <vector>
+#include <exception>
+
+#include "solution_enumerator.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  solver_arena
+
+    \brief  Reusable working vectors for one thread.
+
+*******************************************************************************/
+class solver_arena
+{
+public:
+
+    // Constructor.
+    solver_arena();
+
+    // Destructor.
+    virtual ~solver_arena();
+
+    // The arena of the calling thread.
+    static solver_arena & ForThread();
+
+    // The values and counts a search runs over.
+    std::vector<int> denominations;
+    std::vector<int> counts;
+
+    // How many of each value a solution uses.
+    std::vector<int> solution_counts;
+
+    // Whole block search, Reset() for each solve.
+    solution_enumerator enumerator;
+
+private:
+
+    // Not copyable, each thread has exactly one.
+    solver_arena(const solver_arena &);
+    solver_arena & operator=(const solver_arena &);
+
+#ifdef _WIN32
+    // Frees an arena when its thread ends.
+    static VOID WINAPI Destroy(PVOID arena);
+
+    // Makes the fiber local slot, once.
+    static BOOL CALLBACK CreateSlot(PINIT_ONCE, PVOID, PVOID * slot);
+
+    // Fiber local slot holding each thread's arena.
+    static DWORD Slot();
+#else
+    // Frees an arena when its thread ends.
+    static void Destroy(void * arena);
+
+    // Makes the thread key, once.
+    static void CreateKey();
+
+    // Thread key holding each thread's arena.
+    static pthread_key_t & Key();
+#endif
+};
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline solver_arena::solver_arena() {}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline solver_arena::~solver_arena() {}
+
+#ifdef _WIN32
+/*******************************************************************************
+
+    \brief  Frees an arena when its thread ends.
+
+*******************************************************************************/
+inline VOID WINAPI solver_arena::Destroy(PVOID arena)
+{
+    delete (solver_arena *) arena;
+}
+
+/*******************************************************************************
+
+    \brief  Makes the fiber local slot.
+
+*******************************************************************************/
+inline BOOL CALLBACK solver_arena::CreateSlot(PINIT_ONCE, PVOID, PVOID * slot)
+{
+    const DWORD index = FlsAlloc(Destroy);
+    if(index == FLS_OUT_OF_INDEXES) return FALSE;
+
+    *slot = (PVOID) (ULONG_PTR) index;
+    return TRUE;
+}
+
+/*******************************************************************************
+
+    \brief  Fiber local slot holding each thread's arena.
+
+*******************************************************************************/
+inline DWORD solver_arena::Slot()
+{
+    static INIT_ONCE once = INIT_ONCE_STATIC_INIT;
+
+    PVOID slot = 0;
+    if(!InitOnceExecuteOnce(&once, CreateSlot, 0, &slot))
+    {
+        throw std::exception();
+    }
+
+    return (DWORD) (ULONG_PTR) slot;
+}
+#else
+/*******************************************************************************
+
+    \brief  Frees an arena when its thread ends.
+
+*******************************************************************************/
+inline void solver_arena::Destroy(void * arena)
+{
+    delete (solver_arena *) arena;
+}
+
+/*******************************************************************************
+
+    \brief  Makes the thread key.
+
+*******************************************************************************/
+inline void solver_arena::CreateKey()
+{
+    pthread_key_create(&Key(), Destroy);
+}
+
+/*******************************************************************************
+
+    \brief  Thread key holding each thread's arena.
+
+*******************************************************************************/
+inline pthread_key_t & solver_arena::Key()
+{
+    static pthread_key_t key;
+    return key;
+}
+#endif
+
+/*******************************************************************************
+
+    \brief  The arena of the calling thread, made on first use.
+
+*******************************************************************************/
+inline solver_arena & solver_arena::ForThread()
+{
+#ifdef _WIN32
+    const DWORD slot = Slot();
+
+    solver_arena * arena = (solver_arena *) FlsGetValue(slot);
+    if(arena == 0)
+    {
+        arena = new solver_arena();
+        if(!FlsSetValue(slot, arena))
+        {
+            delete arena;
+            throw std::exception();
+        }
+    }
+#else
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, CreateKey);
+
+    solver_arena * arena = (solver_arena *) pthread_getspecific(Key());
+    if(arena == 0)
+    {
+        arena = new solver_arena();
+        if(pthread_setspecific(Key(), arena) != 0)
+        {
+            delete arena;
+            throw std::exception();
+        }
+    }
+#endif
+
+    return *arena;
+}
+}
+
+#endif
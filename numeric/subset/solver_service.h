@@ -0,0 +1,1006 @@
+/*******************************************************************************
+
+    \file   solver_service.h
+
+    \brief  One inventory served to many processes over TCP.
+
+            Clients send fixed size request frames and may send as many as
+            they like before reading a reply.  Each reply carries the id of
+            its request, and replies can come back in a different order than
+            the requests went out.  All numbers are 32 bit big endian.
+
+                request  length (12), id, op and mode and two zero bytes,
+                         target
+                reply    length, id, status, pair count, then a value and
+                         count per pair
+
+            The reader thread of a connection queues every whole frame it has
+            received.  Whichever reader finds no batch running takes the
+            queue and solves it as one batch, then takes whatever arrived
+            meanwhile, until the queue is empty, so requests from every
+            connection share a batch without a dedicated solver thread.  In
+            a batch the SERVICE_LEAST_COUNT requests share one SolveMany()
+            table, reads see the counts as the batch found them, and the
+            SERVICE_DISPENSE requests are applied after them in arrival
+            order.
+
+            A batch never touches a socket.  Its replies are appended to each
+            connection's outgoing bytes, and every connection has a writer
+            thread that sends them, so a client that does not read its
+            replies only holds up its own writer.  A client that leaves more
+            than MAX_PENDING_BYTES unread is cut off.
+
+*******************************************************************************/
+
+#ifndef SOLVER_SERVICE_H
+#define SOLVER_SERVICE_H
+
+#include <vector>
+#include <algorithm>
+#include <exception>
+
+#include "subset.h"
+#include "solver_threads.h"
+#include "../../tcpip.h"
+#include "../../threads.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \brief  What a request asks for.
+
+            SERVICE_SOLVE       - AnilaoSolve() in the request's mode, the
+                                  counts are left alone.
+            SERVICE_LEAST_COUNT - LeastCountSolve(), the counts are left
+                                  alone.
+            SERVICE_DISPENSE    - AnilaoSolve() in the request's mode, and
+                                  the numbers are withdrawn.
+
+*******************************************************************************/
+enum TServiceOp
+{
+    SERVICE_SOLVE = 1,
+    SERVICE_LEAST_COUNT = 2,
+    SERVICE_DISPENSE = 3
+};
+
+/*******************************************************************************
+
+    \brief  How a request went.
+
+*******************************************************************************/
+enum TServiceStatus
+{
+    SERVICE_OK = 0,
+    SERVICE_NO_SOLUTION = 1,
+    SERVICE_BAD_REQUEST = 2
+};
+
+/*******************************************************************************
+
+    \brief  One reply, the solution is empty unless the status is
+            SERVICE_OK.
+
+*******************************************************************************/
+struct service_reply
+{
+    unsigned int id;
+    int status;
+    TCompactSolution solution;
+};
+
+/*******************************************************************************
+
+    \class  service_codec
+
+    \brief  Big endian numbers for the frames.
+
+*******************************************************************************/
+class service_codec
+{
+public:
+
+    // Bytes of a request after its length.
+    enum { REQUEST_SIZE = 12 };
+
+    // Most pairs a reply may carry.
+    enum { MAX_REPLY_PAIRS = 1 << 20 };
+
+    // Writes a number into four bytes.
+    static void Put(unsigned char * bytes, unsigned long number)
+    {
+        bytes[0] = (unsigned char) (number >> 24);
+        bytes[1] = (unsigned char) (number >> 16);
+        bytes[2] = (unsigned char) (number >> 8);
+        bytes[3] = (unsigned char) number;
+    }
+
+    // Reads a number from four bytes.
+    static unsigned long Get(const unsigned char * bytes)
+    {
+        return ((unsigned long) bytes[0] << 24) |
+               ((unsigned long) bytes[1] << 16) |
+               ((unsigned long) bytes[2] << 8) |
+               (unsigned long) bytes[3];
+    }
+
+    // Reads a signed number from four bytes.
+    static int GetSigned(const unsigned char * bytes)
+    {
+        const unsigned long number = Get(bytes);
+        return number > 0x7FFFFFFFul ?
+               -(int) (0xFFFFFFFFul - number) - 1 : (int) number;
+    }
+};
+
+/*******************************************************************************
+
+    \class  solver_service
+
+    \brief  Serves solves against one subset to TCP clients.
+
+*******************************************************************************/
+class solver_service
+{
+public:
+
+    // Most reply bytes a client may leave unread before it is cut off.
+    enum { MAX_PENDING_BYTES = 1 << 28 };
+
+    // First and longest wait before accepting again after a failure the
+    // listener can recover from, such as running out of handles.
+    enum { ACCEPT_RETRY_MILLISECONDS = 10 };
+    enum { MAX_ACCEPT_RETRY_MILLISECONDS = 1000 };
+
+    // Constructor, zero threads uses the hardware thread count.
+    solver_service(const TValueMap & values, unsigned thread_count = 0);
+
+    // Destructor, stops the service.
+    virtual ~solver_service();
+
+    // Starts listening on the loopback port, zero picks a free one.
+    void Start(unsigned short port = 0, bool loopback_only = true);
+
+    // The port being listened on.
+    unsigned short GetPort() const;
+
+    // Closes every connection and waits for the threads.
+    void Stop();
+
+    // Gets the current counts.
+    void GetValueMap(TValueMap & client_map);
+
+    // Requests received, and batches they were solved in.
+    unsigned long long GetRequestCount() const;
+    unsigned long long GetBatchCount() const;
+
+private:
+
+#ifdef _WIN32
+    typedef WinThread::Thread TThread;
+    typedef WinThread::Mutex TMutex;
+    typedef WinThread::Lock TLock;
+    typedef WinThread::Event TEvent;
+#else
+    typedef PosixThread::Thread TThread;
+    typedef PosixThread::Mutex TMutex;
+    typedef PosixThread::Lock TLock;
+    typedef PosixThread::Event TEvent;
+#endif
+
+    // One client.
+    struct connection
+    {
+        TcpIp::Socket socket;
+        TThread * reader;
+        TThread * writer;
+        solver_service * service;
+
+        // Replies waiting for the writer, and whether the client has been
+        // cut off.
+        std::vector<unsigned char> outgoing;
+        bool broken;
+        TMutex write_mutex;
+
+        // Set when there are replies to send or the last reference goes.
+        TEvent wake;
+
+        // The reader and every queued request hold a reference.
+        solver_atomic references;
+
+        // Set by the writer as it finishes, the client can be freed then.
+        solver_atomic finished;
+    };
+
+    // One queued request.
+    struct job
+    {
+        connection * from;
+        unsigned int id;
+        int op;
+        int mode;
+        int target;
+    };
+
+    // Not copyable, threads hold it by address.
+    solver_service(const solver_service &);
+    solver_service & operator=(const solver_service &);
+
+#ifdef _WIN32
+    static DWORD WINAPI AcceptEntry(void * arg);
+    static DWORD WINAPI ReadEntry(void * arg);
+    static DWORD WINAPI WriteEntry(void * arg);
+#else
+    static void * AcceptEntry(void * arg);
+    static void * ReadEntry(void * arg);
+    static void * WriteEntry(void * arg);
+#endif
+
+    // Accepts clients until stopped.
+    void AcceptLoop();
+
+    // Reads one client's frames until it closes.
+    void ReadLoop(connection & client);
+
+    // Sends one client's replies until its last reference goes.
+    void WriteLoop(connection & client);
+
+    // Drops a reference to a client, waking its writer after the last.
+    void Release(connection & client);
+
+    // Queues requests, and solves batches if none is running.
+    void Submit(std::vector<job> & jobs);
+
+    // Solves one batch and queues the replies.
+    void ProcessBatch(std::vector<job> & jobs);
+
+    // Queues one reply for the client's writer.
+    void Reply(connection & client, const service_reply & reply);
+
+    // Frees the clients that are done, or every client.
+    void Reap(bool all);
+
+    subset inventory;
+    TMutex inventory_mutex;
+    unsigned threads;
+
+    TcpIp::Socket listener;
+    TThread * accept_thread;
+
+    // Set by Stop(), so the accept thread knows a failed accept is the end
+    // and not something to wait out.  The event cuts the wait short.
+    solver_atomic stopping;
+    TEvent stop_event;
+
+    std::vector<connection *> connections;
+    TMutex connections_mutex;
+
+    // Requests waiting for a batch, and whether one is running.
+    std::vector<job> queue;
+    std::vector<job> batch;
+    bool combining;
+    TMutex queue_mutex;
+
+    solver_atomic requests;
+    solver_atomic batches;
+};
+
+/*******************************************************************************
+
+    \brief  Constructor
+
+    \param  const TValueMap & - The counts to serve.
+    \param  unsigned - Threads for SolveMany(), zero for the hardware count.
+
+*******************************************************************************/
+inline solver_service::solver_service(const TValueMap & values,
+                                      unsigned thread_count)
+    :
+    inventory(values),
+    threads(thread_count),
+    accept_thread(0),
+    combining(false)
+{}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline solver_service::~solver_service()
+{
+    Stop();
+}
+
+/*******************************************************************************
+
+    \brief  Thread entry points.
+
+*******************************************************************************/
+#ifdef _WIN32
+inline DWORD WINAPI solver_service::AcceptEntry(void * arg)
+{
+    solver_service & service = *reinterpret_cast<solver_service *>(arg);
+    service.AcceptLoop();
+    service.accept_thread->SetExecutionCompleteEvent();
+    return 0;
+}
+
+inline DWORD WINAPI solver_service::ReadEntry(void * arg)
+{
+    connection & client = *reinterpret_cast<connection *>(arg);
+    client.service->ReadLoop(client);
+    client.reader->SetExecutionCompleteEvent();
+    return 0;
+}
+
+inline DWORD WINAPI solver_service::WriteEntry(void * arg)
+{
+    connection & client = *reinterpret_cast<connection *>(arg);
+    client.service->WriteLoop(client);
+    client.writer->SetExecutionCompleteEvent();
+    return 0;
+}
+#else
+inline void * solver_service::AcceptEntry(void * arg)
+{
+    solver_service & service = *reinterpret_cast<solver_service *>(arg);
+    service.AcceptLoop();
+    service.accept_thread->SetExecutionCompleteEvent();
+    return 0;
+}
+
+inline void * solver_service::ReadEntry(void * arg)
+{
+    connection & client = *reinterpret_cast<connection *>(arg);
+    client.service->ReadLoop(client);
+    client.reader->SetExecutionCompleteEvent();
+    return 0;
+}
+
+inline void * solver_service::WriteEntry(void * arg)
+{
+    connection & client = *reinterpret_cast<connection *>(arg);
+    client.service->WriteLoop(client);
+    client.writer->SetExecutionCompleteEvent();
+    return 0;
+}
+#endif
+
+/*******************************************************************************
+
+    \brief  Starts listening and accepting clients.
+
+    \param  unsigned short - The port, zero picks a free one, see GetPort().
+    \param  bool - Only accept clients on this machine.
+
+*******************************************************************************/
+inline void solver_service::Start(unsigned short port, bool loopback_only)
+{
+    if(accept_thread != 0) throw std::exception();
+
+    listener.Listen(port, loopback_only);
+    stopping.Store(0);
+
+    accept_thread = new TThread(&AcceptEntry, this);
+    accept_thread->Resume();
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline unsigned short solver_service::GetPort() const
+{
+    return listener.GetPort();
+}
+
+/*******************************************************************************
+
+    \brief  Stops accepting, closes every client and waits for all of the
+            threads.  A batch being solved finishes first.
+
+*******************************************************************************/
+inline void solver_service::Stop()
+{
+    if(accept_thread == 0) return;
+
+    stopping.Store(1);
+    stop_event.Set();
+    listener.Interrupt();
+    accept_thread->WaitForThreadToDie();
+    delete accept_thread;
+    accept_thread = 0;
+    listener.Close();
+
+    {
+        TLock lock(connections_mutex);
+        for(size_t i = 0 ; i < connections.size() ; ++i)
+        {
+            connections[i]->socket.Interrupt();
+        }
+    }
+
+    Reap(true);
+}
+
+/*******************************************************************************
+
+    \brief  Joins and frees the clients whose writer has finished, which it
+            does once the reader has and every reply is sent, or every client.
+
+*******************************************************************************/
+inline void solver_service::Reap(bool all)
+{
+    std::vector<connection *> done;
+    {
+        TLock lock(connections_mutex);
+        size_t kept = 0;
+        for(size_t i = 0 ; i < connections.size() ; ++i)
+        {
+            if(all || connections[i]->finished.Load() != 0)
+            {
+                done.push_back(connections[i]);
+            }
+            else
+            {
+                connections[kept++] = connections[i];
+            }
+        }
+        connections.resize(kept);
+    }
+
+    // Outside the lock, a reader may be finishing a batch.
+    for(size_t i = 0 ; i < done.size() ; ++i)
+    {
+        done[i]->reader->WaitForThreadToDie();
+        done[i]->writer->WaitForThreadToDie();
+        delete done[i]->reader;
+        delete done[i]->writer;
+        delete done[i];
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Accepts clients and starts a reader for each, until Stop().
+            Any other accept failure is waited out, longer each time it
+            repeats, so running out of handles does not end the service.
+
+*******************************************************************************/
+inline void solver_service::AcceptLoop()
+{
+    unsigned long retry = ACCEPT_RETRY_MILLISECONDS;
+    while(true)
+    {
+        connection * client = new connection();
+        if(!listener.Accept(client->socket))
+        {
+            delete client;
+            if(stopping.Load() != 0) return;
+
+            // Clients that are done give their handles back.
+            Reap(false);
+            stop_event.Wait(retry);
+            if(stopping.Load() != 0) return;
+
+            retry = std::min(retry * 2,
+                             (unsigned long) MAX_ACCEPT_RETRY_MILLISECONDS);
+            continue;
+        }
+
+        retry = ACCEPT_RETRY_MILLISECONDS;
+
+        client->socket.SetNoDelay(true);
+        client->service = this;
+        client->broken = false;
+        client->references.Store(1);
+        client->reader = new TThread(&ReadEntry, client);
+        client->writer = new TThread(&WriteEntry, client);
+
+        Reap(false);
+        {
+            TLock lock(connections_mutex);
+            connections.push_back(client);
+        }
+
+        client->writer->Resume();
+        client->reader->Resume();
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Reads frames until the client closes or breaks the protocol.
+            Every whole frame of one receive is queued together.  A client
+            that closes cleanly still gets the replies already queued.
+
+*******************************************************************************/
+inline void solver_service::ReadLoop(connection & client)
+{
+    const size_t frame = 4 + service_codec::REQUEST_SIZE;
+
+    std::vector<unsigned char> buffer(64 * 1024);
+    std::vector<job> jobs;
+    size_t filled = 0;
+    bool broken = false;
+
+    while(!broken)
+    {
+        const size_t received = client.socket.Receive(&buffer[filled],
+                                                      buffer.size() - filled);
+        if(received == 0) break;
+        filled += received;
+
+        size_t used = 0;
+        jobs.clear();
+        while(filled - used >= frame)
+        {
+            const unsigned char * bytes = &buffer[used];
+            if(service_codec::Get(bytes) != service_codec::REQUEST_SIZE)
+            {
+                broken = true;
+                break;
+            }
+
+            job request;
+            request.from = &client;
+            request.id = (unsigned int) service_codec::Get(bytes + 4);
+            request.op = bytes[8];
+            request.mode = bytes[9];
+            request.target = service_codec::GetSigned(bytes + 12);
+            jobs.push_back(request);
+
+            used += frame;
+        }
+
+        if(!jobs.empty())
+        {
+            client.references.Add((long) jobs.size());
+            requests.Add((long) jobs.size());
+            Submit(jobs);
+        }
+
+        // Keep the start of a frame that has not fully arrived.
+        std::copy(buffer.begin() + used,
+                  buffer.begin() + filled,
+                  buffer.begin());
+        filled -= used;
+    }
+
+    if(broken) client.socket.Interrupt();
+    Release(client);
+}
+
+/*******************************************************************************
+
+    \brief  Sends whatever replies are queued each time it is woken, and
+            cuts the client off when a send fails.  Finishes after the last
+            reference has gone and its replies are sent.
+
+*******************************************************************************/
+inline void solver_service::WriteLoop(connection & client)
+{
+    std::vector<unsigned char> pending;
+
+    while(true)
+    {
+        client.wake.Wait();
+
+        // Every reply is queued before the reference it releases, so once
+        // the last has gone nothing more can be queued.
+        const bool last = client.references.Load() == 0;
+
+        while(true)
+        {
+            pending.clear();
+            {
+                TLock lock(client.write_mutex);
+                pending.swap(client.outgoing);
+            }
+            if(pending.empty()) break;
+
+            try
+            {
+                client.socket.SendAll(&pending[0], pending.size());
+            }
+            catch(...)
+            {
+                TLock lock(client.write_mutex);
+                client.broken = true;
+                client.outgoing.clear();
+                client.socket.Interrupt();
+            }
+        }
+
+        if(last) break;
+    }
+
+    client.socket.Interrupt();
+    client.finished.Store(1);
+}
+
+/*******************************************************************************
+
+    \brief  Drops a reference to a client.
+
+*******************************************************************************/
+inline void solver_service::Release(connection & client)
+{
+    if(client.references.Add(-1) == 0) client.wake.Set();
+}
+
+/*******************************************************************************
+
+    \brief  Queues requests.  If no batch is running this thread solves
+            batches until the queue is empty.  Batches only queue their
+            replies, so the combining thread never waits on a socket.
+
+*******************************************************************************/
+inline void solver_service::Submit(std::vector<job> & jobs)
+{
+    {
+        TLock lock(queue_mutex);
+        queue.insert(queue.end(), jobs.begin(), jobs.end());
+        if(combining) return;
+        combining = true;
+    }
+
+    while(true)
+    {
+        {
+            TLock lock(queue_mutex);
+            if(queue.empty())
+            {
+                combining = false;
+                return;
+            }
+            batch.swap(queue);
+        }
+
+        ProcessBatch(batch);
+        batch.clear();
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Solves one batch, then queues the replies with the inventory
+            unlocked.
+
+*******************************************************************************/
+inline void solver_service::ProcessBatch(std::vector<job> & jobs)
+{
+    std::vector<service_reply> replies(jobs.size());
+
+    {
+        TLock lock(inventory_mutex);
+        batches.Add(1);
+
+        TValueMap value_map;
+        inventory.GetValueMap(value_map);
+
+        // Every least count request shares one table.
+        std::vector<int> targets;
+        for(size_t i = 0 ; i < jobs.size() ; ++i)
+        {
+            if(jobs[i].op == SERVICE_LEAST_COUNT && jobs[i].target >= 0)
+            {
+                targets.push_back(jobs[i].target);
+            }
+        }
+
+        std::vector<TCountVector> counts;
+        try
+        {
+            if(!targets.empty()) inventory.SolveMany(targets, counts, threads);
+        }
+        catch(...)
+        {
+            counts.assign(targets.size(), TCountVector());
+        }
+
+        // Reads first, then the dispenses in arrival order.
+        size_t next_count = 0;
+        for(int pass = 0 ; pass < 2 ; ++pass)
+        {
+            for(size_t i = 0 ; i < jobs.size() ; ++i)
+            {
+                const job & request = jobs[i];
+                service_reply & reply = replies[i];
+
+                const bool dispense = request.op == SERVICE_DISPENSE;
+                if(dispense != (pass == 1)) continue;
+
+                reply.id = request.id;
+                reply.status = SERVICE_NO_SOLUTION;
+
+                if(request.target < 0)
+                {
+                    reply.status = SERVICE_BAD_REQUEST;
+                    continue;
+                }
+
+                if(request.op == SERVICE_LEAST_COUNT)
+                {
+                    const TCountVector & found = counts[next_count++];
+                    TValueMap::iterator value = value_map.begin();
+                    for(size_t k = 0 ; k < found.size() ; ++k, ++value)
+                    {
+                        if(found[k] > 0)
+                        {
+                            reply.solution.push_back(
+                                TDenomination(value->first, found[k]));
+                        }
+                    }
+
+                    if(!found.empty()) reply.status = SERVICE_OK;
+                    continue;
+                }
+
+                if((request.op != SERVICE_SOLVE && !dispense) ||
+                   request.mode > SOLVE_MEET_IN_MIDDLE)
+                {
+                    reply.status = SERVICE_BAD_REQUEST;
+                    continue;
+                }
+
+                try
+                {
+                    inventory.AnilaoSolve(request.target,
+                                          reply.solution,
+                                          (TSolveMode) request.mode);
+                    if(reply.solution.empty() && request.target != 0)
+                    {
+                        continue;
+                    }
+
+                    if(dispense)
+                    {
+                        TSolution numbers;
+                        for(size_t k = 0 ; k < reply.solution.size() ; ++k)
+                        {
+                            numbers.insert(numbers.end(),
+                                           reply.solution[k].second,
+                                           reply.solution[k].first);
+                        }
+                        inventory.Withdraw(numbers);
+                    }
+
+                    reply.status = SERVICE_OK;
+                }
+                catch(...)
+                {
+                    reply.solution.clear();
+                }
+            }
+        }
+    }
+
+    for(size_t i = 0 ; i < jobs.size() ; ++i)
+    {
+        Reply(*jobs[i].from, replies[i]);
+        Release(*jobs[i].from);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Appends one reply to the client's outgoing bytes and wakes its
+            writer.  A client that is cut off, or that would have more than
+            MAX_PENDING_BYTES waiting, gets nothing more, and its reader
+            then finishes.
+
+*******************************************************************************/
+inline void solver_service::Reply(connection & client,
+                                  const service_reply & reply)
+{
+    const size_t pairs = reply.solution.size();
+    const size_t length = 16 + pairs * 8;
+
+    {
+        TLock lock(client.write_mutex);
+        if(client.broken) return;
+
+        if(client.outgoing.size() + length > MAX_PENDING_BYTES)
+        {
+            client.broken = true;
+            client.outgoing.clear();
+            client.socket.Interrupt();
+            return;
+        }
+
+        const size_t start = client.outgoing.size();
+        client.outgoing.resize(start + length);
+        unsigned char * bytes = &client.outgoing[start];
+
+        service_codec::Put(&bytes[0], (unsigned long) (length - 4));
+        service_codec::Put(&bytes[4], reply.id);
+        service_codec::Put(&bytes[8], (unsigned long) reply.status);
+        service_codec::Put(&bytes[12], (unsigned long) pairs);
+        for(size_t i = 0 ; i < pairs ; ++i)
+        {
+            service_codec::Put(&bytes[16 + i * 8],
+                               (unsigned long) reply.solution[i].first);
+            service_codec::Put(&bytes[20 + i * 8],
+                               (unsigned long) reply.solution[i].second);
+        }
+    }
+
+    client.wake.Set();
+}
+
+/*******************************************************************************
+
+    \brief  Gets the current counts.
+
+*******************************************************************************/
+inline void solver_service::GetValueMap(TValueMap & client_map)
+{
+    TLock lock(inventory_mutex);
+    inventory.GetValueMap(client_map);
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline unsigned long long solver_service::GetRequestCount() const
+{
+    return (unsigned long long) requests.Load();
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline unsigned long long solver_service::GetBatchCount() const
+{
+    return (unsigned long long) batches.Load();
+}
+
+/*******************************************************************************
+
+    \class  solver_client
+
+    \brief  Sends requests to a solver_service and reads the replies.
+
+*******************************************************************************/
+class solver_client
+{
+public:
+
+    // Constructor.
+    solver_client();
+
+    // Destructor.
+    virtual ~solver_client();
+
+    // Connects to a service.
+    void Connect(const char * host, unsigned short port);
+
+    // Sends a request, without waiting for its reply.
+    void Send(unsigned int id,
+              TServiceOp op,
+              int target,
+              TSolveMode mode = SOLVE_RECURSIVE);
+
+    // Reads the next reply, false if the service closed.
+    bool Receive(service_reply & reply);
+
+    // Closes the connection.
+    void Close();
+
+private:
+
+    // Not copyable, owns the socket.
+    solver_client(const solver_client &);
+    solver_client & operator=(const solver_client &);
+
+    TcpIp::Socket socket;
+    std::vector<unsigned char> buffer;
+};
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline solver_client::solver_client() {}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline solver_client::~solver_client() {}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline void solver_client::Connect(const char * host, unsigned short port)
+{
+    socket.Connect(host, port);
+    socket.SetNoDelay(true);
+}
+
+/*******************************************************************************
+
+    \brief  Sends a request.  Replies are matched by id, any number of
+            requests may be sent before reading them.
+
+*******************************************************************************/
+inline void solver_client::Send(unsigned int id,
+                                TServiceOp op,
+                                int target,
+                                TSolveMode mode)
+{
+    unsigned char bytes[4 + service_codec::REQUEST_SIZE] = { 0 };
+    service_codec::Put(&bytes[0], service_codec::REQUEST_SIZE);
+    service_codec::Put(&bytes[4], id);
+    bytes[8] = (unsigned char) op;
+    bytes[9] = (unsigned char) mode;
+    service_codec::Put(&bytes[12], (unsigned long) target);
+
+    socket.SendAll(bytes, sizeof(bytes));
+}
+
+/*******************************************************************************
+
+    \brief  Reads the next reply.
+
+    \return bool - False if the service closed the connection.
+
+    \note   Throws if the reply is malformed.
+
+*******************************************************************************/
+inline bool solver_client::Receive(service_reply & reply)
+{
+    unsigned char head[16];
+    if(!socket.ReceiveAll(head, sizeof(head))) return false;
+
+    const unsigned long pairs = service_codec::Get(head + 12);
+    if(pairs > service_codec::MAX_REPLY_PAIRS ||
+       service_codec::Get(head) != 12 + pairs * 8)
+    {
+        throw std::exception();
+    }
+
+    reply.id = (unsigned int) service_codec::Get(head + 4);
+    reply.status = (int) service_codec::Get(head + 8);
+    reply.solution.clear();
+
+    buffer.resize(pairs * 8);
+    if(pairs > 0 && !socket.ReceiveAll(&buffer[0], buffer.size()))
+    {
+        return false;
+    }
+
+    for(unsigned long i = 0 ; i < pairs ; ++i)
+    {
+        reply.solution.push_back(
+            TDenomination(service_codec::GetSigned(&buffer[i * 8]),
+                          service_codec::GetSigned(&buffer[i * 8 + 4])));
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline void solver_client::Close()
+{
+    socket.Close();
+}
+}
+
+#endif
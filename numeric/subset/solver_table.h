@@ -0,0 +1,583 @@
+/*******************************************************************************
+
+    \file   solver_table.h
+
+    \brief  Precomputed change table for a fixed set of values, kept in a
+            file and memory mapped read only.
+
+            For every sum up to a bound the table holds the fewest numbers
+            that make it with unlimited counts, and the value the last of
+            those numbers is, so a solution is read back in one walk.  A
+            solution from the table is the answer for real counts whenever
+            it fits in them.
+
+            The file is the header, the values, the fewest numbers per sum
+            and the last value index per sum, all 32 bit in the byte order of
+            the machine that wrote it.  Open() maps it without reading it, so
+            processes that open the same file share its pages and answer
+            queries as soon as they start.  The values are checked when the
+            file is opened, each last value index as a lookup walks over it,
+            so a damaged file throws instead of reading outside the mapping.
+
+            Write() writes a temporary file beside the target and renames it
+            over the target, so a process that has the old file mapped keeps
+            reading the old pages and never sees a short file.  On windows a
+            file that is mapped cannot be replaced, and Write() throws.
+
+*******************************************************************************/
+
+#ifndef SOLVER_TABLE_H
+#define SOLVER_TABLE_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <exception>
+
+#include "change_solver.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Identifies a table file, and the format it is in.
+#define SOLVER_TABLE_MAGIC "SUBSTBL"
+#define SOLVER_TABLE_VERSION 1
+
+// Written as a number, reads back differently in the other byte order.
+#define SOLVER_TABLE_BYTE_ORDER 0x01020304
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  solver_table
+
+    \brief  Read only fewest numbers table mapped from a file.
+
+*******************************************************************************/
+class solver_table
+{
+public:
+
+    // Constructor.
+    solver_table();
+
+    // Destructor, unmaps the file.
+    virtual ~solver_table();
+
+    // Builds the table for the values up to the bound and writes the file.
+    static void Write(const char * path,
+                      const std::vector<int> & values,
+                      int bound);
+
+    // Maps a table file, throws if it is not a valid table.
+    void Open(const char * path);
+
+    // Unmaps the file.
+    void Close();
+
+    // True while a file is mapped.
+    bool IsOpen() const;
+
+    // The values, ascending.
+    void GetValues(std::vector<int> & client_values) const;
+
+    // Largest sum in the table.
+    int GetBound() const;
+
+    // Fewest numbers for a sum, -1 if none.
+    int GetLeastCount(int target) const;
+
+    // How many of each value the fewest numbers use, false if none.
+    bool Lookup(int target, std::vector<int> & solution_counts) const;
+
+    // Lookup() that also fails if the solution does not fit the counts.
+    bool Lookup(int target,
+                const std::vector<int> & counts,
+                std::vector<int> & solution_counts) const;
+
+    // Solves for the counts, with change_solver when the table's answer does
+    // not fit them or the target is past the bound.
+    bool Solve(int target,
+               const std::vector<int> & counts,
+               std::vector<int> & solution_counts) const;
+
+private:
+
+    // Start of the file.
+    struct header
+    {
+        char magic[8];
+        int version;
+        int byte_order;
+        int value_count;
+        int bound;
+    };
+
+    // Marks a sum that cannot be reached.
+    enum { UNREACHABLE = -1 };
+
+    // Not copyable, owns the mapping.
+    solver_table(const solver_table &);
+    solver_table & operator=(const solver_table &);
+
+    // Points the arrays into the mapping, throws if it is not valid.
+    void Attach();
+
+    // The mapped bytes.
+    const char * data;
+    size_t size;
+
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+    // Parts of the mapping.
+    const header * table_header;
+    const int * values;
+    const int * least;
+    const int * last;
+};
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline solver_table::solver_table()
+    :
+    data(0),
+    size(0),
+#ifdef _WIN32
+    file(INVALID_HANDLE_VALUE),
+    mapping(0),
+#endif
+    table_header(0),
+    values(0),
+    least(0),
+    last(0)
+{}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline solver_table::~solver_table()
+{
+    Close();
+}
+
+/*******************************************************************************
+
+    \brief  Builds the table and writes the file, through a temporary file
+            named after the path and the process that is renamed over it.
+
+    \param  const char * - Path of the file to write.
+    \param  const std::vector<int> & - The values, positive and ascending.
+    \param  int - Largest sum the table covers.
+
+*******************************************************************************/
+inline void solver_table::Write(const char * path,
+                                const std::vector<int> & values,
+                                int bound)
+{
+    if(bound < 0 || bound == INT_MAX || values.empty())
+    {
+        throw std::exception();
+    }
+
+    for(size_t i = 0 ; i < values.size() ; ++i)
+    {
+        if(values[i] <= 0) throw std::exception();
+        if(i > 0 && values[i] <= values[i - 1]) throw std::exception();
+    }
+
+    // Unbounded change making, the last value kept for each sum.
+    std::vector<int> least_table(bound + 1, UNREACHABLE);
+    std::vector<int> last_table(bound + 1, UNREACHABLE);
+    least_table[0] = 0;
+    for(int sum = 1 ; sum <= bound ; ++sum)
+    {
+        for(size_t i = 0 ; i < values.size() && values[i] <= sum ; ++i)
+        {
+            const int before = least_table[sum - values[i]];
+            if(before == UNREACHABLE) continue;
+
+            if(least_table[sum] == UNREACHABLE ||
+               before + 1 < least_table[sum])
+            {
+                least_table[sum] = before + 1;
+                last_table[sum] = (int) i;
+            }
+        }
+    }
+
+    header file_header;
+    std::memset(&file_header, 0, sizeof(file_header));
+    std::memcpy(file_header.magic, SOLVER_TABLE_MAGIC,
+                sizeof(SOLVER_TABLE_MAGIC));
+    file_header.version = SOLVER_TABLE_VERSION;
+    file_header.byte_order = SOLVER_TABLE_BYTE_ORDER;
+    file_header.value_count = (int) values.size();
+    file_header.bound = bound;
+
+#ifdef _WIN32
+    const unsigned long process = (unsigned long) GetCurrentProcessId();
+#else
+    const unsigned long process = (unsigned long) getpid();
+#endif
+    std::ostringstream temp_name;
+    temp_name << path << '.' << process << ".tmp";
+    const std::string temp_path = temp_name.str();
+
+    std::ofstream out(temp_path.c_str(), std::ios::out | std::ios::binary);
+    out.write((const char *) &file_header, sizeof(file_header));
+    out.write((const char *) &values[0], values.size() * sizeof(int));
+    out.write((const char *) &least_table[0],
+              least_table.size() * sizeof(int));
+    out.write((const char *) &last_table[0],
+              last_table.size() * sizeof(int));
+    out.close();
+
+    // Only a whole file replaces the old one.
+#ifdef _WIN32
+    const bool replaced = out &&
+        MoveFileExA(temp_path.c_str(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    const bool replaced = out && std::rename(temp_path.c_str(), path) == 0;
+#endif
+    if(!replaced)
+    {
+        std::remove(temp_path.c_str());
+        throw std::exception();
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Points the arrays into the mapping, checking the header, the
+            size and the values first.
+
+*******************************************************************************/
+inline void solver_table::Attach()
+{
+    if(size < sizeof(header)) throw std::exception();
+
+    table_header = (const header *) data;
+    if(std::memcmp(table_header->magic,
+                   SOLVER_TABLE_MAGIC,
+                   sizeof(SOLVER_TABLE_MAGIC)) != 0 ||
+       table_header->version != SOLVER_TABLE_VERSION ||
+       table_header->byte_order != SOLVER_TABLE_BYTE_ORDER ||
+       table_header->value_count <= 0 ||
+       table_header->bound < 0)
+    {
+        throw std::exception();
+    }
+
+    const size_t expected =
+        sizeof(header) +
+        (size_t) table_header->value_count * sizeof(int) +
+        ((size_t) table_header->bound + 1) * 2 * sizeof(int);
+    if(size != expected) throw std::exception();
+
+    values = (const int *) (data + sizeof(header));
+    least = values + table_header->value_count;
+    last = least + table_header->bound + 1;
+
+    // Write() only takes positive ascending values.
+    for(int i = 0 ; i < table_header->value_count ; ++i)
+    {
+        if(values[i] <= 0 || (i > 0 && values[i] <= values[i - 1]))
+        {
+            throw std::exception();
+        }
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Maps a table file read only.
+
+    \note   Throws if the file cannot be mapped or is not a table of this
+            version and byte order.
+
+*******************************************************************************/
+inline void solver_table::Open(const char * path)
+{
+    Close();
+
+#ifdef _WIN32
+    file = CreateFileA(path,
+                       GENERIC_READ,
+                       FILE_SHARE_READ,
+                       0,
+                       OPEN_EXISTING,
+                       FILE_ATTRIBUTE_NORMAL,
+                       0);
+    if(file == INVALID_HANDLE_VALUE) throw std::exception();
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+    {
+        Close();
+        throw std::exception();
+    }
+
+    mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    if(mapping == 0)
+    {
+        Close();
+        throw std::exception();
+    }
+
+    data = (const char *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(data == 0)
+    {
+        Close();
+        throw std::exception();
+    }
+
+    size = (size_t) file_size.QuadPart;
+#else
+    const int descriptor = open(path, O_RDONLY);
+    if(descriptor < 0) throw std::exception();
+
+    struct stat status;
+    if(fstat(descriptor, &status) != 0 || status.st_size == 0)
+    {
+        close(descriptor);
+        throw std::exception();
+    }
+
+    void * mapped = mmap(0,
+                         (size_t) status.st_size,
+                         PROT_READ,
+                         MAP_SHARED,
+                         descriptor,
+                         0);
+
+    // The mapping holds its own reference to the file.
+    close(descriptor);
+    if(mapped == MAP_FAILED) throw std::exception();
+
+    data = (const char *) mapped;
+    size = (size_t) status.st_size;
+#endif
+
+    try
+    {
+        Attach();
+    }
+    catch(...)
+    {
+        Close();
+        throw;
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Unmaps the file, does nothing if none is open.
+
+*******************************************************************************/
+inline void solver_table::Close()
+{
+#ifdef _WIN32
+    if(data != 0) UnmapViewOfFile(data);
+    if(mapping != 0) CloseHandle(mapping);
+    if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    mapping = 0;
+    file = INVALID_HANDLE_VALUE;
+#else
+    if(data != 0) munmap((void *) data, size);
+#endif
+
+    data = 0;
+    size = 0;
+    table_header = 0;
+    values = 0;
+    least = 0;
+    last = 0;
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline bool solver_table::IsOpen() const
+{
+    return data != 0;
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline void solver_table::GetValues(std::vector<int> & client_values) const
+{
+    if(!IsOpen()) throw std::exception();
+
+    client_values.assign(values, values + table_header->value_count);
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline int solver_table::GetBound() const
+{
+    if(!IsOpen()) throw std::exception();
+
+    return table_header->bound;
+}
+
+/*******************************************************************************
+
+    \brief  Fewest numbers for a sum, -1 if no combination reaches it.
+
+    \note   Throws if no table is open or the sum is past the bound.
+
+*******************************************************************************/
+inline int solver_table::GetLeastCount(int target) const
+{
+    if(!IsOpen() || target < 0 || target > table_header->bound)
+    {
+        throw std::exception();
+    }
+
+    return least[target];
+}
+
+/*******************************************************************************
+
+    \brief  Reads back the fewest numbers for a sum.
+
+    \param  int - The target number, up to the bound.
+    \param  std::vector<int> & - How many of each value, in ascending value
+                                 order.
+
+    \return bool - False if no combination reaches the sum.
+
+    \note   Throws if a last value index in the file is out of range or does
+            not lead to a sum one number fewer, so the walk always ends.
+
+*******************************************************************************/
+inline bool solver_table::Lookup(int target,
+                                 std::vector<int> & solution_counts) const
+{
+    solution_counts.clear();
+    if(GetLeastCount(target) == UNREACHABLE) return false;
+
+    solution_counts.assign(table_header->value_count, 0);
+    while(target > 0)
+    {
+        const int index = last[target];
+        if(index < 0 || index >= table_header->value_count ||
+           values[index] > target ||
+           least[target - values[index]] != least[target] - 1)
+        {
+            solution_counts.clear();
+            throw std::exception();
+        }
+
+        ++solution_counts[index];
+        target -= values[index];
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief  Reads back the fewest numbers for a sum if they fit the counts.
+
+    \param  int - The target number, up to the bound.
+    \param  const std::vector<int> & - How many of each value there are.
+    \param  std::vector<int> & - How many of each value to use.
+
+    \return bool - False if there is no solution or it needs more of a value
+                   than there is.  Another solution may still fit then,
+                   Solve() goes on to change_solver for it.
+
+*******************************************************************************/
+inline bool solver_table::Lookup(int target,
+                                 const std::vector<int> & counts,
+                                 std::vector<int> & solution_counts) const
+{
+    if(!IsOpen() || counts.size() != (size_t) table_header->value_count)
+    {
+        throw std::exception();
+    }
+
+    if(!Lookup(target, solution_counts)) return false;
+
+    for(size_t i = 0 ; i < counts.size() ; ++i)
+    {
+        if(solution_counts[i] > counts[i])
+        {
+            solution_counts.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief  Solves for the counts, the table first.
+
+    \param  int - The target number.
+    \param  const std::vector<int> & - How many of each value there are.
+    \param  std::vector<int> & - How many of each value to use.
+
+    \return bool - True if a solution was found.  The table answers when its
+                   fewest numbers fit the counts or no sum is reachable at
+                   all, otherwise change_solver builds for the target.
+
+*******************************************************************************/
+inline bool solver_table::Solve(int target,
+                                const std::vector<int> & counts,
+                                std::vector<int> & solution_counts) const
+{
+    if(!IsOpen() || counts.size() != (size_t) table_header->value_count)
+    {
+        throw std::exception();
+    }
+
+    solution_counts.clear();
+    if(target < 0) return false;
+
+    if(target <= table_header->bound)
+    {
+        if(Lookup(target, counts, solution_counts)) return true;
+
+        // Not reachable with unlimited counts, so not with these.
+        if(least[target] == UNREACHABLE) return false;
+    }
+
+    std::vector<int> table_values;
+    GetValues(table_values);
+
+    change_solver fallback;
+    return fallback.Solve(table_values, counts, target, solution_counts);
+}
+}
+
+#endif
@@ -0,0 +1,336 @@
+/*******************************************************************************
+
+    \file   solver_threads.h
+
+    \brief  Runs solver work on several threads.
+
+            A task is any object with an operator()(size_t index).  The
+            indices are split into one contiguous range per thread, so each
+            thread writes its own part of the output and no locking is needed
+            as long as the task only reads shared state.  Uses WinThread on
+            windows and PosixThread everywhere else, see threads.h.
+
+            solver_atomic is a lock free integer for state the threads do
+            share, such as the best bound of a search.
+
+*******************************************************************************/
+
+#ifndef SOLVER_THREADS_H
+#define SOLVER_THREADS_H
+
+#include <vector>
+#include <cstddef>
+#include <exception>
+
+#include "../../threads.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  solver_threads
+
+    \brief  Splits a range of indices across threads.
+
+*******************************************************************************/
+class solver_threads
+{
+public:
+
+    // Number of threads the hardware can run at once, at least one.
+    static unsigned GetHardwareThreadCount();
+
+    // Calls task(i) for every i in [0, count), on up to thread_count threads.
+    // Zero uses the hardware thread count.  Ranges smaller than min_chunk
+    // are not worth a thread of their own.
+    template <class TTask>
+    static void Run(size_t count,
+                    TTask & task,
+                    unsigned thread_count = 0,
+                    size_t min_chunk = 1);
+
+private:
+
+#ifdef _WIN32
+    typedef WinThread::Thread TThread;
+#else
+    typedef PosixThread::Thread TThread;
+#endif
+
+    // One thread's share of the indices.
+    template <class TTask>
+    struct range
+    {
+        TTask * task;
+        size_t begin;
+        size_t end;
+        TThread * thread;
+        bool failed;
+    };
+
+    // Runs one range, exceptions are recorded rather than leaving the thread.
+    template <class TTask>
+    static void RunRange(range<TTask> & work);
+
+#ifdef _WIN32
+    template <class TTask>
+    static DWORD WINAPI Entry(void * arg);
+#else
+    template <class TTask>
+    static void * Entry(void * arg);
+#endif
+};
+
+/*******************************************************************************
+
+    \class  solver_atomic
+
+    \brief  An integer that threads can read and update without a lock.
+
+*******************************************************************************/
+class solver_atomic
+{
+public:
+
+    // Constructor.
+    solver_atomic(long initial = 0);
+
+    // Reads the value.
+    long Load() const;
+
+    // Sets the value.
+    void Store(long desired);
+
+    // Sets the value to desired if it is still expected, true if it was.
+    bool CompareExchange(long expected, long desired);
+
+    // Adds to the value, returns the new value.
+    long Add(long amount);
+
+    // Lowers the value to candidate if candidate is lower, true if it was.
+    bool StoreMin(long candidate);
+
+private:
+
+    // Not copyable, threads hold it by address.
+    solver_atomic(const solver_atomic &);
+    solver_atomic & operator=(const solver_atomic &);
+
+    volatile long value;
+};
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline solver_atomic::solver_atomic(long initial) : value(initial) {}
+
+/*******************************************************************************
+
+    \brief  Reads the value.
+
+*******************************************************************************/
+inline long solver_atomic::Load() const
+{
+    // A plain aligned read, kept cheap since searches read it per node.
+#if defined(__ATOMIC_ACQUIRE)
+    return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+#else
+    return value;
+#endif
+}
+
+/*******************************************************************************
+
+    \brief  Sets the value.
+
+*******************************************************************************/
+inline void solver_atomic::Store(long desired)
+{
+    long seen = Load();
+    while(!CompareExchange(seen, desired)) seen = Load();
+}
+
+/*******************************************************************************
+
+    \brief  Sets the value to desired if it is still expected.
+
+*******************************************************************************/
+inline bool solver_atomic::CompareExchange(long expected, long desired)
+{
+#ifdef _WIN32
+    return InterlockedCompareExchange(&value, desired, expected) == expected;
+#else
+    return __sync_bool_compare_and_swap(&value, expected, desired);
+#endif
+}
+
+/*******************************************************************************
+
+    \brief  Adds to the value.
+
+*******************************************************************************/
+inline long solver_atomic::Add(long amount)
+{
+#ifdef _WIN32
+    return InterlockedExchangeAdd(&value, amount) + amount;
+#else
+    return __sync_add_and_fetch(&value, amount);
+#endif
+}
+
+/*******************************************************************************
+
+    \brief  Lowers the value to candidate if candidate is lower.
+
+*******************************************************************************/
+inline bool solver_atomic::StoreMin(long candidate)
+{
+    long seen = Load();
+    while(candidate < seen)
+    {
+        if(CompareExchange(seen, candidate)) return true;
+        seen = Load();
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+
+    \brief  Number of threads the hardware can run at once.
+
+*******************************************************************************/
+inline unsigned solver_threads::GetHardwareThreadCount()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long processors = (long) info.dwNumberOfProcessors;
+#else
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    return processors > 0 ? (unsigned) processors : 1;
+}
+
+/*******************************************************************************
+
+    \brief  Runs one range.
+
+*******************************************************************************/
+template <class TTask>
+inline void solver_threads::RunRange(range<TTask> & work)
+{
+    try
+    {
+        for(size_t i = work.begin ; i < work.end ; ++i) (*work.task)(i);
+    }
+    catch(...)
+    {
+        work.failed = true;
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Thread entry point.
+
+*******************************************************************************/
+#ifdef _WIN32
+template <class TTask>
+inline DWORD WINAPI solver_threads::Entry(void * arg)
+{
+    range<TTask> & work = *reinterpret_cast<range<TTask> *>(arg);
+    RunRange(work);
+    work.thread->SetExecutionCompleteEvent();
+    return 0;
+}
+#else
+template <class TTask>
+inline void * solver_threads::Entry(void * arg)
+{
+    range<TTask> & work = *reinterpret_cast<range<TTask> *>(arg);
+    RunRange(work);
+    work.thread->SetExecutionCompleteEvent();
+    return 0;
+}
+#endif
+
+/*******************************************************************************
+
+    \brief  Calls task(i) for every index, split across threads.  The calling
+            thread runs the first range itself.
+
+    \param  size_t - Number of indices.
+    \param  TTask & - Called once per index.
+    \param  unsigned - Most threads to use, zero for the hardware count.
+    \param  size_t - Fewest indices worth giving to a thread.
+
+    \note   Throws after every thread is done if any task threw.
+
+*******************************************************************************/
+template <class TTask>
+inline void solver_threads::Run(size_t count,
+                                TTask & task,
+                                unsigned thread_count,
+                                size_t min_chunk)
+{
+    if(count == 0) return;
+
+    if(thread_count == 0) thread_count = GetHardwareThreadCount();
+    if(min_chunk == 0) min_chunk = 1;
+
+    size_t ranges = count / min_chunk;
+    if(ranges > thread_count) ranges = thread_count;
+    if(ranges < 1) ranges = 1;
+
+    std::vector<range<TTask> > work(ranges);
+    for(size_t r = 0 ; r < ranges ; ++r)
+    {
+        work[r].task = &task;
+        work[r].begin = count * r / ranges;
+        work[r].end = count * (r + 1) / ranges;
+        work[r].thread = 0;
+        work[r].failed = false;
+    }
+
+    // Start the other ranges suspended so their thread pointer is set
+    // before they run.
+    for(size_t r = 1 ; r < ranges ; ++r)
+    {
+        try
+        {
+            work[r].thread = new TThread(&Entry<TTask>, &work[r]);
+            work[r].thread->Resume();
+        }
+        catch(...)
+        {
+            // No thread to be had, run the range here instead.
+            RunRange(work[r]);
+        }
+    }
+
+    RunRange(work[0]);
+
+    bool failed = work[0].failed;
+    for(size_t r = 1 ; r < ranges ; ++r)
+    {
+        if(work[r].thread != 0)
+        {
+            work[r].thread->WaitForThreadToDie();
+            delete work[r].thread;
+        }
+        failed = failed || work[r].failed;
+    }
+
+    if(failed) throw std::exception();
+}
+}
+
+#endif
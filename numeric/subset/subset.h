@@ -14,10 +14,22 @@
 #include <set>
 #include <map>
 #include <vector>
+#include <cstddef>
 #include <numeric>
 #include <algorithm>
 #include <exception>
 
+#include "bitset_solver.h"
+#include "change_solver.h"
+#include "solver_threads.h"
+#include "solution_enumerator.h"
+#include "solver_arena.h"
+#include "branch_bound_solver.h"
+#include "meet_middle_solver.h"
+#include "even_depletion_solver.h"
+#include "solution_cache.h"
+#include "parallel_branch_bound.h"
+
 namespace numeric
 {
 /*******************************************************************************
@@ -74,6 +86,67 @@ typedef std::vector<TBlock> TBlockVector;
 *******************************************************************************/
 typedef std::vector<int> TDispenser;
 
+/*******************************************************************************
+
+    \brief  A value and how many of it there are.
+
+*******************************************************************************/
+typedef std::pair<int, int> TDenomination;
+
+/*******************************************************************************
+
+    \brief  A dispenser held as one value and count pair per distinct value,
+            in ascending value order.  Its size follows the number of
+            distinct values, not the number of units.
+
+*******************************************************************************/
+typedef std::vector<TDenomination> TCountDispenser;
+
+/*******************************************************************************
+
+    \brief  How many of each value a solution uses, in the ascending value
+            order of the TValueMap.
+
+*******************************************************************************/
+typedef std::vector<int> TCountVector;
+
+/*******************************************************************************
+
+    \brief  A solution held as one value and count pair per value it uses, in
+            ascending value order.  A buffer kept by the caller is reused, so
+            solving into it does not allocate once it is big enough.
+
+*******************************************************************************/
+typedef std::vector<TDenomination> TCompactSolution;
+
+/*******************************************************************************
+
+    \brief  How AnilaoSolve() searches the whole block.
+
+            SOLVE_RECURSIVE - Tries every subset, keeps the one with the
+                              fewest numbers.  Exponential in the block size.
+            SOLVE_BITSET    - Word parallel bitset reachability, linear in the
+                              block size and the target.  Returns a solution,
+                              not necessarily the one with the fewest numbers.
+            SOLVE_PARALLEL  - Branch and bound split across threads.  Returns
+                              a solution with the fewest numbers, equal size
+                              solutions may be picked differently.
+            SOLVE_MEET_IN_MIDDLE
+                            - Joins the sorted sums of two halves of the
+                              block.  Fewest numbers, and the cost does not
+                              depend on the target, for blocks of up to about
+                              50 numbers.  Larger blocks fall back to branch
+                              and bound on the calling thread.
+
+*******************************************************************************/
+enum TSolveMode
+{
+    SOLVE_RECURSIVE,
+    SOLVE_BITSET,
+    SOLVE_PARALLEL,
+    SOLVE_MEET_IN_MIDDLE
+};
+
 /*******************************************************************************
 
     \class  Class to solve subsets of groups of numbers.
@@ -100,16 +173,28 @@ private:
     TValues values;
 
     // The dispenser that holds all of the numbers.
-    TDispenser master_dispenser;
+    TCountDispenser master_dispenser;
 
     // Maps the value to the count.
     TValueMap value_map;
 
-    // The vector of whole blocks.
-    TBlockVector whole_blocks;
+    // Every whole block holds the definition, this is one of them.
+    TBlock whole_block;
+
+    // The number of whole blocks.
+    int whole_block_count;
+
+    // What is left once the whole blocks are taken out.
+    TCountDispenser partial_dispenser;
 
-    // The vector of partial blocks.
-    TBlockVector partial_blocks;
+    // Bumped every time the counts change.
+    unsigned long revision;
+
+    // Hash of the counts, keys the cache.
+    unsigned long long fingerprint;
+
+    // Recent solutions, off until given a capacity.
+    solution_cache cache;
 
 public:
 
@@ -134,38 +219,94 @@ public:
     // Uses the generic least number algorithm.
     TSolution LeastSolve(int target);
 
+    // LeastSolve() into a caller's buffer, without the cache.
+    void LeastSolve(int target, TCompactSolution & solution);
+
+    // Fewest numbers for the target within the counts, never misses.
+    TCountVector LeastCountSolve(int target);
+
+    // LeastCountSolve() for many targets, sharing one table.
+    void SolveMany(const std::vector<int> & targets,
+                   std::vector<TCountVector> & solutions,
+                   unsigned thread_count = 0);
+
     // Algorithm which tries to deplete the values as even as possible.
-    TSolution AnilaoSolve(int target);
+    TSolution AnilaoSolve(int target, TSolveMode mode = SOLVE_RECURSIVE);
+
+    // AnilaoSolve() into a caller's buffer, without the cache.
+    void AnilaoSolve(int target,
+                     TCompactSolution & solution,
+                     TSolveMode mode = SOLVE_RECURSIVE);
+
+    // Exact sum with the lowest largest drawdown of any value's count.
+    TCountVector EvenSolve(int target);
+
+    // AnilaoSolve() that stops searching the whole block when the budget
+    // runs out, optimal is false if the search did not finish.
+    TSolution AnilaoSolve(int target,
+                          const solve_budget & budget,
+                          bool & optimal,
+                          TSolveMode mode = SOLVE_RECURSIVE);
+
+    // Lists the whole block solutions lazily, fewest numbers first.
+    solution_enumerator EnumerateWholeBlock(int target) const;
+
+    // Takes the numbers of a solution out of the counts.
+    void Withdraw(const TSolution & solution);
+
+    // Adds numbers of one value to the counts.
+    void Deposit(int value, int count);
+
+    // Gets the current counts.
+    void GetValueMap(TValueMap & client_map);
+
+    // Changes every time the counts change, for keying cached results.
+    unsigned long GetRevision() const;
+
+    // Caches up to capacity LeastSolve() and AnilaoSolve() results, zero
+    // turns the cache off.
+    void SetCacheCapacity(size_t capacity);
+
+    // Solves answered from the cache.
+    unsigned long long GetCacheHits() const;
+
+    // Solves the cache could not answer.
+    unsigned long long GetCacheMisses() const;
 
 protected:
 
     // Initializes the class.
     void Initialize();
 
+    // Recalculates the definition and the blocks after the counts change.
+    void Refresh(bool values_changed);
+
+    // Finds the dispenser entry of a value, end() if there is none.
+    TCountDispenser::iterator FindDenomination(int value);
+
+    // AnilaoSolve() without the cache.
+    TSolution AnilaoSolveUncached(int target, TSolveMode mode);
+
     // Solve with least algorithm, but only on the given dispenser.
-    TSolution LeastSolveOnDispenser(int target, 
-                                    const TDispenser & dispenser) const;
+    TSolution LeastSolveOnDispenser(int target,
+                                    const TCountDispenser & dispenser) const;
 
-    // Returns left over.
-    TBlockVector CalculatePartialBlocks(const TDispenser & original_dispenser,
-                                        TDispenser & left_over);
+    // LeastSolveOnDispenser() into a buffer, false if there is no solution.
+    bool LeastSolveOnDispenser(int target,
+                               const TCountDispenser & dispenser,
+                               TCompactSolution & solution) const;
 
     // Returns left over.
-    TBlockVector CalculateWholeBlocks(const TDispenser & original_dispenser,
-                                      TDispenser & left_over);
+    TBlockVector
+    CalculatePartialBlocks(const TCountDispenser & original_dispenser,
+                           TCountDispenser & left_over) const;
+
+    // Returns the number of whole blocks and the left over.
+    int CalculateWholeBlocks(const TCountDispenser & original_dispenser,
+                             TCountDispenser & left_over) const;
 
     // Calculates the optimum set of number each block should be.
     TBlock CalculateDefinition(int & low, int & high);
-
-private:
-
-    // Execute a recursive subset solving algorithm.
-    void SubsetRecurse(TBlock numbers,
-                       TBlockVector & result,
-                       int target,
-                       TSolution & output,
-                       int index,
-                       int sum);
 };
 
 /*******************************************************************************
@@ -177,7 +318,10 @@ private:
 *******************************************************************************/
 inline subset::subset(const TValueMap & values)
     :
-    value_map(values)
+    value_map(values),
+    whole_block_count(0),
+    revision(0),
+    fingerprint(SOLUTION_CACHE_FINGERPRINT_START)
 {
     Initialize();
 }
@@ -226,7 +370,7 @@ inline void subset::GetBlockDefinition(TBlock & client_block)
 *******************************************************************************/
 inline void subset::GetWholeBlockVector(TBlockVector & client_block)
 {
-    client_block = whole_blocks;
+    client_block.assign(whole_block_count, whole_block);
 }
 
 /*******************************************************************************
@@ -238,7 +382,8 @@ inline void subset::GetWholeBlockVector(TBlockVector & client_block)
 *******************************************************************************/
 inline void subset::GetPartialBlockVector(TBlockVector & client_block)
 {
-    client_block = partial_blocks;
+    TCountDispenser empty_dispenser;
+    client_block = CalculatePartialBlocks(partial_dispenser, empty_dispenser);
 }
 
 /*******************************************************************************
@@ -250,64 +395,240 @@ inline void subset::GetPartialBlockVector(TBlockVector & client_block)
 *******************************************************************************/
 inline TSolution subset::LeastSolve(int target)
 {
-    // Return vector.
-    TSolution ret_vector;
+    // The modes of AnilaoSolve() are the other cache ids.
+    const int solver_id = -1;
+
+    TSolution ret_solution;
+    if(cache.Find(fingerprint, target, solver_id, ret_solution))
+    {
+        return ret_solution;
+    }
+
+    ret_solution = LeastSolveOnDispenser(target, master_dispenser);
+    cache.Insert(fingerprint, target, solver_id, ret_solution);
+
+    return ret_solution;
+}
+
+/*******************************************************************************
+
+    \brief  LeastSolve() into a caller's buffer.  The cache is not used, so
+            nothing is allocated once the buffer is big enough.
+
+    \param  int - The target number.
+    \param  TCompactSolution & - The values and counts used.  Empty if there
+                                 is no solution.
+
+*******************************************************************************/
+inline void subset::LeastSolve(int target, TCompactSolution & solution)
+{
+    LeastSolveOnDispenser(target, master_dispenser, solution);
+}
+
+/*******************************************************************************
+
+    \brief  Finds the fewest numbers that sum to the target without using more
+            of a value than its count.  Unlike LeastSolve() this finds a
+            solution for any value set whenever one exists.
+
+    \param  int - The target number.
+
+    \return TCountVector - How many of each value to use, in ascending value
+                           order.  Empty if there is no solution.
+
+*******************************************************************************/
+inline TCountVector subset::LeastCountSolve(int target)
+{
+    std::vector<int> denominations;
+    std::vector<int> counts;
+
+    for(TValueMap::iterator iter = value_map.begin() ;
+        iter != value_map.end() ;
+        ++iter)
+    {
+        denominations.push_back(iter->first);
+        counts.push_back(iter->second);
+    }
+
+    TCountVector ret_counts;
+
+    change_solver solver;
+    solver.Solve(denominations, counts, target, ret_counts);
+
+    return ret_counts;
+}
+
+/*******************************************************************************
+
+    \brief  Looks up one target of a SolveMany() batch.
+
+*******************************************************************************/
+class solve_many_task
+{
+public:
+
+    solve_many_task(const change_solver & solver,
+                    const std::vector<int> & targets,
+                    std::vector<TCountVector> & solutions)
+        :
+        solver(solver),
+        targets(targets),
+        solutions(solutions)
+    {}
+
+    void operator()(size_t index)
+    {
+        // Negative targets have no solution and are not in the table.
+        if(targets[index] < 0)
+        {
+            solutions[index].clear();
+        }
+        else
+        {
+            solver.Lookup(targets[index], solutions[index]);
+        }
+    }
+
+private:
+
+    const change_solver & solver;
+    const std::vector<int> & targets;
+    std::vector<TCountVector> & solutions;
+};
+
+/*******************************************************************************
+
+    \brief  Solves many targets against the same counts.  The table is built
+            once up to the largest target, then every target is read back from
+            it, spread across threads.
+
+    \param  const std::vector<int> & - The targets.
+    \param  std::vector<TCountVector> & - One LeastCountSolve() result per
+                                          target, in the same order.
+    \param  unsigned - Most threads to use, zero for the hardware count.
+
+*******************************************************************************/
+inline void subset::SolveMany(const std::vector<int> & targets,
+                              std::vector<TCountVector> & solutions,
+                              unsigned thread_count)
+{
+    solutions.resize(targets.size());
+
+    int largest = 0;
+    for(size_t i = 0 ; i < targets.size() ; ++i)
+    {
+        if(targets[i] > largest) largest = targets[i];
+    }
+
+    std::vector<int> denominations;
+    std::vector<int> counts;
+    for(size_t i = 0 ; i < master_dispenser.size() ; ++i)
+    {
+        denominations.push_back(master_dispenser[i].first);
+        counts.push_back(master_dispenser[i].second);
+    }
+
+    change_solver solver;
+    solver.Build(denominations, counts, largest);
+
+    // Reading one target back is short, only hand out larger batches.
+    solve_many_task task(solver, targets, solutions);
+    solver_threads::Run(targets.size(), task, thread_count, 256);
+}
+
+/*******************************************************************************
+
+    \brief
+
+    \note   C Anilao 02/03/2009 Created.
+
+*******************************************************************************/
+inline TSolution
+subset::LeastSolveOnDispenser(int target,
+                              const TCountDispenser & dispenser) const
+{
+    TCompactSolution compact;
+    LeastSolveOnDispenser(target, dispenser, compact);
+
+    // Expand the counts, smallest value first.
+    TSolution ret_solution;
+    for(size_t i = 0 ; i < compact.size() ; ++i)
+    {
+        ret_solution.insert(ret_solution.end(),
+                            compact[i].second,
+                            compact[i].first);
+    }
+
+    return ret_solution;
+}
+
+/*******************************************************************************
+
+    \brief  The greedy least number solve, written into a buffer.
+
+    \param  int - The target number.
+    \param  const TCountDispenser & - The numbers to solve with.
+    \param  TCompactSolution & - The values and counts used, smallest value
+                                 first.  Empty if there is no solution.
+
+    \return bool - True if a solution was found.
+
+*******************************************************************************/
+inline bool
+subset::LeastSolveOnDispenser(int target,
+                              const TCountDispenser & dispenser,
+                              TCompactSolution & solution) const
+{
+    solution.clear();
 
     // Record of how much we still need to fill.
     int running_total = target;
+    int total = 0;
 
-    // Go through all of the values in the value map.
-    for(TValueMap::reverse_iterator iter = value_map.rbegin() ;
-        iter != value_map.rend() ;
-        ++iter)
+    // Go through all of the values, largest first.
+    for(size_t i = dispenser.size() ; i-- > 0 ; )
     {
-        if(running_total >= iter->first)
+        const int value = dispenser[i].first;
+
+        // Values that have run out are not part of the dispenser.
+        if(dispenser[i].second <= 0) continue;
+
+        if(running_total >= value)
         {
             // Find out how many we want.
-            int desired_count = running_total / iter->first;
+            int desired_count = running_total / value;
 
             // Get as many as we can.
-            int retrieved_count =
-                desired_count > iter->second ? iter->second : desired_count;
+            int retrieved_count = desired_count > dispenser[i].second ?
+                                  dispenser[i].second : desired_count;
+
+            solution.push_back(TDenomination(value, retrieved_count));
+            total += retrieved_count * value;
 
             // Decrement the count because we found a value.
-            if((retrieved_count * iter->first) % running_total != 0)
+            if((retrieved_count * value) % running_total != 0)
             {
-                running_total -= (retrieved_count * iter->first) %
-                                 running_total;
+                running_total -= (retrieved_count * value) % running_total;
             }
             else
             {
-                // These numbers.
-                if(retrieved_count > 0)
-                {
-                    ret_vector.insert(ret_vector.begin(),
-                                      retrieved_count,
-                                      iter->first);
-                }
-
                 // We have our solution, lets get out.
                 break;
             }
-
-            // These numbers.
-            if(retrieved_count > 0)
-            {
-                ret_vector.insert(ret_vector.begin(),
-                                  retrieved_count,
-                                  iter->first);
-            }
         }
     }
 
     // If the total does not equal the target, cannot find a solution.
     // In this case we will return an empty.
-    if(accumulate(ret_vector.begin(), ret_vector.end(), 0) != target)
+    if(total != target)
     {
-        ret_vector.clear();
+        solution.clear();
+        return false;
     }
 
-    return ret_vector;
+    // Taken largest first, handed back smallest first.
+    std::reverse(solution.begin(), solution.end());
+    return true;
 }
 
 /*******************************************************************************
@@ -317,110 +638,428 @@ inline TSolution subset::LeastSolve(int target)
     \note   C Anilao 02/03/2009 Created.
 
 *******************************************************************************/
-inline TSolution  
-subset::LeastSolveOnDispenser(int target, const TDispenser & dispenser) const
+inline TSolution subset::AnilaoSolve(int target, TSolveMode mode)
 {
-    TValues values;
+    TSolution ret_val;
+    if(cache.Find(fingerprint, target, (int) mode, ret_val)) return ret_val;
 
-    // Use a set to get the unique value from the dispenser.
-    for(size_t i = 0 ; i < dispenser.size() ; ++i)
+    ret_val = AnilaoSolveUncached(target, mode);
+    cache.Insert(fingerprint, target, (int) mode, ret_val);
+
+    return ret_val;
+}
+
+/*******************************************************************************
+
+    \brief  AnilaoSolve() into a caller's buffer, without the cache.  The
+            partial blocks and the SOLVE_RECURSIVE whole block search work
+            in the buffer and the thread's solver_arena, so they do not
+            allocate once those have grown.  The other modes build their own
+            tables and do allocate.
+
+    \param  int - The target number.
+    \param  TCompactSolution & - The values and counts used.  Empty if there
+                                 is no solution.
+    \param  TSolveMode - How the whole block is searched.
+
+*******************************************************************************/
+inline void subset::AnilaoSolve(int target,
+                                TCompactSolution & solution,
+                                TSolveMode mode)
+{
+    // Check partials first.
+    LeastSolveOnDispenser(target, partial_dispenser, solution);
+    if(!solution.empty() || whole_block_count == 0) return;
+
+    if(mode != SOLVE_RECURSIVE)
+    {
+        TSolution expanded = AnilaoSolveUncached(target, mode);
+        std::sort(expanded.begin(), expanded.end());
+        for(size_t i = 0 ; i < expanded.size() ; ++i)
+        {
+            if(solution.empty() || solution.back().first != expanded[i])
+            {
+                solution.push_back(TDenomination(expanded[i], 0));
+            }
+            ++solution.back().second;
+        }
+        return;
+    }
+
+    // Same search as EnumerateWholeBlock(), in the thread's arena.
+    solver_arena & arena = solver_arena::ForThread();
+    arena.denominations.clear();
+    arena.counts.clear();
+    for(size_t i = 0 ; i < master_dispenser.size() ; ++i)
     {
-        values.insert(dispenser[i]);
+        arena.denominations.push_back(master_dispenser[i].first);
+        arena.counts.push_back(definition[i]);
     }
 
-    TValueMap value_map;
+    arena.enumerator.Reset(arena.denominations, arena.counts, target);
+    if(!arena.enumerator.Next(arena.solution_counts)) return;
 
-    // We have the unique values from the dispenser, count them and add to 
-    // value map.
-    for(TValues::iterator iter = values.begin() ; 
-        iter != values.end() ; 
-        ++iter)
+    const std::vector<int> & values = arena.enumerator.GetValues();
+    for(size_t i = 0 ; i < arena.solution_counts.size() ; ++i)
     {
-        ptrdiff_t val_count = count(dispenser.begin(), dispenser.end(), *iter);
-        value_map[*iter] = (int) val_count;
+        if(arena.solution_counts[i] > 0)
+        {
+            solution.push_back(
+                TDenomination(values[i], arena.solution_counts[i]));
+        }
     }
+}
 
-    // Create a subset class and use LeastSolve().
-	TSolution ret_solution;
-  
-	try
-	{ 
-		subset local(value_map);
-		ret_solution = local.LeastSolve(target); 
-	} 
-	catch(...) {}
+/*******************************************************************************
 
-    // Return the solution.
-    return ret_solution;
+    \brief  AnilaoSolve() without the cache.
+
+*******************************************************************************/
+inline TSolution subset::AnilaoSolveUncached(int target, TSolveMode mode)
+{
+    // Check partials first.
+    TSolution ret_val = LeastSolveOnDispenser(target, partial_dispenser);
+
+    // Use the partial solution if there was one.
+    if(!ret_val.empty() || whole_block_count == 0) return ret_val;
+
+    // We have to try the whole blocks.
+    if(mode == SOLVE_PARALLEL)
+    {
+        // Branch and bound without a budget always finishes.
+        bool optimal = true;
+        ret_val = AnilaoSolve(target, solve_budget(), optimal, mode);
+    }
+    else if(mode == SOLVE_MEET_IN_MIDDLE)
+    {
+        std::vector<int> denominations;
+        std::vector<int> counts;
+        for(size_t i = 0 ; i < master_dispenser.size() ; ++i)
+        {
+            denominations.push_back(master_dispenser[i].first);
+            counts.push_back(std::max(definition[i], 0));
+        }
+
+        meet_middle_solver solver;
+        TCountVector solution_counts;
+        solver.Solve(denominations, counts, target, solution_counts);
+
+        if(solver.GaveUp())
+        {
+            // Too many combinations to join, branch and bound on this
+            // thread still finishes with the fewest numbers.
+            bool optimal = true;
+            return AnilaoSolve(target,
+                               solve_budget(),
+                               optimal,
+                               SOLVE_RECURSIVE);
+        }
+
+        for(size_t i = 0 ; i < solution_counts.size() ; ++i)
+        {
+            ret_val.insert(ret_val.end(),
+                           solution_counts[i],
+                           denominations[i]);
+        }
+    }
+    else if(mode == SOLVE_BITSET)
+    {
+        // Reachability is linear in the block, no enumeration needed.
+        bitset_solver solver;
+        solver.Solve(whole_block, target, ret_val);
+    }
+    else
+    {
+        // Solutions are listed fewest numbers first, the first one is it.
+        solution_enumerator enumerator = EnumerateWholeBlock(target);
+        TCountVector counts;
+        if(enumerator.Next(counts)) enumerator.Expand(counts, ret_val);
+    }
+
+    return ret_val;
 }
 
 /*******************************************************************************
 
-    \brief
+    \brief  AnilaoSolve() with a budget.  The whole block is searched with
+            branch and bound, and the best solution found when the budget runs
+            out is returned.
 
-    \note   C Anilao 02/03/2009 Created.
+    \param  int - The target number.
+    \param  const solve_budget & - How long the whole block search may run.
+    \param  bool & - True if the search finished, the solution then has the
+                     fewest numbers.  Equal size solutions may be picked
+                     differently from the unbudgeted AnilaoSolve().
+    \param  TSolveMode - SOLVE_PARALLEL searches on every hardware thread,
+                         any other mode on the calling thread.
 
 *******************************************************************************/
-inline TSolution subset::AnilaoSolve(int target)
+inline TSolution subset::AnilaoSolve(int target,
+                                     const solve_budget & budget,
+                                     bool & optimal,
+                                     TSolveMode mode)
 {
-    // Return value.
-    TSolution ret_val;
+    optimal = true;
 
-    // Will hold the result.
-    TBlockVector result;
+    // Check partials first, the greedy is quick and needs no budget.
+    TSolution ret_val = LeastSolveOnDispenser(target, partial_dispenser);
 
-    // Recurse function needs a buffer, unused in this scope.
-    TSolution solution_buffer;
+    // Use the partial solution if there was one.
+    if(!ret_val.empty() || whole_block_count == 0) return ret_val;
 
-    // Check partials first. Use GetWholeBlockVector() to get partial dispenser.
-    TDispenser partial_dispenser;
-    CalculateWholeBlocks(master_dispenser, partial_dispenser);
-    TSolution least_solution = LeastSolveOnDispenser(target, partial_dispenser);
+    std::vector<int> denominations;
+    std::vector<int> counts;
+    for(size_t i = 0 ; i < master_dispenser.size() ; ++i)
+    {
+        denominations.push_back(master_dispenser[i].first);
+        counts.push_back(std::max(definition[i], 0));
+    }
 
-    // Add the solution to the result if there was one. 
-    if(!least_solution.empty()) result.push_back(least_solution);
+    TCountVector solution_counts;
+    if(mode == SOLVE_PARALLEL)
+    {
+        parallel_branch_bound solver;
+        solver.Solve(denominations,
+                     counts,
+                     target,
+                     budget,
+                     solution_counts,
+                     optimal);
+    }
+    else
+    {
+        branch_bound_solver solver;
+        solver.Solve(denominations,
+                     counts,
+                     target,
+                     budget,
+                     solution_counts,
+                     optimal);
+    }
 
-    if(result.size() == 0)
+    for(size_t i = 0 ; i < solution_counts.size() ; ++i)
     {
-        // We have to try the whole blocks.
-        if(whole_blocks.size() != 0)
-        {
-            // Allocate the results vector and run the algorithm.
-            SubsetRecurse(whole_blocks[0],
-                          result,
-                          target,
-                          solution_buffer,
-                          0,
-                          0);
-        }
+        ret_val.insert(ret_val.end(), solution_counts[i], denominations[i]);
+    }
+
+    return ret_val;
+}
+
+/*******************************************************************************
+
+    \brief  Depletes the values as evenly as possible as an explicit goal.
+            Of all the ways to make the target, takes the one where the
+            largest share of any value's count used is the lowest, then the
+            fewest numbers.
+
+    \param  int - The target number.
+
+    \return TCountVector - How many of each value to use, in ascending value
+                           order.  Empty if there is no solution.
+
+*******************************************************************************/
+inline TCountVector subset::EvenSolve(int target)
+{
+    std::vector<int> denominations;
+    std::vector<int> counts;
+    for(size_t i = 0 ; i < master_dispenser.size() ; ++i)
+    {
+        denominations.push_back(master_dispenser[i].first);
+        counts.push_back(master_dispenser[i].second);
+    }
+
+    TCountVector ret_counts;
+
+    even_depletion_solver solver;
+    solver.Solve(denominations, counts, target, ret_counts);
+
+    return ret_counts;
+}
+
+/*******************************************************************************
+
+    \brief  Lists the solutions that fit in one whole block, fewest numbers
+            first, one at a time.  Stop after the first, or the k best,
+            without listing the rest.
+
+    \param  int - The target number.
+
+    \return solution_enumerator - Call Next() for each solution.
+
+*******************************************************************************/
+inline solution_enumerator subset::EnumerateWholeBlock(int target) const
+{
+    std::vector<int> denominations;
+    std::vector<int> counts;
+
+    for(size_t i = 0 ; i < master_dispenser.size() ; ++i)
+    {
+        denominations.push_back(master_dispenser[i].first);
+        counts.push_back(whole_block_count > 0 ? definition[i] : 0);
+    }
+
+    return solution_enumerator(denominations, counts, target);
+}
+
+/*******************************************************************************
+
+    \brief  Takes the numbers of a solution out of the counts.  Only the block
+            counts are recalculated unless a value runs out.
+
+    \param  const TSolution & - The numbers that were dispensed.
+
+    \note   Throws if the solution uses more of a value than there is, the
+            counts are then left unchanged.
+
+*******************************************************************************/
+inline void subset::Withdraw(const TSolution & solution)
+{
+    // Tally the solution by value.
+    TValueMap withdrawn;
+    for(size_t i = 0 ; i < solution.size() ; ++i)
+    {
+        ++withdrawn[solution[i]];
     }
 
-    if(result.size() > 0)
+    // Check everything before changing anything.
+    for(TValueMap::iterator iter = withdrawn.begin() ;
+        iter != withdrawn.end() ;
+        ++iter)
     {
-        // Find the result with the largest size.
-        std::map<size_t, size_t> sizes;
-        for(size_t i = 0 ; i < result.size() ; ++i)
+        TValueMap::iterator found = value_map.find(iter->first);
+        if(found == value_map.end() || found->second < iter->second)
         {
-            sizes[i] = result[i].size();
+            throw std::exception();
         }
+    }
 
-        // Find the smallest and use it.
-        std::map<size_t, size_t>::iterator smallest_iter = sizes.begin();
-        for(std::map<size_t, size_t>::iterator iter = sizes.begin() ;
-            iter != sizes.end() ;
-            ++iter)
+    bool values_changed = false;
+    for(TValueMap::iterator iter = withdrawn.begin() ;
+        iter != withdrawn.end() ;
+        ++iter)
+    {
+        TCountDispenser::iterator entry = FindDenomination(iter->first);
+        entry->second -= iter->second;
+        value_map[iter->first] = entry->second;
+
+        // A value that runs out leaves the set.
+        if(entry->second == 0)
         {
-            if(iter->second < smallest_iter->second)
-            {
-                smallest_iter = iter;
-            }
+            master_dispenser.erase(entry);
+            value_map.erase(iter->first);
+            values.erase(iter->first);
+            values_changed = true;
         }
+    }
 
-        // We have found the largest.
-        ret_val = result[smallest_iter->first];
+    if(!withdrawn.empty()) Refresh(values_changed);
+}
+
+/*******************************************************************************
+
+    \brief  Adds numbers of one value to the counts.  Only the block counts
+            are recalculated unless the value is new.
+
+    \param  int - The value, must be positive.
+    \param  int - How many were added, must be positive.
+
+*******************************************************************************/
+inline void subset::Deposit(int value, int count)
+{
+    if(value <= 0 || count <= 0) throw std::exception();
+
+    TCountDispenser::iterator entry = FindDenomination(value);
+    const bool values_changed = entry == master_dispenser.end();
+
+    if(values_changed)
+    {
+        // Keep the dispenser in ascending value order.
+        master_dispenser.insert(std::lower_bound(master_dispenser.begin(),
+                                                 master_dispenser.end(),
+                                                 TDenomination(value, 0)),
+                                TDenomination(value, count));
+        values.insert(value);
+        value_map[value] = count;
+    }
+    else
+    {
+        entry->second += count;
+        value_map[value] = entry->second;
     }
 
-    return ret_val;
+    Refresh(values_changed);
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline void subset::GetValueMap(TValueMap & client_map)
+{
+    client_map = value_map;
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline unsigned long subset::GetRevision() const
+{
+    return revision;
+}
+
+/*******************************************************************************
+
+    \brief  Caches up to capacity results.  Entries are keyed on the counts,
+            so Withdraw() and Deposit() never leave a stale answer behind.
+
+    \param  size_t - Most results to keep, zero turns the cache off.
+
+*******************************************************************************/
+inline void subset::SetCacheCapacity(size_t capacity)
+{
+    cache.SetCapacity(capacity);
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline unsigned long long subset::GetCacheHits() const
+{
+    return cache.GetHits();
+}
+
+/*******************************************************************************
+
+    \brief
+
+*******************************************************************************/
+inline unsigned long long subset::GetCacheMisses() const
+{
+    return cache.GetMisses();
+}
+
+/*******************************************************************************
+
+    \brief  Finds the dispenser entry of a value.
+
+    \return TCountDispenser::iterator - The entry, end() if there is none.
+
+*******************************************************************************/
+inline TCountDispenser::iterator subset::FindDenomination(int value)
+{
+    TCountDispenser::iterator entry =
+        std::lower_bound(master_dispenser.begin(),
+                         master_dispenser.end(),
+                         TDenomination(value, 0));
+
+    if(entry != master_dispenser.end() && entry->first == value) return entry;
+
+    return master_dispenser.end();
 }
 
 /*******************************************************************************
@@ -468,21 +1107,74 @@ inline void subset::Initialize()
         values.insert(iter->first);
 
         // Fill up the master dispenser.
-        master_dispenser.insert(master_dispenser.end(),
-                                iter->second,
-                                iter->first);
+        master_dispenser.push_back(TDenomination(iter->first, iter->second));
     }
 
-    // Calculate our new definition.
-    definition = CalculateDefinition(range_low, range_high);
+    // Calculate the definition and the blocks.
+    Refresh(true);
+}
 
-    // Calcluate our whole blocks.
-    TDispenser left_over;
-    whole_blocks = CalculateWholeBlocks(master_dispenser, left_over);
+/*******************************************************************************
 
-    // Must calculate the partial blocks.
-    TDispenser empty_dispenser;
-    partial_blocks = CalculatePartialBlocks(left_over, empty_dispenser);
+    \brief  Recalculates what depends on the counts.  The definition only
+            depends on which values there are, so it is only recalculated when
+            a value was added or ran out.
+
+    \param  bool - True if the set of values changed.
+
+*******************************************************************************/
+inline void subset::Refresh(bool values_changed)
+{
+    if(values_changed)
+    {
+        if(values.empty())
+        {
+            // Nothing left to dispense.
+            definition.clear();
+            range_low = 0;
+            range_high = 0;
+        }
+        else
+        {
+            // Calculate our new definition.
+            definition = CalculateDefinition(range_low, range_high);
+        }
+
+        // Every whole block holds exactly the definition.
+        whole_block.clear();
+        for(size_t i = 0 ; i < master_dispenser.size() ; ++i)
+        {
+            whole_block.insert(whole_block.end(),
+                               std::max(definition[i], 0),
+                               master_dispenser[i].first);
+        }
+    }
+
+    // Calcluate our whole blocks, the partial blocks are made from the rest
+    // when they are asked for.
+    if(master_dispenser.empty())
+    {
+        whole_block_count = 0;
+        partial_dispenser.clear();
+    }
+    else
+    {
+        whole_block_count = CalculateWholeBlocks(master_dispenser,
+                                                 partial_dispenser);
+    }
+
+    // Anything cached against the old counts is now stale.
+    ++revision;
+
+    // New counts, new cache keys.
+    fingerprint = SOLUTION_CACHE_FINGERPRINT_START;
+    for(size_t i = 0 ; i < master_dispenser.size() ; ++i)
+    {
+        fingerprint = solution_cache::Fingerprint(fingerprint,
+                                                  master_dispenser[i].first);
+        fingerprint = solution_cache::Fingerprint(fingerprint,
+                                                  master_dispenser[i].second);
+    }
 }
 
 /*******************************************************************************
@@ -493,8 +1185,8 @@ inline void subset::Initialize()
 
 *******************************************************************************/
 inline TBlockVector
-subset::CalculatePartialBlocks(const TDispenser & original_dispenser,
-                               TDispenser & left_over)
+subset::CalculatePartialBlocks(const TCountDispenser & original_dispenser,
+                               TCountDispenser & left_over) const
 {
     // Make a copy of the dispenser.
     left_over = original_dispenser;
@@ -502,46 +1194,24 @@ subset::CalculatePartialBlocks(const TDispenser & original_dispenser,
     TBlockVector retVal;
 
     // If we don't match by now, something is wrong.
-    if(definition.size() != value_map.size()) throw std::exception();
-
-    int index = 0;
-    TValueMap::iterator highest = value_map.begin();
+    if(definition.size() != left_over.size()) throw std::exception();
 
-    // Get the highest weighed count.
-    for(TValueMap::iterator iter = value_map.begin() ;
-        iter != value_map.end() ;
-        ++iter, ++index)
-    {
-        // If this count is higher, then we have a new winner.
-        if(iter->second > highest->second)
-        {
-            highest = iter;
-        }
-    }
-
-    // For each of the highest count, do best to make a full set.
-    for(int i = 0 ; i < highest->second ; ++i)
+    // Each block takes up to the definition of every value, until nothing
+    // the definition asks for is left.
+    bool remaining = true;
+    while(remaining)
     {
         TBlock new_block;
-        TValues::iterator iter = values.begin();
-        for(size_t j = 0 ; j < values.size() ; ++j)
+        remaining = false;
+        for(size_t j = 0 ; j < left_over.size() ; ++j)
         {
-            // Remove all of the values.
-            for(int k = 0 ; k < definition[j] ; ++k)
-            {
-                // Remove all of the values.
-                TDispenser::iterator value_iter = find(left_over.begin(),
-                                                       left_over.end(),
-                                                       *iter);
-
-                if(value_iter != left_over.end())
-                {
-                    new_block.push_back(*value_iter);
-                    left_over.erase(value_iter);
-                }
-            }
+            if(definition[j] <= 0) continue;
+
+            int taken = std::min(definition[j], left_over[j].second);
+            new_block.insert(new_block.end(), taken, left_over[j].first);
+            left_over[j].second -= taken;
 
-            ++iter;
+            if(left_over[j].second > 0) remaining = true;
         }
 
         if(new_block.size() != 0) retVal.push_back(new_block);
@@ -557,67 +1227,36 @@ subset::CalculatePartialBlocks(const TDispenser & original_dispenser,
     \note   C Anilao 02/03/2009 Created.
 
 *******************************************************************************/
-inline TBlockVector
-subset::CalculateWholeBlocks(const TDispenser & original_dispenser,
-                             TDispenser & left_over)
+inline int
+subset::CalculateWholeBlocks(const TCountDispenser & original_dispenser,
+                             TCountDispenser & left_over) const
 {
     // Make a copy of the dispenser.
     left_over = original_dispenser;
 
-    TBlockVector retVal;
-
     // If we don't match by now, something is wrong.
-    if(definition.size() != value_map.size()) throw std::exception();
-
-    int index = 0;
-    TValueMap::iterator lowest = value_map.begin();
-    int lowest_divisor = definition[0];
-
-    // Get the lowest weighed count.
-    for(TValueMap::iterator iter = value_map.begin() ;
-        iter != value_map.end() ;
-        ++iter, ++index)
+    if(definition.size() != left_over.size() || left_over.empty())
     {
-        // Calculate our current weight.
-        int weight = iter->second / definition[index];
-
-        // If this weight is lower, then we have a new winner.
-        if(weight < (lowest->second / lowest_divisor))
-        {
-            lowest = iter;
-            lowest_divisor = definition[index];
-        }
+        throw std::exception();
     }
 
-    // Remove all of these number from the left_over dispenser.
-    for(int i = 0 ; i < lowest->second / lowest_divisor ; ++i)
+    // The value with the lowest weighed count limits the block count.
+    int block_count = left_over[0].second / definition[0];
+    for(size_t j = 1 ; j < left_over.size() ; ++j)
     {
-        TBlock new_block;
-        TValues::iterator iter = values.begin();
-        for(size_t j = 0 ; j < values.size() ; ++j)
-        {
-            // Remove all of the values.
-            for(int k = 0 ; k < definition[j] ; ++k)
-            {
-                // Remove all of the values.
-                TDispenser::iterator value_iter = find(left_over.begin(),
-                                                       left_over.end(),
-                                                       *iter);
-
-                if(value_iter != left_over.end())
-                {
-                    new_block.push_back(*value_iter);
-                    left_over.erase(value_iter);
-                }
-            }
+        block_count = std::min(block_count,
+                               left_over[j].second / definition[j]);
+    }
 
-            ++iter;
-        }
+    if(block_count <= 0) return 0;
 
-        retVal.push_back(new_block);
+    // Remove all of these numbers from the left_over dispenser.
+    for(size_t j = 0 ; j < left_over.size() ; ++j)
+    {
+        left_over[j].second -= block_count * definition[j];
     }
 
-    return retVal;
+    return block_count;
 }
 
 /*******************************************************************************
@@ -694,46 +1333,6 @@ subset::CalculateDefinition(int & low, int & high)
 
     return local_definition;
 }
-
-/*******************************************************************************
-
-    \brief
-
-    \note   C Anilao 02/03/2009 Created.
-
-*******************************************************************************/
-inline void subset::SubsetRecurse(TBlock numbers,
-                                  TBlockVector & result,
-                                  int target,
-                                  TSolution & output,
-                                  int index,
-                                  int sum)
-{
-    if (index == numbers.size())
-    {
-        if(accumulate(output.begin(),
-                      output.end(),
-                      (int) 0) == target)
-        {
-            std::vector<std::vector<int> >::iterator
-            iter = find(result.begin(), result.end(), output);
-
-            if(iter == result.end()) result.push_back(output);
-        }
-
-        return;
-    }
-
-    // Include numbers[index]
-    TSolution p1 = output;
-    p1.push_back(numbers[index]);
-
-    SubsetRecurse(numbers, result, target, p1, index + 1, sum +
-                  numbers[index]);
-
-    // Exclude numbers[index]
-    SubsetRecurse(numbers, result, target, output, index + 1, sum);
-}
 }
 
 #endif
@@ -0,0 +1,656 @@
+/*******************************************************************************
+
+    \file   subsetbench.h
+
+    \brief  Executes a latency and scaling benchmark on the subset solvers.
+
+            Each case of a corpus is a value map and a list of targets.  The
+            generated corpora cover canonical coin sets, non-canonical sets
+            where greedy is wrong, large counts and adversarial sets whose
+            targets are barely reachable or not at all.  Recorded corpora are
+            read from text, one case per line:
+
+                name value:count,value:count,...;target,target,...
+
+            Block construction, LeastSolve(), LeastCountSolve(), EvenSolve()
+            and AnilaoSolve() in every TSolveMode are timed one target at a
+            time, and the latencies are reported as percentiles.  A scaling
+            pass grows the total count and the number of distinct values.
+            The results are written as JSON.
+
+            SOLVE_RECURSIVE lists whole block subsets and is skipped when the
+            block holds more than SUBSETBENCH_MAX_RECURSIVE_BLOCK numbers.
+            A mode that throws is reported as skipped.  SOLVE_MEET_IN_MIDDLE
+            on a block too large to split times its branch and bound
+            fallback instead.
+
+            Heap allocations are only counted when
+            SUBSETBENCH_COUNT_ALLOCATIONS is defined before this header is
+            included, in exactly one translation unit, see
+            allocation_counter.h.  Otherwise allocations are reported as
+            null.
+
+*******************************************************************************/
+
+#ifndef SUBSETBENCH_H
+#define SUBSETBENCH_H
+
+// Standard Library Dependancies.
+#include <ctime>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <algorithm>
+
+#ifdef _WIN32
+   #include <windows.h>
+#endif
+
+// General Dependancies.
+#include "../../numeric.h"
+#include "../allocation_counter.h"
+
+// Largest whole block SOLVE_RECURSIVE is timed on.
+#define SUBSETBENCH_MAX_RECURSIVE_BLOCK 24
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \brief  Number of heap allocations made since the program started.
+
+*******************************************************************************/
+inline unsigned long long SubsetBenchAllocationCount()
+{
+    return BenchAllocationCount();
+}
+
+/*******************************************************************************
+
+    \brief  True when the global operator new is counting allocations.
+
+*******************************************************************************/
+inline bool SubsetBenchCountsAllocations()
+{
+    return BenchCountsAllocations();
+}
+
+/*******************************************************************************
+
+    \brief  Current monotonic time in nanoseconds.
+
+*******************************************************************************/
+inline double SubsetBenchNow()
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double) counter.QuadPart * 1e9 / (double) frequency.QuadPart;
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec * 1e9 + (double) now.tv_nsec;
+#endif
+}
+
+/*******************************************************************************
+
+    \brief  One inventory and the targets to solve against it.
+
+*******************************************************************************/
+struct CSubsetBenchCase
+{
+    std::string corpus;
+    std::string name;
+    TValueMap values;
+    std::vector<int> targets;
+};
+
+/*******************************************************************************
+
+    \class  CSubsetBenchReport
+
+    \brief  Collects latency samples and writes them as JSON.
+
+*******************************************************************************/
+class CSubsetBenchReport
+{
+public:
+
+    // Constructor.
+    CSubsetBenchReport() : sink(0) {}
+
+    // Starts a series of timed samples.
+    void Begin()
+    {
+        samples.clear();
+        allocationsAtStart = SubsetBenchAllocationCount();
+    }
+
+    // Starts one sample.
+    void Start()
+    {
+        startTime = SubsetBenchNow();
+    }
+
+    // Ends one sample.
+    void Stop()
+    {
+        samples.push_back(SubsetBenchNow() - startTime);
+    }
+
+    // Ends the series and records it.
+    void End(const CSubsetBenchCase & benchCase,
+             const std::string & operation,
+             unsigned long items,
+             unsigned long distinct)
+    {
+        Record record;
+        record.corpus = benchCase.corpus;
+        record.name = benchCase.name;
+        record.operation = operation;
+        record.items = items;
+        record.distinct = distinct;
+        record.skipped = false;
+        record.allocations = SubsetBenchAllocationCount() - allocationsAtStart;
+        record.samples = samples;
+        std::sort(record.samples.begin(), record.samples.end());
+        records.push_back(record);
+    }
+
+    // Records an operation that could not be run on a case.
+    void Skip(const CSubsetBenchCase & benchCase,
+              const std::string & operation,
+              unsigned long items,
+              unsigned long distinct)
+    {
+        samples.clear();
+        End(benchCase, operation, items, distinct);
+        records.back().skipped = true;
+    }
+
+    // Keeps results alive so the compiler cannot remove the timed work.
+    void Consume(size_t value)
+    {
+        sink += value;
+    }
+
+    // Writes all of the records as a JSON document.
+    void Write(std::ostream & out) const
+    {
+        out << "{\n  \"count_allocations\": "
+            << (SubsetBenchCountsAllocations() ? "true" : "false")
+            << ",\n  \"results\": [";
+
+        for(size_t i = 0 ; i < records.size() ; ++i)
+        {
+            const Record & record = records[i];
+
+            out << (i == 0 ? "\n" : ",\n")
+                << "    {\"corpus\": \"" << record.corpus
+                << "\", \"case\": \"" << record.name
+                << "\", \"op\": \"" << record.operation
+                << "\", \"items\": " << record.items
+                << ", \"distinct\": " << record.distinct;
+
+            if(record.skipped)
+            {
+                out << ", \"skipped\": true}";
+                continue;
+            }
+
+            out << ", \"samples\": " << record.samples.size()
+                << ", \"p50_ns\": " << Percentile(record.samples, 0.50)
+                << ", \"p90_ns\": " << Percentile(record.samples, 0.90)
+                << ", \"p99_ns\": " << Percentile(record.samples, 0.99)
+                << ", \"max_ns\": " << Percentile(record.samples, 1.00)
+                << ", \"allocs_per_op\": ";
+
+            if(SubsetBenchCountsAllocations() && !record.samples.empty())
+            {
+                out << (double) record.allocations /
+                       (double) record.samples.size();
+            }
+            else
+            {
+                out << "null";
+            }
+
+            out << "}";
+        }
+
+        out << "\n  ]\n}\n";
+    }
+
+private:
+
+    // One timed series.
+    struct Record
+    {
+        std::string corpus;
+        std::string name;
+        std::string operation;
+        unsigned long items;
+        unsigned long distinct;
+        bool skipped;
+        unsigned long long allocations;
+        std::vector<double> samples;
+    };
+
+    // Nearest rank percentile of sorted samples.
+    static double Percentile(const std::vector<double> & sorted,
+                             double fraction)
+    {
+        if(sorted.empty()) return 0.0;
+
+        size_t rank = (size_t) (fraction * (double) sorted.size() + 0.5);
+        if(rank == 0) rank = 1;
+        if(rank > sorted.size()) rank = sorted.size();
+
+        return sorted[rank - 1];
+    }
+
+    // Samples of the current series, in nanoseconds.
+    std::vector<double> samples;
+
+    // Start of the current sample.
+    double startTime;
+
+    // Allocation count when the current series started.
+    unsigned long long allocationsAtStart;
+
+    // All of the recorded series.
+    std::vector<Record> records;
+
+    // Result sink, volatile so the optimizer keeps the timed loops.
+    volatile size_t sink;
+};
+
+/*******************************************************************************
+
+    \brief  Small deterministic generator so every run uses the same corpora.
+
+*******************************************************************************/
+inline unsigned long SubsetBenchRandom(unsigned long & state)
+{
+    state = state * 1103515245ul + 12345ul;
+    return (state >> 16) & 0x7FFFul;
+}
+
+/*******************************************************************************
+
+    \brief  Adds a generated case with targets spread over the total.
+
+*******************************************************************************/
+inline void SubsetBenchAddCase(std::vector<CSubsetBenchCase> & corpus,
+                               const std::string & corpusName,
+                               const std::string & name,
+                               const TValueMap & values,
+                               unsigned long targetCount,
+                               unsigned long seed)
+{
+    CSubsetBenchCase benchCase;
+    benchCase.corpus = corpusName;
+    benchCase.name = name;
+    benchCase.values = values;
+
+    long long total = 0;
+    for(TValueMap::const_iterator iter = values.begin() ;
+        iter != values.end() ;
+        ++iter)
+    {
+        total += (long long) iter->first * iter->second;
+    }
+
+    // Squaring the draw makes most targets small, like real requests.
+    const long long cap = std::min(total, 100000LL);
+    for(unsigned long i = 0 ; i < targetCount && cap > 0 ; ++i)
+    {
+        const long long draw = (long long) SubsetBenchRandom(seed);
+        benchCase.targets.push_back(
+            1 + (int) (draw * draw / 32767 * (cap - 1) / 32767));
+    }
+
+    corpus.push_back(benchCase);
+}
+
+/*******************************************************************************
+
+    \brief  Builds the generated corpora.
+
+*******************************************************************************/
+inline void SubsetBenchGenerateCorpora(std::vector<CSubsetBenchCase> & corpus,
+                                       unsigned long targetCount)
+{
+    TValueMap values;
+
+    /*** Canonical coin sets, greedy is optimal ***/
+    values.clear();
+    values[1] = 40; values[5] = 20; values[10] = 20; values[25] = 16;
+    SubsetBenchAddCase(corpus, "canonical", "us_coins", values,
+                       targetCount, 1);
+
+    values.clear();
+    values[1] = 20; values[2] = 20; values[5] = 20; values[10] = 20;
+    values[20] = 20; values[50] = 20; values[100] = 10; values[200] = 10;
+    SubsetBenchAddCase(corpus, "canonical", "euro_coins", values,
+                       targetCount, 2);
+
+    /*** Non-canonical sets, greedy is wrong ***/
+    values.clear();
+    values[1] = 10; values[3] = 10; values[4] = 10;
+    SubsetBenchAddCase(corpus, "non_canonical", "one_three_four", values,
+                       targetCount, 3);
+
+    values.clear();
+    values[7] = 12; values[11] = 9; values[13] = 8; values[29] = 5;
+    values[31] = 5;
+    SubsetBenchAddCase(corpus, "non_canonical", "primes", values,
+                       targetCount, 4);
+
+    /*** Large counts ***/
+    values.clear();
+    values[1] = 5000; values[5] = 5000; values[20] = 5000; values[100] = 2000;
+    SubsetBenchAddCase(corpus, "large_counts", "atm", values,
+                       targetCount, 5);
+
+    /*** Adversarial, close large values with few reachable sums ***/
+    values.clear();
+    for(int value = 1000 ; value < 1010 ; ++value) values[value] = 3;
+    SubsetBenchAddCase(corpus, "adversarial", "close_values", values,
+                       targetCount, 6);
+
+    values.clear();
+    values[6] = 50; values[10] = 50; values[15] = 50;
+    SubsetBenchAddCase(corpus, "adversarial", "frobenius", values,
+                       targetCount, 7);
+
+    values.clear();
+    for(int bit = 0 ; bit < 12 ; ++bit) values[(1 << bit) + 1] = 1;
+    SubsetBenchAddCase(corpus, "adversarial", "powers_plus_one", values,
+                       targetCount, 8);
+}
+
+/*******************************************************************************
+
+    \brief  Reads a recorded corpus, one case per line.  Blank lines and
+            lines starting with # are ignored.
+
+    \return bool - False if a line could not be read.
+
+*******************************************************************************/
+inline bool SubsetBenchLoadCorpus(std::istream & in,
+                                  const std::string & corpusName,
+                                  std::vector<CSubsetBenchCase> & corpus)
+{
+    std::string line;
+    while(std::getline(in, line))
+    {
+        if(!line.empty() && line[line.size() - 1] == '\r')
+        {
+            line.erase(line.size() - 1);
+        }
+        if(line.empty() || line[0] == '#') continue;
+
+        CSubsetBenchCase benchCase;
+        benchCase.corpus = corpusName;
+
+        std::istringstream fields(line);
+        std::string values;
+        std::string targets;
+        if(!(fields >> benchCase.name >> values)) return false;
+
+        const size_t split = values.find(';');
+        if(split == std::string::npos) return false;
+        targets = values.substr(split + 1);
+        values.erase(split);
+
+        std::replace(values.begin(), values.end(), ',', ' ');
+        std::replace(values.begin(), values.end(), ':', ' ');
+        std::replace(targets.begin(), targets.end(), ',', ' ');
+
+        std::istringstream valueStream(values);
+        int value, count;
+        while(valueStream >> value >> count) benchCase.values[value] = count;
+        if(!valueStream.eof()) return false;
+
+        std::istringstream targetStream(targets);
+        int target;
+        while(targetStream >> target) benchCase.targets.push_back(target);
+        if(!targetStream.eof()) return false;
+
+        corpus.push_back(benchCase);
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+
+    \brief  Total count and number of distinct values of a case.
+
+*******************************************************************************/
+inline void SubsetBenchSize(const TValueMap & values,
+                            unsigned long & items,
+                            unsigned long & distinct)
+{
+    items = 0;
+    distinct = 0;
+    for(TValueMap::const_iterator iter = values.begin() ;
+        iter != values.end() ;
+        ++iter)
+    {
+        if(iter->second <= 0) continue;
+        items += iter->second;
+        ++distinct;
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Times one AnilaoSolve() mode over the targets of a case.
+
+*******************************************************************************/
+inline void SubsetBenchAnilao(CSubsetBenchReport & report,
+                              const CSubsetBenchCase & benchCase,
+                              subset & solver,
+                              TSolveMode mode,
+                              const std::string & operation,
+                              unsigned long items,
+                              unsigned long distinct)
+{
+    report.Begin();
+    try
+    {
+        for(size_t i = 0 ; i < benchCase.targets.size() ; ++i)
+        {
+            report.Start();
+            TSolution solution = solver.AnilaoSolve(benchCase.targets[i],
+                                                    mode);
+            report.Stop();
+            report.Consume(solution.size());
+        }
+    }
+    catch(...)
+    {
+        report.Skip(benchCase, operation, items, distinct);
+        return;
+    }
+
+    report.End(benchCase, operation, items, distinct);
+}
+
+/*******************************************************************************
+
+    \brief  Times every solver on one case.
+
+*******************************************************************************/
+inline void SubsetBenchRunCase(CSubsetBenchReport & report,
+                               const CSubsetBenchCase & benchCase,
+                               bool allModes)
+{
+    unsigned long items, distinct;
+    SubsetBenchSize(benchCase.values, items, distinct);
+
+    /*** Block construction ***/
+    report.Begin();
+    report.Start();
+    subset solver(benchCase.values);
+    report.Stop();
+    report.End(benchCase, "construct", items, distinct);
+
+    size_t i;
+
+    /*** LeastSolve ***/
+    report.Begin();
+    for(i = 0 ; i < benchCase.targets.size() ; ++i)
+    {
+        report.Start();
+        TSolution solution = solver.LeastSolve(benchCase.targets[i]);
+        report.Stop();
+        report.Consume(solution.size());
+    }
+    report.End(benchCase, "least_solve", items, distinct);
+
+    /*** LeastCountSolve ***/
+    report.Begin();
+    for(i = 0 ; i < benchCase.targets.size() ; ++i)
+    {
+        report.Start();
+        TCountVector counts = solver.LeastCountSolve(benchCase.targets[i]);
+        report.Stop();
+        report.Consume(counts.size());
+    }
+    report.End(benchCase, "least_count_solve", items, distinct);
+
+    /*** AnilaoSolve ***/
+    SubsetBenchAnilao(report, benchCase, solver, SOLVE_BITSET,
+                      "anilao_bitset", items, distinct);
+
+    if(!allModes) return;
+
+    // Every whole block is the same, only one is searched.
+    TBlockVector wholeBlocks;
+    solver.GetWholeBlockVector(wholeBlocks);
+    const size_t blockSize = wholeBlocks.empty() ? 0 : wholeBlocks[0].size();
+
+    if(blockSize <= SUBSETBENCH_MAX_RECURSIVE_BLOCK)
+    {
+        SubsetBenchAnilao(report, benchCase, solver, SOLVE_RECURSIVE,
+                          "anilao_recursive", items, distinct);
+    }
+    else
+    {
+        report.Skip(benchCase, "anilao_recursive", items, distinct);
+    }
+
+    SubsetBenchAnilao(report, benchCase, solver, SOLVE_PARALLEL,
+                      "anilao_parallel", items, distinct);
+    SubsetBenchAnilao(report, benchCase, solver, SOLVE_MEET_IN_MIDDLE,
+                      "anilao_meet_in_middle", items, distinct);
+
+    /*** EvenSolve ***/
+    report.Begin();
+    for(i = 0 ; i < benchCase.targets.size() ; ++i)
+    {
+        report.Start();
+        TCountVector counts = solver.EvenSolve(benchCase.targets[i]);
+        report.Stop();
+        report.Consume(counts.size());
+    }
+    report.End(benchCase, "even_solve", items, distinct);
+}
+
+/*******************************************************************************
+
+    \brief  Grows the total count, then the number of distinct values.
+
+*******************************************************************************/
+inline void SubsetBenchRunScaling(CSubsetBenchReport & report,
+                                  unsigned long targetCount,
+                                  unsigned long maxItems)
+{
+    std::vector<CSubsetBenchCase> corpus;
+    TValueMap values;
+
+    /*** Total count, four values ***/
+    for(unsigned long items = 100 ; items <= maxItems ; items *= 10)
+    {
+        const int count = (int) (items / 4);
+        values.clear();
+        values[1] = count; values[5] = count;
+        values[10] = count; values[25] = count;
+
+        std::ostringstream name;
+        name << "items_" << items;
+        SubsetBenchAddCase(corpus, "scaling_items", name.str(), values,
+                           targetCount, items);
+    }
+
+    /*** Distinct values, ten of each ***/
+    for(int distinct = 4 ; distinct <= 256 ; distinct *= 4)
+    {
+        values.clear();
+        for(int value = 0 ; value < distinct ; ++value)
+        {
+            values[3 + value * 7] = 10;
+        }
+
+        std::ostringstream name;
+        name << "distinct_" << distinct;
+        SubsetBenchAddCase(corpus, "scaling_distinct", name.str(), values,
+                           targetCount, distinct);
+    }
+
+    // Only the modes that do not blow up with the block are scaled.
+    for(size_t i = 0 ; i < corpus.size() ; ++i)
+    {
+        SubsetBenchRunCase(report, corpus[i], false);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  ExecuteSubsetBenchmark
+
+    \param  std::ostream & - Stream the JSON results are written to.
+    \param  const std::vector<CSubsetBenchCase> & - Recorded cases to run
+                                                    along with the generated
+                                                    ones.
+    \param  unsigned long - Number of targets per generated case.
+    \param  unsigned long - Largest total count for the scaling pass, zero
+                            skips the scaling pass.
+
+*******************************************************************************/
+inline void ExecuteSubsetBenchmark(
+    std::ostream & out,
+    const std::vector<CSubsetBenchCase> & recorded =
+        std::vector<CSubsetBenchCase>(),
+    unsigned long targetCount = 200,
+    unsigned long scalingItems = 100000)
+{
+    CSubsetBenchReport report;
+
+    std::vector<CSubsetBenchCase> corpus;
+    SubsetBenchGenerateCorpora(corpus, targetCount);
+    corpus.insert(corpus.end(), recorded.begin(), recorded.end());
+
+    for(size_t i = 0 ; i < corpus.size() ; ++i)
+    {
+        SubsetBenchRunCase(report, corpus[i], true);
+    }
+
+    if(scalingItems != 0)
+    {
+        SubsetBenchRunScaling(report, targetCount, scalingItems);
+    }
+
+    report.Write(out);
+}
+}
+
+#endif
@@ -0,0 +1,1559 @@
+/*******************************************************************************
+
+    \file   subsettest.h
+
+    \brief  Executes a test on the subset solvers.
+
+            Small value maps are generated and every target is solved by
+            brute force, listing each way to use the counts, so the fewest
+            numbers and the lowest drawdown are known exactly.  The solvers
+            are checked against that, and every solution is checked to sum to
+            its target within the counts.
+
+*******************************************************************************/
+
+#ifndef SUBSETTEST_H
+#define SUBSETTEST_H
+
+// Standard Library Dependancies.
+#include <set>
+#include <cstdio>
+#include <vector>
+#include <cassert>
+#include <climits>
+
+#ifndef _WIN32
+   #include <unistd.h>
+   #include <sys/resource.h>
+#endif
+
+// General Dependancies.
+#include "../../numeric.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \brief  Small deterministic generator so every run tests the same maps.
+
+*******************************************************************************/
+inline unsigned long SubsetTestRandom(unsigned long & state)
+{
+    state = state * 1103515245ul + 12345ul;
+    return (state >> 16) & 0x7FFFul;
+}
+
+/*******************************************************************************
+
+    \brief  A map of up to five distinct values below 26, each with one to
+            four numbers.
+
+*******************************************************************************/
+inline TValueMap SubsetTestMap(unsigned long & state)
+{
+    TValueMap values;
+    const int distinct = 1 + (int) (SubsetTestRandom(state) % 5);
+    while((int) values.size() < distinct)
+    {
+        const int value = 1 + (int) (SubsetTestRandom(state) % 25);
+        values[value] = 1 + (int) (SubsetTestRandom(state) % 4);
+    }
+
+    return values;
+}
+
+/*******************************************************************************
+
+    \brief  What brute force found for one target.
+
+*******************************************************************************/
+struct subset_test_answer
+{
+    // Fewest numbers, -1 if the target cannot be made.
+    int least;
+
+    // Lowest largest drawdown as a fraction, and the fewest numbers with it.
+    long long drawdown_numerator;
+    long long drawdown_denominator;
+    int even_items;
+
+    // Number of ways to use the counts.
+    int ways;
+};
+
+/*******************************************************************************
+
+    \brief  Tries every count of every value from index on.
+
+*******************************************************************************/
+inline void SubsetTestSearch(const std::vector<int> & values,
+                             const std::vector<int> & counts,
+                             size_t index,
+                             int remaining,
+                             int items,
+                             long long numerator,
+                             long long denominator,
+                             subset_test_answer & answer)
+{
+    if(remaining == 0)
+    {
+        ++answer.ways;
+        if(answer.least < 0 || items < answer.least) answer.least = items;
+
+        // Compare numerator / denominator against the best so far.
+        const long long lhs = numerator * answer.drawdown_denominator;
+        const long long rhs = answer.drawdown_numerator * denominator;
+        if(answer.even_items < 0 || lhs < rhs ||
+           (lhs == rhs && items < answer.even_items))
+        {
+            answer.drawdown_numerator = numerator;
+            answer.drawdown_denominator = denominator;
+            answer.even_items = items;
+        }
+        return;
+    }
+
+    if(index == values.size()) return;
+
+    for(int used = 0 ;
+        used <= counts[index] && used * values[index] <= remaining ;
+        ++used)
+    {
+        long long next_numerator = numerator;
+        long long next_denominator = denominator;
+        if(used * denominator > numerator * counts[index])
+        {
+            next_numerator = used;
+            next_denominator = counts[index];
+        }
+
+        SubsetTestSearch(values,
+                         counts,
+                         index + 1,
+                         remaining - used * values[index],
+                         items + used,
+                         next_numerator,
+                         next_denominator,
+                         answer);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Solves a target by brute force.
+
+*******************************************************************************/
+inline subset_test_answer SubsetTestBruteForce(const TValueMap & value_map,
+                                               int target)
+{
+    std::vector<int> values;
+    std::vector<int> counts;
+    for(TValueMap::const_iterator iter = value_map.begin() ;
+        iter != value_map.end() ;
+        ++iter)
+    {
+        values.push_back(iter->first);
+        counts.push_back(iter->second);
+    }
+
+    subset_test_answer answer;
+    answer.least = -1;
+    answer.drawdown_numerator = 1;
+    answer.drawdown_denominator = 1;
+    answer.even_items = -1;
+    answer.ways = 0;
+
+    SubsetTestSearch(values, counts, 0, target, 0, 0, 1, answer);
+    return answer;
+}
+
+/*******************************************************************************
+
+    \brief  True if the counts, in value map order, make the target without
+            using more of a value than there is.
+
+*******************************************************************************/
+inline bool SubsetTestFits(const TValueMap & value_map,
+                           const TCountVector & counts,
+                           int target)
+{
+    if(counts.size() != value_map.size()) return false;
+
+    long long sum = 0;
+    TValueMap::const_iterator iter = value_map.begin();
+    for(size_t i = 0 ; i < counts.size() ; ++i, ++iter)
+    {
+        if(counts[i] < 0 || counts[i] > iter->second) return false;
+        sum += (long long) counts[i] * iter->first;
+    }
+
+    return sum == target;
+}
+
+/*******************************************************************************
+
+    \brief  True if a list of numbers makes the target without using more
+            of a value than there is.
+
+*******************************************************************************/
+inline bool SubsetTestSolutionFits(const TValueMap & value_map,
+                                   const TSolution & solution,
+                                   int target)
+{
+    TValueMap used;
+    long long sum = 0;
+    for(size_t i = 0 ; i < solution.size() ; ++i)
+    {
+        sum += solution[i];
+        ++used[solution[i]];
+    }
+
+    for(TValueMap::const_iterator iter = used.begin() ;
+        iter != used.end() ;
+        ++iter)
+    {
+        TValueMap::const_iterator held = value_map.find(iter->first);
+        if(held == value_map.end() || held->second < iter->second)
+        {
+            return false;
+        }
+    }
+
+    return sum == target;
+}
+
+/*******************************************************************************
+
+    \brief  Total of a value map.
+
+*******************************************************************************/
+inline int SubsetTestTotal(const TValueMap & value_map)
+{
+    int total = 0;
+    for(TValueMap::const_iterator iter = value_map.begin() ;
+        iter != value_map.end() ;
+        ++iter)
+    {
+        total += iter->first * iter->second;
+    }
+
+    return total;
+}
+
+/*******************************************************************************
+
+    \brief  LeastCountSolve() and change_solver against brute force.
+            SolveMany() must give the same counts.
+            EvenSolve() must reach the lowest drawdown with the fewest
+            numbers.
+
+*******************************************************************************/
+inline void ExecuteLeastCountTest()
+{
+    unsigned long state = 1;
+    for(int round = 0 ; round < 200 ; ++round)
+    {
+        const TValueMap value_map = SubsetTestMap(state);
+        const int total = SubsetTestTotal(value_map);
+        subset solver(value_map);
+
+        std::vector<int> targets;
+        for(int target = 1 ; target <= total + 2 ; ++target)
+        {
+            targets.push_back(target);
+        }
+
+        std::vector<int> values;
+        std::vector<int> counts;
+        for(TValueMap::const_iterator iter = value_map.begin() ;
+            iter != value_map.end() ;
+            ++iter)
+        {
+            values.push_back(iter->first);
+            counts.push_back(iter->second);
+        }
+
+        change_solver table;
+        table.Build(values, counts, total + 2);
+
+        std::vector<TCountVector> many;
+        solver.SolveMany(targets, many, 2);
+        assert(many.size() == targets.size());
+
+        for(size_t t = 0 ; t < targets.size() ; ++t)
+        {
+            const int target = targets[t];
+            const subset_test_answer answer =
+                SubsetTestBruteForce(value_map, target);
+
+            /*** change_solver ***/
+            assert(table.GetLeastCount(target) == answer.least);
+
+            TCountVector looked_up;
+            const bool found = table.Lookup(target, looked_up);
+            assert(found == (answer.least >= 0));
+            if(found) assert(SubsetTestFits(value_map, looked_up, target));
+
+            /*** LeastCountSolve ***/
+            const TCountVector least = solver.LeastCountSolve(target);
+            assert(least.empty() == (answer.least < 0));
+            assert(many[t] == least);
+            if(!least.empty())
+            {
+                assert(SubsetTestFits(value_map, least, target));
+
+                int items = 0;
+                for(size_t i = 0 ; i < least.size() ; ++i) items += least[i];
+                assert(items == answer.least);
+            }
+
+            /*** EvenSolve ***/
+            const TCountVector even = solver.EvenSolve(target);
+            assert(even.empty() == (answer.least < 0));
+            if(!even.empty())
+            {
+                assert(SubsetTestFits(value_map, even, target));
+
+                long long numerator = 0;
+                long long denominator = 1;
+                int items = 0;
+                TValueMap::const_iterator iter = value_map.begin();
+                for(size_t i = 0 ; i < even.size() ; ++i, ++iter)
+                {
+                    items += even[i];
+                    if(even[i] * denominator > numerator * iter->second)
+                    {
+                        numerator = even[i];
+                        denominator = iter->second;
+                    }
+                }
+
+                assert(numerator * answer.drawdown_denominator ==
+                       answer.drawdown_numerator * denominator);
+                assert(items == answer.even_items);
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+
+    \brief  AnilaoSolve() in every mode.  A solution must fit, can never use
+            fewer numbers than brute force, and the modes that keep the
+            fewest numbers must agree with each other.
+
+*******************************************************************************/
+inline void ExecuteAnilaoSolveTest()
+{
+    const TSolveMode modes[] =
+    {
+        SOLVE_RECURSIVE,
+        SOLVE_PARALLEL,
+        SOLVE_MEET_IN_MIDDLE,
+        SOLVE_BITSET
+    };
+    const size_t mode_count = sizeof(modes) / sizeof(modes[0]);
+
+    unsigned long state = 2;
+    for(int round = 0 ; round < 200 ; ++round)
+    {
+        const TValueMap value_map = SubsetTestMap(state);
+        const int total = SubsetTestTotal(value_map);
+        subset solver(value_map);
+
+        for(int target = 1 ; target <= total ; ++target)
+        {
+            const subset_test_answer answer =
+                SubsetTestBruteForce(value_map, target);
+
+            std::vector<TSolution> solutions(mode_count);
+            for(size_t m = 0 ; m < mode_count ; ++m)
+            {
+                solutions[m] = solver.AnilaoSolve(target, modes[m]);
+                if(solutions[m].empty()) continue;
+
+                assert(SubsetTestSolutionFits(value_map, solutions[m], target));
+                assert((int) solutions[m].size() >= answer.least);
+            }
+
+            for(size_t m = 1 ; m < mode_count ; ++m)
+            {
+                assert(solutions[m].empty() == solutions[0].empty());
+                if(modes[m] == SOLVE_BITSET) continue;
+
+                assert(solutions[m].size() == solutions[0].size());
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+
+    \brief  The blocks kept as counts.  Every whole block is the definition,
+            the blocks never hold more of a value than there is, and a
+            subset of millions of numbers is built and solved from its
+            distinct values alone.
+
+*******************************************************************************/
+inline void ExecuteBlockTest()
+{
+    unsigned long state = 3;
+    for(int round = 0 ; round < 200 ; ++round)
+    {
+        const TValueMap value_map = SubsetTestMap(state);
+        subset solver(value_map);
+
+        TBlock definition;
+        TBlockVector whole_blocks;
+        TBlockVector partial_blocks;
+        solver.GetBlockDefinition(definition);
+        solver.GetWholeBlockVector(whole_blocks);
+        solver.GetPartialBlockVector(partial_blocks);
+        assert(definition.size() == value_map.size());
+
+        int definition_size = 0;
+        for(size_t i = 0 ; i < definition.size() ; ++i)
+        {
+            definition_size += std::max(definition[i], 0);
+        }
+
+        TValueMap used;
+        for(size_t b = 0 ; b < whole_blocks.size() ; ++b)
+        {
+            assert((int) whole_blocks[b].size() == definition_size);
+            assert(whole_blocks[b] == whole_blocks[0]);
+            for(size_t i = 0 ; i < whole_blocks[b].size() ; ++i)
+            {
+                ++used[whole_blocks[b][i]];
+            }
+        }
+        for(size_t b = 0 ; b < partial_blocks.size() ; ++b)
+        {
+            for(size_t i = 0 ; i < partial_blocks[b].size() ; ++i)
+            {
+                ++used[partial_blocks[b][i]];
+            }
+        }
+
+        for(TValueMap::const_iterator iter = used.begin() ;
+            iter != used.end() ;
+            ++iter)
+        {
+            TValueMap::const_iterator held = value_map.find(iter->first);
+            assert(held != value_map.end() && iter->second <= held->second);
+        }
+    }
+
+    TValueMap large;
+    large[1] = 2000000;
+    large[7] = 1500000;
+    large[25] = 1000000;
+    subset large_solver(large);
+
+    const int targets[] = { 1, 6, 1234567, 30000000 };
+    for(size_t t = 0 ; t < sizeof(targets) / sizeof(targets[0]) ; ++t)
+    {
+        const TSolution least = large_solver.LeastSolve(targets[t]);
+        assert(SubsetTestSolutionFits(large, least, targets[t]));
+    }
+
+    // AnilaoSolve() covers the range of one block.
+    int low = 0;
+    int high = 0;
+    large_solver.GetRange(low, high);
+    assert(low >= 1 && high > low);
+    for(int target = low ; target <= high ; ++target)
+    {
+        const TSolution anilao = large_solver.AnilaoSolve(target);
+        assert(SubsetTestSolutionFits(large, anilao, target));
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Withdraw() and Deposit() against a subset built fresh from the
+            same counts, after every step of random update sequences.
+
+*******************************************************************************/
+inline void ExecuteInventoryUpdateTest()
+{
+    unsigned long state = 4;
+    for(int round = 0 ; round < 100 ; ++round)
+    {
+        TValueMap expected = SubsetTestMap(state);
+        subset solver(expected);
+
+        for(int step = 0 ; step < 20 ; ++step)
+        {
+            const unsigned long revision = solver.GetRevision();
+
+            if(expected.empty() || SubsetTestRandom(state) % 3 == 0)
+            {
+                const int value = 1 + (int) (SubsetTestRandom(state) % 25);
+                const int count = 1 + (int) (SubsetTestRandom(state) % 3);
+                solver.Deposit(value, count);
+                expected[value] += count;
+            }
+            else
+            {
+                const int target =
+                    1 + (int) (SubsetTestRandom(state) %
+                               SubsetTestTotal(expected));
+                const TSolution solution = solver.AnilaoSolve(target);
+                if(solution.empty()) continue;
+
+                solver.Withdraw(solution);
+                for(size_t i = 0 ; i < solution.size() ; ++i)
+                {
+                    if(--expected[solution[i]] == 0)
+                    {
+                        expected.erase(solution[i]);
+                    }
+                }
+            }
+
+            assert(solver.GetRevision() != revision);
+
+            TValueMap held;
+            solver.GetValueMap(held);
+            assert(held == expected);
+
+            if(expected.empty())
+            {
+                assert(solver.LeastSolve(1).empty());
+                assert(solver.AnilaoSolve(1).empty());
+                continue;
+            }
+
+            // Same blocks and answers as a subset built from scratch.
+            subset fresh(expected);
+
+            int low = 0;
+            int high = 0;
+            int fresh_low = 0;
+            int fresh_high = 0;
+            solver.GetRange(low, high);
+            fresh.GetRange(fresh_low, fresh_high);
+            assert(low == fresh_low && high == fresh_high);
+
+            TBlock definition;
+            TBlock fresh_definition;
+            solver.GetBlockDefinition(definition);
+            fresh.GetBlockDefinition(fresh_definition);
+            assert(definition == fresh_definition);
+
+            TBlockVector blocks;
+            TBlockVector fresh_blocks;
+            solver.GetWholeBlockVector(blocks);
+            fresh.GetWholeBlockVector(fresh_blocks);
+            assert(blocks == fresh_blocks);
+
+            solver.GetPartialBlockVector(blocks);
+            fresh.GetPartialBlockVector(fresh_blocks);
+            assert(blocks == fresh_blocks);
+
+            const int total = SubsetTestTotal(expected);
+            for(int target = 1 ; target <= total ; ++target)
+            {
+                assert(solver.AnilaoSolve(target) == fresh.AnilaoSolve(target));
+                assert(solver.LeastSolve(target) == fresh.LeastSolve(target));
+            }
+        }
+    }
+
+    // Bad updates throw and leave the counts as they were.
+    TValueMap values;
+    values[2] = 3;
+    values[5] = 1;
+    subset solver(values);
+    const unsigned long revision = solver.GetRevision();
+
+    TSolution too_many(2, 5);
+    TSolution missing(1, 3);
+    TSolution partly_missing;
+    partly_missing.push_back(2);
+    partly_missing.push_back(3);
+
+    const TSolution * bad_withdrawals[] =
+    {
+        &too_many,
+        &missing,
+        &partly_missing
+    };
+
+    for(size_t b = 0 ; b < 3 ; ++b)
+    {
+        bool thrown = false;
+        try
+        {
+            solver.Withdraw(*bad_withdrawals[b]);
+        }
+        catch(std::exception &)
+        {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    const int bad_deposits[][2] = { { 0, 1 }, { -2, 1 }, { 2, 0 }, { 2, -1 } };
+    for(size_t b = 0 ; b < 4 ; ++b)
+    {
+        bool thrown = false;
+        try
+        {
+            solver.Deposit(bad_deposits[b][0], bad_deposits[b][1]);
+        }
+        catch(std::exception &)
+        {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    TValueMap held;
+    solver.GetValueMap(held);
+    assert(held == values && solver.GetRevision() == revision);
+}
+
+/*******************************************************************************
+
+    \brief  solution_enumerator lists every way to use the counts exactly
+            once, fewest numbers first, and within an item count more of
+            the smaller values first.
+
+*******************************************************************************/
+inline void ExecuteEnumeratorTest()
+{
+    unsigned long state = 5;
+    for(int round = 0 ; round < 200 ; ++round)
+    {
+        const TValueMap value_map = SubsetTestMap(state);
+        const int total = SubsetTestTotal(value_map);
+
+        std::vector<int> values;
+        std::vector<int> counts;
+        for(TValueMap::const_iterator iter = value_map.begin() ;
+            iter != value_map.end() ;
+            ++iter)
+        {
+            values.push_back(iter->first);
+            counts.push_back(iter->second);
+        }
+
+        for(int target = 0 ; target <= total + 1 ; ++target)
+        {
+            const subset_test_answer answer =
+                SubsetTestBruteForce(value_map, target);
+
+            solution_enumerator enumerator(values, counts, target);
+            std::set<TCountVector> listed;
+            TCountVector previous;
+            int previous_items = -1;
+
+            TCountVector solution_counts;
+            while(enumerator.Next(solution_counts))
+            {
+                assert(SubsetTestFits(value_map, solution_counts, target));
+
+                int items = 0;
+                for(size_t i = 0 ; i < solution_counts.size() ; ++i)
+                {
+                    items += solution_counts[i];
+                }
+
+                assert(items >= previous_items);
+                if(previous_items < 0) assert(items == answer.least);
+                if(items == previous_items)
+                {
+                    assert(previous > solution_counts);
+                }
+
+                const bool inserted = listed.insert(solution_counts).second;
+                assert(inserted);
+
+                TSolution solution;
+                enumerator.Expand(solution_counts, solution);
+                assert((int) solution.size() == items);
+                assert(SubsetTestSolutionFits(value_map, solution, target));
+                for(size_t i = 1 ; i < solution.size() ; ++i)
+                {
+                    assert(solution[i - 1] <= solution[i]);
+                }
+
+                previous = solution_counts;
+                previous_items = items;
+            }
+
+            assert((int) listed.size() == answer.ways);
+            assert(enumerator.GetValues() == values);
+        }
+    }
+
+    // Equal numbers are one value, so a target they make is listed once.
+    std::vector<int> repeated(6, 4);
+    std::vector<int> ones(6, 1);
+    solution_enumerator equal_values(repeated, ones, 8);
+    TCountVector first;
+    TCountVector second;
+    const bool has_first = equal_values.Next(first);
+    const bool has_second = equal_values.Next(second);
+    assert(has_first && !has_second);
+    assert(first.size() == 1 && first[0] == 2);
+}
+
+/*******************************************************************************
+
+    \brief  AnilaoSolve() with a budget.  With no limit it finishes with the
+            size of the unbudgeted solve, and with a node limit too small
+            to finish it still hands back only solutions that fit.
+
+*******************************************************************************/
+inline void ExecuteBudgetTest()
+{
+    unsigned long state = 6;
+    int stopped = 0;
+    for(int round = 0 ; round < 200 ; ++round)
+    {
+        const TValueMap value_map = SubsetTestMap(state);
+        const int total = SubsetTestTotal(value_map);
+        subset solver(value_map);
+
+        for(int target = 1 ; target <= total ; ++target)
+        {
+            const TSolution unbudgeted = solver.AnilaoSolve(target);
+
+            bool optimal = false;
+            const TSolution budgeted =
+                solver.AnilaoSolve(target, solve_budget(), optimal);
+            assert(optimal);
+            assert(budgeted.size() == unbudgeted.size());
+            if(!budgeted.empty())
+            {
+                assert(SubsetTestSolutionFits(value_map, budgeted, target));
+            }
+
+            const TSolution limited =
+                solver.AnilaoSolve(target, solve_budget(0, 1), optimal);
+            if(!optimal) ++stopped;
+            if(optimal) assert(limited.size() == unbudgeted.size());
+            if(!limited.empty())
+            {
+                assert(SubsetTestSolutionFits(value_map, limited, target));
+                assert(limited.size() >= unbudgeted.size());
+            }
+        }
+    }
+
+    assert(stopped > 0);
+}
+
+/*******************************************************************************
+
+    \brief  meet_middle_solver on blocks past brute force.  40 large values
+            are joined without giving up, a block of 55 is given up on, and
+            AnilaoSolve() falls back to branch and bound for it rather than
+            finding nothing.
+
+*******************************************************************************/
+inline void ExecuteMeetMiddleTest()
+{
+    unsigned long state = 7;
+    std::vector<int> values;
+    std::vector<int> counts(40, 1);
+    long long target = 0;
+    long long total = 0;
+    for(int i = 0 ; i < 40 ; ++i)
+    {
+        const int step = 1 + (int) SubsetTestRandom(state);
+        values.push_back((values.empty() ? 1000000 : values.back()) + step);
+        total += values.back();
+        if(i % 2 == 0) target += values.back();
+    }
+
+    meet_middle_solver solver;
+    std::vector<int> solution_counts;
+    assert(solver.Solve(values, counts, target, solution_counts));
+    assert(!solver.GaveUp());
+
+    long long sum = 0;
+    int items = 0;
+    for(size_t i = 0 ; i < values.size() ; ++i)
+    {
+        assert(solution_counts[i] >= 0 && solution_counts[i] <= counts[i]);
+        sum += (long long) solution_counts[i] * values[i];
+        items += solution_counts[i];
+    }
+    assert(sum == target && items <= 20);
+
+    assert(!solver.Solve(values, counts, total + 1, solution_counts));
+    assert(!solver.GaveUp());
+
+    // Too many count combinations to join.  Values half again as large as
+    // the last each need one or two of the last, so the block holds about
+    // 2^55 count combinations.
+    TValueMap value_map;
+    double next = 1.0;
+    for(int i = 0 ; i < 55 ; ++i)
+    {
+        const int value = std::max((int) next,
+                                   value_map.empty()
+                                   ? 1 : value_map.rbegin()->first + 1);
+        value_map[value] = 4;
+        next *= 1.5;
+    }
+
+    subset fallback(value_map);
+    TBlock definition;
+    fallback.GetBlockDefinition(definition);
+    values.clear();
+    counts.clear();
+    for(TValueMap::const_iterator it = value_map.begin() ;
+        it != value_map.end() ;
+        ++it)
+    {
+        values.push_back(it->first);
+        counts.push_back(std::max(definition[values.size() - 1], 0));
+    }
+
+    assert(!solver.Solve(values, counts, values.back(), solution_counts));
+    assert(solver.GaveUp());
+
+    const int targets[] =
+    {
+        values[54] + values[50] + values[10],
+        values[54] + values[53] + values[52] + values[51] + values[2],
+        1000000007
+    };
+
+    for(size_t t = 0 ; t < sizeof(targets) / sizeof(targets[0]) ; ++t)
+    {
+        const TSolution met =
+            fallback.AnilaoSolve(targets[t], SOLVE_MEET_IN_MIDDLE);
+
+        bool optimal = false;
+        const TSolution searched =
+            fallback.AnilaoSolve(targets[t], solve_budget(), optimal);
+        assert(optimal && !searched.empty());
+        assert(SubsetTestSolutionFits(value_map, met, targets[t]));
+        assert(met.size() == searched.size());
+        assert(fallback.AnilaoSolve(targets[t], SOLVE_MEET_IN_MIDDLE) == met);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  The solution cache.  Repeats are hits with the same answer, a
+            Withdraw() or Deposit() is never answered from the old counts,
+            and the least recently used entry is the one evicted.
+
+*******************************************************************************/
+inline void ExecuteSolutionCacheTest()
+{
+    TValueMap values;
+    values[1] = 3;
+    values[5] = 4;
+    values[10] = 2;
+    values[25] = 2;
+
+    subset solver(values);
+    solver.SetCacheCapacity(2);
+
+    const TSolution first = solver.AnilaoSolve(37);
+    assert(solver.GetCacheHits() == 0 && solver.GetCacheMisses() == 1);
+    assert(solver.AnilaoSolve(37) == first);
+    assert(solver.GetCacheHits() == 1 && solver.GetCacheMisses() == 1);
+
+    // LeastSolve() and each mode are cached apart.
+    const TSolution least = solver.LeastSolve(37);
+    assert(solver.GetCacheHits() == 1 && solver.GetCacheMisses() == 2);
+    assert(solver.LeastSolve(37) == least);
+    assert(solver.GetCacheHits() == 2);
+
+    // 37 is older than the LeastSolve() entry, so it goes first.
+    solver.AnilaoSolve(16);
+    assert(solver.GetCacheMisses() == 3);
+    solver.LeastSolve(37);
+    assert(solver.GetCacheHits() == 3);
+    solver.AnilaoSolve(37);
+    assert(solver.GetCacheMisses() == 4);
+
+    // Withdrawn numbers are not handed out again from the cache.
+    solver.Withdraw(first);
+    TValueMap left;
+    solver.GetValueMap(left);
+    subset fresh(left);
+
+    const unsigned long long misses = solver.GetCacheMisses();
+    const TSolution after = solver.AnilaoSolve(37);
+    assert(solver.GetCacheMisses() == misses + 1);
+    assert(after == fresh.AnilaoSolve(37));
+    if(!after.empty()) assert(SubsetTestSolutionFits(left, after, 37));
+
+    // Back to the old counts, the old entries are good again.
+    for(size_t i = 0 ; i < first.size() ; ++i) solver.Deposit(first[i], 1);
+    const unsigned long long hits = solver.GetCacheHits();
+    assert(solver.AnilaoSolve(37) == first);
+    assert(solver.GetCacheHits() == hits + 1);
+
+    // Off, nothing is kept.
+    solver.SetCacheCapacity(0);
+    solver.AnilaoSolve(37);
+    solver.AnilaoSolve(37);
+    assert(solver.GetCacheHits() == hits + 1);
+}
+
+/*******************************************************************************
+
+    \brief  The caller buffer overloads give the answers of the ones that
+            return a TSolution, and a buffer that has grown is reused.
+
+*******************************************************************************/
+inline void ExecuteBufferTest()
+{
+    const TSolveMode modes[] =
+    {
+        SOLVE_RECURSIVE,
+        SOLVE_PARALLEL,
+        SOLVE_MEET_IN_MIDDLE,
+        SOLVE_BITSET
+    };
+    const size_t mode_count = sizeof(modes) / sizeof(modes[0]);
+
+    TCompactSolution compact;
+    TSolution expanded;
+
+    unsigned long state = 7;
+    for(int round = 0 ; round < 100 ; ++round)
+    {
+        const TValueMap value_map = SubsetTestMap(state);
+        const int total = SubsetTestTotal(value_map);
+        subset solver(value_map);
+
+        for(int target = 1 ; target <= total + 1 ; ++target)
+        {
+            for(size_t m = 0 ; m <= mode_count ; ++m)
+            {
+                TSolution solution;
+                if(m == mode_count)
+                {
+                    solver.LeastSolve(target, compact);
+                    solution = solver.LeastSolve(target);
+                }
+                else
+                {
+                    solver.AnilaoSolve(target, compact, modes[m]);
+                    solution = solver.AnilaoSolve(target, modes[m]);
+                }
+
+                expanded.clear();
+                for(size_t i = 0 ; i < compact.size() ; ++i)
+                {
+                    assert(compact[i].second > 0);
+                    if(i > 0) assert(compact[i - 1].first < compact[i].first);
+                    expanded.insert(expanded.end(),
+                                    compact[i].second,
+                                    compact[i].first);
+                }
+
+                // Only the size is fixed where the modes may pick.
+                std::sort(solution.begin(), solution.end());
+                assert(expanded.size() == solution.size());
+                if(m == mode_count || modes[m] == SOLVE_RECURSIVE)
+                {
+                    assert(expanded == solution);
+                }
+                else if(!expanded.empty())
+                {
+                    assert(SubsetTestSolutionFits(value_map, expanded, target));
+                }
+            }
+        }
+    }
+
+    // Once big enough the buffer keeps its memory.
+    TValueMap values;
+    values[1] = 5;
+    values[3] = 5;
+    values[7] = 5;
+    subset solver(values);
+
+    solver.AnilaoSolve(11, compact);
+    const size_t capacity = compact.capacity();
+    const TDenomination * memory = compact.empty() ? 0 : &compact[0];
+    for(int target = 1 ; target <= 50 ; ++target)
+    {
+        solver.AnilaoSolve(target, compact);
+        solver.LeastSolve(target, compact);
+    }
+    solver.AnilaoSolve(11, compact);
+    assert(compact.capacity() == capacity && &compact[0] == memory);
+
+    // A reset enumerator lists what a new one does.
+    solution_enumerator reused;
+    TCountVector counts;
+    assert(!reused.Next(counts));
+
+    std::vector<int> enumerated_values;
+    std::vector<int> enumerated_counts;
+    for(TValueMap::const_iterator iter = values.begin() ;
+        iter != values.end() ;
+        ++iter)
+    {
+        enumerated_values.push_back(iter->first);
+        enumerated_counts.push_back(iter->second);
+    }
+
+    for(int target = 0 ; target <= 60 ; ++target)
+    {
+        reused.Reset(enumerated_values, enumerated_counts, target);
+        solution_enumerator fresh(enumerated_values, enumerated_counts, target);
+
+        TCountVector fresh_counts;
+        bool more = true;
+        while(more)
+        {
+            more = reused.Next(counts);
+            const bool fresh_more = fresh.Next(fresh_counts);
+            assert(more == fresh_more);
+            if(more) assert(counts == fresh_counts);
+        }
+    }
+}
+
+/*******************************************************************************
+
+    \brief  amount_subset over ints, decimals and targets past the tables.
+
+*******************************************************************************/
+inline void ExecuteAmountSubsetTest()
+{
+    // A value with no count must not shift the others.
+    std::map<int, int> with_zero;
+    with_zero[1] = 0;
+    with_zero[3] = 4;
+    with_zero[4] = 1;
+    amount_subset<int> zero_solver(with_zero);
+
+    for(int target = 1 ; target <= 16 ; ++target)
+    {
+        std::vector<int> solution;
+        const bool found = zero_solver.Solve(target, solution);
+
+        TValueMap held;
+        held[3] = 4;
+        held[4] = 1;
+        assert(found == (SubsetTestBruteForce(held, target).least >= 0));
+        if(found) assert(SubsetTestSolutionFits(held, solution, target));
+    }
+
+    // Decimals solve on their greatest common divisor.
+    typedef decimal<2> money;
+    std::map<money, int> notes;
+    notes[money(5.0)] = 10;
+    notes[money(25.0)] = 4;
+    notes[money(100.0)] = 2;
+    amount_subset<money> note_solver(notes);
+    assert(note_solver.GetDivisor() == 500);
+
+    std::vector<money> paid;
+    const bool paid_found = note_solver.Solve(money(130.0), paid);
+    assert(paid_found);
+    money paid_total(0.0);
+    for(size_t i = 0 ; i < paid.size() ; ++i) paid_total = paid_total + paid[i];
+    assert(paid_total == money(130.0));
+    const bool below_divisor = note_solver.Solve(money(1.0), paid);
+    const bool above_total = note_solver.Solve(money(1000.0), paid);
+    assert(!below_divisor && !above_total);
+
+    // Past the table the 64 bit meet in the middle search answers.
+    std::map<long long, int> wide;
+    wide[3] = 5;
+    wide[10000007] = 3;
+    amount_subset<long long> wide_solver(wide);
+
+    // The table budget covers the best, previous and window rows too.
+    typedef amount_subset<long long> wide_subset;
+    assert((wide_solver.GetMaxTableTarget() + 1) * 5 * (long long) sizeof(int)
+           <= wide_subset::MAX_TABLE_BYTES);
+
+    std::vector<long long> wide_solution;
+    const long long wide_target = 3LL * 10000007 + 2 * 3;
+    assert(wide_target > wide_solver.GetMaxTableTarget());
+    const bool wide_found = wide_solver.Solve(wide_target, wide_solution);
+    assert(wide_found);
+
+    long long wide_total = 0;
+    for(size_t i = 0 ; i < wide_solution.size() ; ++i)
+    {
+        wide_total += wide_solution[i];
+    }
+    assert(wide_total == wide_target && wide_solution.size() == 5);
+
+    // Values half again as large as the last, four of each, are too many
+    // count combinations to join.  Branch and bound answers instead.
+    std::map<long long, int> many;
+    std::vector<long long> many_values;
+    double next = 1.0;
+    for(int i = 0 ; i < 45 ; ++i)
+    {
+        const long long value = std::max((long long) next,
+                                         many_values.empty()
+                                         ? 1 : many_values.back() + 1);
+        many[value] = 4;
+        many_values.push_back(value);
+        next *= 1.5;
+    }
+
+    amount_subset<long long> many_solver(many);
+    const long long many_targets[] =
+    {
+        4 * many_values[44] + 3 * many_values[43] + 2 * many_values[42],
+        300000007LL
+    };
+
+    for(size_t t = 0 ; t < 2 ; ++t)
+    {
+        assert(many_targets[t] > many_solver.GetMaxTableTarget());
+
+        std::vector<long long> many_solution;
+        const bool many_found = many_solver.Solve(many_targets[t],
+                                                  many_solution,
+                                                  SOLVE_MEET_IN_MIDDLE);
+        assert(many_found);
+
+        long long many_total = 0;
+        for(size_t i = 0 ; i < many_solution.size() ; ++i)
+        {
+            many_total += many_solution[i];
+        }
+        assert(many_total == many_targets[t]);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  fleet_solver single units, pairs and the target bound.
+
+*******************************************************************************/
+inline void ExecuteFleetSolverTest()
+{
+    TValueMap first_values;
+    first_values[1] = 2;
+    first_values[5] = 3;
+    TValueMap second_values;
+    second_values[1] = 2;
+    second_values[5] = 1;
+    TValueMap third_values;
+    third_values[10] = 2;
+
+    subset first(first_values);
+    subset second(second_values);
+    subset third(third_values);
+
+    fleet_solver fleet(2, 100);
+    fleet.AddUnit(first);
+    fleet.AddUnit(second);
+    fleet.AddUnit(third);
+
+    const TValueMap * unit_values[] =
+    {
+        &first_values,
+        &second_values,
+        &third_values
+    };
+
+    for(int target = 1 ; target <= 40 ; ++target)
+    {
+        fleet_route route;
+        bool complete = false;
+        const bool found = fleet.Route(target, solve_budget(), route, complete);
+        assert(complete);
+        if(!found) continue;
+
+        assert(route.units.size() == route.counts.size());
+        assert(route.units.size() == 1 || route.units.size() == 2);
+
+        int sum = 0;
+        for(size_t r = 0 ; r < route.units.size() ; ++r)
+        {
+            const size_t unit = route.units[r];
+            assert(unit < 3);
+
+            const TValueMap & held = *unit_values[unit];
+            TValueMap::const_iterator iter = held.begin();
+            for(size_t i = 0 ; i < route.counts[r].size() ; ++i, ++iter)
+            {
+                assert(route.counts[r][i] <= iter->second);
+                sum += route.counts[r][i] * iter->first;
+            }
+        }
+        assert(sum == target);
+
+        // Any single unit that can make it is used alone.
+        if(route.units.size() == 2)
+        {
+            for(size_t u = 0 ; u < 3 ; ++u)
+            {
+                assert(SubsetTestBruteForce(*unit_values[u], target).least <
+                       0);
+            }
+        }
+    }
+
+    // 35 only splits, between the third unit and the first.
+    fleet_route split;
+    bool complete = false;
+    const bool split_found = fleet.Route(35, solve_budget(), split, complete);
+    assert(split_found && split.units.size() == 2);
+
+    // Past the bound nothing is built.
+    const size_t tables = fleet.GetTableCount();
+    const bool past_found = fleet.Route(101, solve_budget(), split, complete);
+    assert(!past_found);
+    assert(fleet.GetTableCount() == tables && tables <= 3);
+}
+
+/*******************************************************************************
+
+    \brief  Writes a solver_table, maps it back and checks it against
+            change_solver.
+
+*******************************************************************************/
+inline void ExecuteSolverTableTest()
+{
+    const char * path = "subsettest.tbl";
+
+    std::vector<int> values;
+    values.push_back(1);
+    values.push_back(5);
+    values.push_back(12);
+    values.push_back(25);
+    solver_table::Write(path, values, 500);
+
+    solver_table table;
+    table.Open(path);
+    assert(table.GetBound() == 500);
+
+    std::vector<int> read_values;
+    table.GetValues(read_values);
+    assert(read_values == values);
+
+    const std::vector<int> unlimited(values.size(), 1000);
+    std::vector<int> few(values.size(), 2);
+    few[0] = 4;
+
+    change_solver reference;
+    reference.Build(values, unlimited, 500);
+
+    for(int target = 0 ; target <= 500 ; ++target)
+    {
+        assert(table.GetLeastCount(target) ==
+               reference.GetLeastCount(target));
+
+        std::vector<int> counts;
+        const bool looked_up = table.Lookup(target, counts);
+        assert(looked_up);
+
+        int sum = 0;
+        int items = 0;
+        for(size_t i = 0 ; i < counts.size() ; ++i)
+        {
+            sum += counts[i] * values[i];
+            items += counts[i];
+        }
+        assert(sum == target && items == table.GetLeastCount(target));
+
+        // The table answer only when it fits the counts.
+        std::vector<int> bounded_counts;
+        const bool bounded = table.Lookup(target, few, bounded_counts);
+        bool fits = true;
+        for(size_t i = 0 ; i < counts.size() ; ++i)
+        {
+            fits = fits && counts[i] <= few[i];
+        }
+        assert(bounded == fits);
+        if(bounded) assert(bounded_counts == counts);
+
+        // Real counts, the table first and change_solver behind it.
+        std::vector<int> fitted;
+        std::vector<int> expected;
+        change_solver bounded_solver;
+        const bool found = table.Solve(target, few, fitted);
+        const bool reference_found =
+            bounded_solver.Solve(values, few, target, expected);
+        assert(found == reference_found);
+        if(!found) continue;
+
+        int fitted_items = 0;
+        int expected_items = 0;
+        for(size_t i = 0 ; i < fitted.size() ; ++i)
+        {
+            assert(fitted[i] <= few[i]);
+            fitted_items += fitted[i];
+            expected_items += expected[i];
+        }
+        assert(fitted_items == expected_items);
+    }
+
+#ifndef _WIN32
+    // Rewriting a mapped file leaves the mapping on the old table.
+    solver_table::Write(path, values, 100);
+    assert(table.GetBound() == 500);
+    assert(table.GetLeastCount(500) == reference.GetLeastCount(500));
+
+    solver_table rewritten;
+    rewritten.Open(path);
+    assert(rewritten.GetBound() == 100);
+    rewritten.Close();
+#endif
+
+    table.Close();
+    std::remove(path);
+}
+
+/*******************************************************************************
+
+    \brief  Threads dispensing from one concurrent_inventory.
+
+*******************************************************************************/
+struct subset_test_dispenser
+{
+    concurrent_inventory * inventory;
+    solver_atomic dispensed;
+    solver_atomic contended;
+
+    void operator()(size_t index)
+    {
+        for(int i = 0 ; i < 2000 ; ++i)
+        {
+            const int target = 1 + (int) ((index * 7 + i) % 30);
+
+            TSolution solution;
+            const TDispenseStatus status = inventory->Dispense(target,
+                                                               solution);
+            if(status == DISPENSE_CONTENDED) contended.Add(1);
+            if(status != DISPENSE_OK)
+            {
+                assert(solution.empty());
+                continue;
+            }
+
+            int sum = 0;
+            for(size_t k = 0 ; k < solution.size() ; ++k) sum += solution[k];
+            assert(sum == target);
+            dispensed.Add(sum);
+        }
+    }
+};
+
+/*******************************************************************************
+
+    \brief  Every number dispensed came out of the counts exactly once.
+
+*******************************************************************************/
+inline void ExecuteConcurrentInventoryTest()
+{
+    TValueMap values;
+    values[1] = 400;
+    values[2] = 300;
+    values[5] = 200;
+    values[10] = 100;
+    const int start_total = SubsetTestTotal(values);
+
+    concurrent_inventory inventory(values);
+    subset_test_dispenser dispenser;
+    dispenser.inventory = &inventory;
+    solver_threads::Run(8, dispenser, 8);
+
+    TValueMap left;
+    const bool consistent = inventory.GetSnapshot(left);
+    assert(consistent);
+    assert(SubsetTestTotal(left) + dispenser.dispensed.Load() == start_total);
+    assert(dispenser.dispensed.Load() > 0);
+    assert((unsigned long long) dispenser.contended.Load() ==
+           inventory.GetAbandoned());
+
+    // With no other thread about, only a real lack of numbers says no.
+    TValueMap few;
+    few[5] = 1;
+    concurrent_inventory single(few);
+    TSolution solution;
+    assert(single.Dispense(3, solution) == DISPENSE_NO_SOLUTION);
+    assert(single.Dispense(5, solution) == DISPENSE_OK);
+    assert(solution.size() == 1 && solution[0] == 5);
+    assert(single.Dispense(5, solution) == DISPENSE_NO_SOLUTION);
+    assert(single.GetAbandoned() == 0);
+}
+
+/*******************************************************************************
+
+    \brief  Two clients of one solver_service over loopback.  The first
+            sends every request before reading a reply, the second makes
+            round trips meanwhile.
+
+*******************************************************************************/
+struct subset_test_clients
+{
+    unsigned short port;
+    unsigned int pipelined;
+    bool pipelined_ok;
+    bool round_trips_ok;
+
+    void operator()(size_t index)
+    {
+        solver_client client;
+        client.Connect("127.0.0.1", port);
+
+        if(index == 0)
+        {
+            for(unsigned int id = 0 ; id < pipelined ; ++id)
+            {
+                client.Send(id, SERVICE_SOLVE, 1 + (int) (id % 40));
+            }
+
+            std::vector<char> seen(pipelined, 0);
+            pipelined_ok = true;
+            for(unsigned int i = 0 ; i < pipelined ; ++i)
+            {
+                service_reply reply;
+                if(!client.Receive(reply) || reply.id >= pipelined ||
+                   seen[reply.id])
+                {
+                    pipelined_ok = false;
+                    break;
+                }
+                seen[reply.id] = 1;
+            }
+        }
+        else
+        {
+            round_trips_ok = true;
+            for(unsigned int id = 0 ; id < 200 ; ++id)
+            {
+                client.Send(id, SERVICE_LEAST_COUNT, 17);
+
+                service_reply reply;
+                if(!client.Receive(reply) || reply.id != id ||
+                   reply.status != SERVICE_OK)
+                {
+                    round_trips_ok = false;
+                    break;
+                }
+            }
+        }
+
+        client.Close();
+    }
+};
+
+/*******************************************************************************
+
+    \brief  solver_service over loopback.
+
+*******************************************************************************/
+inline void ExecuteSolverServiceTest()
+{
+    TValueMap values;
+    values[1] = 500;
+    values[5] = 400;
+    values[10] = 300;
+    values[25] = 200;
+
+    solver_service service(values, 1);
+    service.Start();
+
+    subset_test_clients clients;
+    clients.port = service.GetPort();
+    clients.pipelined = 200000;
+    clients.pipelined_ok = false;
+    clients.round_trips_ok = false;
+    solver_threads::Run(2, clients, 2);
+
+    assert(clients.pipelined_ok);
+    assert(clients.round_trips_ok);
+    assert(service.GetRequestCount() == 200200);
+
+    // Bad requests get a reply, not a dropped connection.
+    solver_client client;
+    client.Connect("127.0.0.1", service.GetPort());
+    client.Send(1, SERVICE_SOLVE, -3);
+    client.Send(2, (TServiceOp) 9, 3);
+
+    service_reply first_reply;
+    service_reply second_reply;
+    const bool received = client.Receive(first_reply) &&
+                          client.Receive(second_reply);
+    assert(received);
+    assert(first_reply.status == SERVICE_BAD_REQUEST);
+    assert(second_reply.status == SERVICE_BAD_REQUEST);
+    client.Close();
+
+#ifndef _WIN32
+    // Out of handles, accept() fails and the service waits it out.  The
+    // lowest free handle is kept for the client and the limit set just
+    // above it, so only the service runs out.
+    rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    const int spare = dup(0);
+    assert(spare >= 0);
+
+    rlimit lowered = limit;
+    lowered.rlim_cur = (rlim_t) spare + 1;
+    setrlimit(RLIMIT_NOFILE, &lowered);
+    close(spare);
+
+    solver_client starved;
+    starved.Connect("127.0.0.1", service.GetPort());
+
+    PosixThread::Event pause;
+    pause.Wait(100);
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    service_reply starved_reply;
+    starved.Send(3, SERVICE_SOLVE, 30);
+    const bool starved_received = starved.Receive(starved_reply);
+    assert(starved_received);
+    assert(starved_reply.id == 3 && starved_reply.status == SERVICE_OK);
+    starved.Close();
+#endif
+
+    service.Stop();
+
+    // A service can be started again after it was stopped.
+    service.Start();
+    solver_client again;
+    again.Connect("127.0.0.1", service.GetPort());
+    again.Send(4, SERVICE_SOLVE, 30);
+
+    service_reply again_reply;
+    const bool again_received = again.Receive(again_reply);
+    assert(again_received && again_reply.id == 4);
+    again.Close();
+    service.Stop();
+}
+
+/*******************************************************************************
+
+    \brief  Executes every subset test.
+
+*******************************************************************************/
+inline void ExecuteSubsetLibraryTest()
+{
+    ExecuteLeastCountTest();
+    ExecuteAnilaoSolveTest();
+    ExecuteBlockTest();
+    ExecuteInventoryUpdateTest();
+    ExecuteEnumeratorTest();
+    ExecuteBudgetTest();
+    ExecuteMeetMiddleTest();
+    ExecuteSolutionCacheTest();
+    ExecuteBufferTest();
+    ExecuteAmountSubsetTest();
+    ExecuteFleetSolverTest();
+    ExecuteSolverTableTest();
+    ExecuteConcurrentInventoryTest();
+    ExecuteSolverServiceTest();
+}
+}
+
+#endif
@@ -0,0 +1,329 @@
+/*******************************************************************************
+
+    \file   calendar.h
+
+    \brief  Civil (proleptic Gregorian) calendar conversions for time objects.
+
+            A time object is treated as the elapsed time since an epoch day,
+            1970-01-01 unless another day number is given.  The time family
+            only holds about 106 days, so long histories should pass the first
+            day of the record set as the epoch.  The conversions between day
+            numbers and year/month/day use only integer arithmetic
+            (H. Hinnant's days_from_civil and civil_from_days), so bucketing
+            large record sets by calendar day, week or month never touches
+            floating point.
+
+*******************************************************************************/
+
+#ifndef CALENDAR_H
+#define CALENDAR_H
+
+// Standard Library Dependancies.
+#include <cmath>
+#include <vector>
+
+// General Dependancies.
+#include "days.h"
+#include "time.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \brief  Stucture that holds a civil date.
+
+*******************************************************************************/
+struct civildate
+{
+    // Constructor.
+    civildate() : year(1970), month(1), day(1) {}
+
+    // Constructor.
+    civildate(long long y, unsigned int m, unsigned int d)
+        : year(y), month(m), day(d) {}
+
+    // Equality operator.
+    bool operator==(const civildate & rhs) const
+    {
+        return year == rhs.year && month == rhs.month && day == rhs.day;
+    }
+
+    // Inequality operator.
+    bool operator!=(const civildate & rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+    // Year, can be negative.
+    long long year;
+
+    // Month of the year [1, 12].
+    unsigned int month;
+
+    // Day of the month [1, 31].
+    unsigned int day;
+};
+
+/*******************************************************************************
+
+    \brief  Number of core time data units (the raw decimal integer) in a day.
+
+*******************************************************************************/
+inline long long GetRawTimeUnitsInADay()
+{
+    static const long long rawUnitsInADay =
+        (long long) CORE_UNITS_TO_ONE_MILLISECOND * 86400000LL *
+        (long long) pow(10.0, (double) TIME_PRECISION);
+
+    return rawUnitsInADay;
+}
+
+/*******************************************************************************
+
+    \brief  Number of days since 1970-01-01 for the given civil date.
+
+    \param  long long - Year.
+    \param  unsigned int - Month [1, 12].
+    \param  unsigned int - Day [1, 31].
+
+    \return long long - Day number, negative before the epoch.
+
+*******************************************************************************/
+inline long long DaysFromCivil(long long year,
+                               unsigned int month,
+                               unsigned int day)
+{
+    // Shift the year so that it starts on March 1st, leap day is then last.
+    year -= month <= 2;
+
+    // 400 year era, each era is exactly 146097 days.
+    const long long era = (year >= 0 ? year : year - 399) / 400;
+    const long long yoe = year - era * 400;
+
+    // Day of the March based year, then day of the era.
+    const long long doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 +
+                          day - 1;
+    const long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    // 719468 is the number of days from 0000-03-01 to 1970-01-01.
+    return era * 146097 + doe - 719468;
+}
+
+/*******************************************************************************
+
+    \brief  Civil date for the given number of days since 1970-01-01.
+
+    \param  long long - Day number, negative before the epoch.
+
+    \return civildate - The civil date.
+
+*******************************************************************************/
+inline civildate CivilFromDays(long long day_number)
+{
+    day_number += 719468;
+
+    // Break the day number down into era and day of the era.
+    const long long era = (day_number >= 0 ? day_number :
+                                             day_number - 146096) / 146097;
+    const long long doe = day_number - era * 146097;
+
+    // Year of the era, then day of the March based year.
+    const long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+
+    // March based month, then the civil day and month.
+    const long long mp = (5 * doy + 2) / 153;
+    const unsigned int day = (unsigned int) (doy - (153 * mp + 2) / 5 + 1);
+    const unsigned int month = (unsigned int) (mp < 10 ? mp + 3 : mp - 9);
+
+    return civildate(yoe + era * 400 + (month <= 2), month, day);
+}
+
+/*******************************************************************************
+
+    \brief  Whole days since the epoch, rounded toward negative infinity.
+
+    \param  const time & - Elapsed time since the epoch day.
+    \param  long long - Day number of the epoch day.
+
+    \return long long - Day number.
+
+*******************************************************************************/
+inline long long DayNumber(const time & elapsed, long long epoch_day = 0)
+{
+    const long long raw = elapsed.GetData().GetRawData();
+    const long long rawUnitsInADay = GetRawTimeUnitsInADay();
+
+    // Integer division truncates, we need the floor for negative numbers.
+    long long day_number = raw / rawUnitsInADay;
+    if(raw % rawUnitsInADay < 0) --day_number;
+
+    return epoch_day + day_number;
+}
+
+/*******************************************************************************
+
+    \brief  Days object representing the start of the given day number.
+
+    \param  long long - Day number.
+    \param  long long - Day number of the epoch day.
+
+    \return days - Elapsed time since the epoch day.
+
+*******************************************************************************/
+inline days DaysFromDayNumber(long long day_number, long long epoch_day = 0)
+{
+    decimal<TIME_PRECISION> data;
+    data.SetRawData((day_number - epoch_day) * GetRawTimeUnitsInADay());
+
+    days retDays;
+    retDays.SetData(data);
+
+    return retDays;
+}
+
+/*******************************************************************************
+
+    \brief  Civil date of the given elapsed time.
+
+    \param  const time & - Elapsed time since the epoch day.
+    \param  long long - Day number of the epoch day.
+
+    \return civildate - The civil date.
+
+*******************************************************************************/
+inline civildate CivilFromTime(const time & elapsed, long long epoch_day = 0)
+{
+    return CivilFromDays(DayNumber(elapsed, epoch_day));
+}
+
+/*******************************************************************************
+
+    \brief  Day of the week of the given day number.
+
+    \param  long long - Day number.
+
+    \return unsigned int - Day of the week, 0 is Sunday and 6 is Saturday.
+
+*******************************************************************************/
+inline unsigned int Weekday(long long day_number)
+{
+    // 1970-01-01 was a Thursday.
+    return (unsigned int) (day_number >= -4 ? (day_number + 4) % 7 :
+                                              (day_number + 5) % 7 + 6);
+}
+
+/*******************************************************************************
+
+    \brief  Bucket key of the week holding the given day number.  Weeks start
+            on Monday, week zero starts on 1969-12-29.
+
+    \param  long long - Day number.
+
+    \return long long - Week key.
+
+*******************************************************************************/
+inline long long WeekKey(long long day_number)
+{
+    // Floor division, so days before 1969-12-29 land in negative weeks.
+    const long long shifted = day_number + 3;
+    return (shifted >= 0 ? shifted : shifted - 6) / 7;
+}
+
+/*******************************************************************************
+
+    \brief  Bucket key of the month holding the given day number.  The key
+            is year * 12 + (month - 1), so consecutive months have
+            consecutive keys.
+
+    \param  long long - Day number.
+
+    \return long long - Month key.
+
+*******************************************************************************/
+inline long long MonthKey(long long day_number)
+{
+    const civildate date = CivilFromDays(day_number);
+    return date.year * 12 + date.month - 1;
+}
+
+/*******************************************************************************
+
+    \brief  Converts a vector of elapsed times into day numbers.
+
+    \param  const std::vector<days> & - Elapsed times since the epoch day.
+    \param  std::vector<long long> & - Resulting day numbers.
+    \param  long long - Day number of the epoch day.
+
+*******************************************************************************/
+inline void DayNumbers(const std::vector<days> & elapsed,
+                       std::vector<long long> & result,
+                       long long epoch_day = 0)
+{
+    const long long rawUnitsInADay = GetRawTimeUnitsInADay();
+
+    result.resize(elapsed.size());
+    for(size_t i = 0 ; i < elapsed.size() ; ++i)
+    {
+        const long long raw = elapsed[i].GetData().GetRawData();
+        result[i] = epoch_day + raw / rawUnitsInADay -
+                    (raw % rawUnitsInADay < 0);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Converts a vector of day numbers into civil dates.
+
+    \param  const std::vector<long long> & - Day numbers.
+    \param  std::vector<civildate> & - Resulting civil dates.
+
+*******************************************************************************/
+inline void CivilFromDays(const std::vector<long long> & day_numbers,
+                          std::vector<civildate> & result)
+{
+    result.resize(day_numbers.size());
+    for(size_t i = 0 ; i < day_numbers.size() ; ++i)
+    {
+        result[i] = CivilFromDays(day_numbers[i]);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Converts a vector of day numbers into week bucket keys.
+
+    \param  const std::vector<long long> & - Day numbers.
+    \param  std::vector<long long> & - Resulting week keys.
+
+*******************************************************************************/
+inline void WeekKeys(const std::vector<long long> & day_numbers,
+                     std::vector<long long> & result)
+{
+    result.resize(day_numbers.size());
+    for(size_t i = 0 ; i < day_numbers.size() ; ++i)
+    {
+        result[i] = WeekKey(day_numbers[i]);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Converts a vector of day numbers into month bucket keys.
+
+    \param  const std::vector<long long> & - Day numbers.
+    \param  std::vector<long long> & - Resulting month keys.
+
+*******************************************************************************/
+inline void MonthKeys(const std::vector<long long> & day_numbers,
+                      std::vector<long long> & result)
+{
+    result.resize(day_numbers.size());
+    for(size_t i = 0 ; i < day_numbers.size() ; ++i)
+    {
+        result[i] = MonthKey(day_numbers[i]);
+    }
+}
+}
+
+#endif
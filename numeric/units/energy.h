@@ -0,0 +1,576 @@
+/*******************************************************************************
+
+    \file   energy.h
+
+    \brief  Class declaration for base unit of energy.
+            1 kilocalorie = 4184000000 microjoules
+
+*******************************************************************************/
+
+#ifndef ENERGY_H
+#define ENERGY_H
+
+// Standard Library Dependancies.
+#include <cmath>
+#include <string>
+#include <iomanip>
+#include <sstream>
+
+// General Dependancies.
+#include "unit.h"
+#include "../decimal/decimal.h"
+
+// This defines how many coredata units make one microjoule.
+#define CORE_UNITS_TO_ONE_MICROJOULE 1ULL
+
+// This defines how many coredata units make one (thermochemical) kilocalorie.
+#define CORE_UNITS_TO_ONE_KILOCALORIE 4184000000ULL
+
+// This defines how much decimal precision our core data unit has.
+#define ENERGY_PRECISION 0u
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  energy
+
+    \brief  Abstract base class for all measurable energy units.
+
+*******************************************************************************/
+class energy : public unit<ENERGY_PRECISION>
+{
+public:
+
+    // Constructor.
+    energy();
+
+    // Copy Constructor.
+    energy(const energy & origBaseEnergy);
+
+    // Destructor.
+    virtual ~energy();
+
+    // The child class must define this for conversions.
+    virtual double GetCoreUnitConversion() const;
+
+    // energy assignment operator overload.
+    virtual energy operator=(const energy & rhs);
+
+    // Decimal number assignment operator overload.
+    virtual energy operator=(const double & rhs);
+
+    // Addition operator overload.
+    virtual energy operator+(const energy & rhs) const;
+
+    // Subtraction operator overload.
+    virtual energy operator-(const energy & rhs) const;
+
+    // Addition increment operator overload.
+    virtual energy operator+=(const energy & rhs);
+
+    // Subtraction increment operator overload.
+    virtual energy operator-=(const energy & rhs);
+
+    // Equality operator overload.
+    virtual bool operator==(const energy & rhs) const;
+
+    // Inequality operator overload.
+    virtual bool operator!=(const energy & rhs) const;
+
+    // Greater-or-equal-than operator overload.
+    virtual bool operator>=(const energy & rhs) const;
+
+    // Less-or-equal-than operator overload.
+    virtual bool operator<=(const energy & rhs) const;
+
+    // Greater operator overload.
+    virtual bool operator>(const energy & rhs) const;
+
+    // Less-or-equal-than operator overload.
+    virtual bool operator<(const energy & rhs) const;
+
+    // Conversion operator overload.
+    virtual operator double() const;
+
+    // Conversion operator overload.
+    virtual operator int() const;
+
+    // Conversion operator overload.
+    virtual operator unsigned long() const;
+
+    // Override for string conversion.
+    virtual std::string ToString() const;
+
+    // Conversion operator overload.
+    virtual operator std::string() const;
+
+    // Calculates the highest decimal point precision this object can represent.
+    unsigned int GetHighestDecimalPrecision();
+
+    // Calculates the highest whole number precision this object can represent.
+    unsigned int GetHighestWholePrecision();
+
+    // Gets the maximum value for this object.
+    long long GetMaximumValue();
+
+    // Gets the minimum value for this object.
+    long long GetMinimumValue();
+
+    // Gets the smallest value representable by this object.
+    long double GetSmallestValue();
+
+    // This helps calculate the required precision the core data value needs.
+    unsigned int CalculateRequiredDataPrecision();
+};
+
+/*******************************************************************************
+
+    \brief  Constructor
+
+*******************************************************************************/
+inline energy::energy()
+{}
+
+/*******************************************************************************
+
+    \brief  Copy constructor
+
+*******************************************************************************/
+inline energy::energy(const energy & origBaseEnergy)
+{
+    // Save our data to this object.
+    SetData(origBaseEnergy.GetData());
+}
+
+/*******************************************************************************
+
+    \brief  Destructor
+
+*******************************************************************************/
+inline energy::~energy()
+{}
+
+/*******************************************************************************
+
+    \brief  Addition operator overload.
+
+    \param  const energy & - energy to be operated with.
+
+    \return energy - Copy of this object.
+
+*******************************************************************************/
+inline energy energy::operator+(const energy & rhs) const
+{
+    // Create an object to do our calculations.
+    energy retObj;
+
+    // Do our addition and set our data.
+    retObj.SetData(GetData() + rhs.GetData());
+
+    // Return our result.
+    return retObj;
+}
+
+/*******************************************************************************
+
+    \brief  Subtraction operator overload.
+
+    \param  const energy & - energy to be operated with.
+
+    \return energy - Copy of this object.
+
+*******************************************************************************/
+inline energy energy::operator-(const energy & rhs) const
+{
+    // Create an object to do our calculations.
+    energy retObj;
+
+    // Do our subtraction and set our data.
+    retObj.SetData(GetData() - rhs.GetData());
+
+    // Return our result.
+    return retObj;
+}
+
+/*******************************************************************************
+
+    \brief  Addition increment operator overload.
+
+    \param  const energy & - energy to be operated with.
+
+    \return energy - Copy of this object.
+
+*******************************************************************************/
+inline energy energy::operator+=(const energy & rhs)
+{
+    // Do our addition and set our data.
+    SetData(GetData() + rhs.GetData());
+
+    // Return our result.
+    return (*this);
+}
+
+/*******************************************************************************
+
+    \brief  Subtraction increment operator overload.
+
+    \param  const energy & - energy to be operated with.
+
+    \return energy - Copy of this object.
+
+*******************************************************************************/
+inline energy energy::operator-=(const energy & rhs)
+{
+    // Do our subtraction and set our data.
+    SetData(GetData() - rhs.GetData());
+
+    // Return our result.
+    return (*this);
+}
+
+/*******************************************************************************
+
+    \brief  Equality operator overload.
+
+    \param  const energy & - energy to be operated with.
+
+    \return energy - Copy of this object.
+
+*******************************************************************************/
+inline bool energy::operator==(const energy & rhs) const
+{
+    return GetData() == rhs.GetData();
+}
+
+/*******************************************************************************
+
+    \brief  Inequality operator overload.
+
+    \param  const energy & - energy to be operated with.
+
+    \return energy - Copy of this object.
+
+*******************************************************************************/
+inline bool energy::operator!=(const energy & rhs) const
+{
+    return !(*this == rhs);
+}
+
+/*******************************************************************************
+
+    \brief  Greater-or-equal-than operator overload.
+
+    \param  const energy & - energy to be operated with.
+
+    \return bool - True if comparison is correct, false if not.
+
+*******************************************************************************/
+inline bool energy::operator>=(const energy & rhs) const
+{
+    return ((*this > rhs) || (*this == rhs));
+}
+
+/*******************************************************************************
+
+    \brief  Less-or-equal-than operator overload.
+
+    \param  const energy & - energy to be operated with.
+
+    \return bool - True if comparison is correct, false if not.
+
+*******************************************************************************/
+inline bool energy::operator<=(const energy & rhs) const
+{
+    return ((*this < rhs) || (*this == rhs));
+}
+
+/*******************************************************************************
+
+    \brief  Greater operator overload.
+
+    \param  const energy & - energy to be operated with.
+
+    \return bool - True if comparison is correct, false if not.
+
+*******************************************************************************/
+inline bool energy::operator>(const energy & rhs) const
+{
+    return (GetData() > rhs.GetData());
+}
+
+/*******************************************************************************
+
+    \brief  Less operator overload.
+
+    \param  const energy & - energy to be operated with.
+
+    \return bool - True if comparison is correct, false if not.
+
+*******************************************************************************/
+inline bool energy::operator<(const energy & rhs) const
+{
+    return (GetData() < rhs.GetData());
+}
+
+/*******************************************************************************
+
+    \brief  The child class must define this for conversions.
+
+    \return double - Returns the object conversion ratio.
+                        i.e. 1 millimeter is equal to 10 coreunits.
+                        So the millimeter object would return 10.
+
+*******************************************************************************/
+inline double energy::GetCoreUnitConversion() const
+{
+    // Return a default value.
+    return 1.0;
+}
+
+/*******************************************************************************
+
+    \brief  Assignment operator overload.
+
+    \param  const energy & - energy to be operated with.
+
+    \return energy - Copy of this object.
+
+*******************************************************************************/
+inline energy energy::operator=(const energy & rhs)
+{
+    // Save our data to this object.
+    SetData(rhs.GetData());
+
+    // Return this a copy of this object back to the client.
+    return (*this);
+}
+
+/*******************************************************************************
+
+    \brief  Assignment operator overload.
+
+    \param  const energy & - energy to be operated with.
+
+    \return energy - Copy of this object.
+
+*******************************************************************************/
+inline energy energy::operator=(const double & rhs)
+{
+    // Calculate our convertion to core units, and save to our object.
+    SetData(rhs * GetCoreUnitConversion());
+
+    // Return this a copy of this object back to the client.
+    return (*this);
+}
+
+/*******************************************************************************
+
+    \brief  String of the whole number representation of the data.
+
+    \return string - String representation of this object.
+
+*******************************************************************************/
+inline std::string energy::ToString() const
+{
+    long double out = (long double) GetData() /
+                      (long double) GetCoreUnitConversion();
+
+    // Use string stream to convert and format the double properly.
+    std::ostringstream localstream;
+    localstream << std::setprecision(10) << out;
+
+    return localstream.str();
+}
+
+/*******************************************************************************
+
+    \brief  operator overload.
+
+    \param  energy & - energy to be operated with.
+
+    \return string - String representation of this object.
+
+*******************************************************************************/
+inline energy::operator std::string() const
+{
+    return ToString();
+}
+
+/*******************************************************************************
+
+    \brief  Conversion operator overload.
+
+    \return double - double representation of this object.
+
+*******************************************************************************/
+inline energy::operator double() const
+{
+    return (double) GetData() / (double) GetCoreUnitConversion();
+}
+
+/*******************************************************************************
+
+    \brief  Conversion operator overload.
+
+    \return int - integer representation of this object.
+
+*******************************************************************************/
+inline energy::operator int() const
+{
+    return static_cast<int>(static_cast<double>(*this));
+}
+
+/*******************************************************************************
+
+    \brief  Conversion operator overload.
+
+    \return unsigned long - integer representation of this object
+                               in long datatype.
+
+*******************************************************************************/
+inline energy::operator unsigned long() const
+{
+    return static_cast<unsigned long>(static_cast<double>(*this));
+}
+
+/*******************************************************************************
+
+    \brief  Number of decimal significant digits this number can hold.
+
+    \return unsigned int - Highest number of decimal significant digits.
+
+*******************************************************************************/
+inline unsigned int energy::GetHighestDecimalPrecision()
+{
+    // Calculate the smallest number representable by this object.
+    long double smallest = GetSmallestValue();
+    long double precision = 0.0L;
+
+    // Increment precision until we get a whole number.
+    while((int) (smallest * (long double) pow(10.0L, precision)) <= 0)
+    {
+        ++precision;
+    }
+
+    // The precision is one less then the number of decimal places.
+    // e.g. if the smallest number is 0.003 then you can only accurately
+    // represent two decimal places. Before this calculation, precision is
+    // one decimal place higher then it should be.
+    precision = precision > 0.0L ? precision - 1 : 0.0L;
+
+    return (unsigned int) precision;
+}
+
+/*******************************************************************************
+
+    \brief  Number of whole number significant digits this number can hold.
+
+    \return unsigned int - Highest number of significant digits.
+
+*******************************************************************************/
+inline unsigned int energy::GetHighestWholePrecision()
+{
+    // Calculate the largest number representable by this object.
+    long double largest = (long double) GetMaxDataValue() /
+                          (long double) GetCoreUnitConversion();
+
+    long double precision = 0.0L;
+
+    // Increment precision until we get a whole number.
+    while((long long)(largest / (long double) pow(10.0L, precision)) > 0)
+    {
+        ++precision;
+    }
+
+    return (unsigned int) precision;
+}
+
+/*******************************************************************************
+
+    \brief  Gets the maximum representable value.
+
+    \return long long - Highest representable value.
+
+*******************************************************************************/
+inline long long energy::GetMaximumValue()
+{
+    // Calculate the largest number representable by this object.
+    long double largest = (long double) GetMaxDataValue() /
+                          (long double) GetCoreUnitConversion();
+
+    return (long long) largest;
+}
+
+/*******************************************************************************
+
+    \brief  Gets the minimum representable value.
+
+    \return long long - Lowest representable value.
+
+*******************************************************************************/
+inline long long energy::GetMinimumValue()
+{
+    // Calculate the lowest number representable by this object.
+    long double lowest = (long double) GetMinDataValue() /
+                         (long double) GetCoreUnitConversion();
+
+    return (long long) lowest;
+}
+
+/*******************************************************************************
+
+    \brief  Gets the smallest representable value.
+
+    \return long double - Smallest representable value.
+
+*******************************************************************************/
+inline long double energy::GetSmallestValue()
+{
+    // Calculate the smallest number representable by this object.
+    long double smallest =  1.0L / (long double) GetCoreUnitConversion();
+
+    return smallest;
+}
+
+/*******************************************************************************
+
+    \brief  Decimal places the core data needs so the smallest value of
+            this unit converts to core units exactly.
+
+    \return unsigned int - The value that the unit precision should be set to.
+
+*******************************************************************************/
+inline unsigned int energy::CalculateRequiredDataPrecision()
+{
+    // Get the smallest number at the highest precision representable.
+    double smallest = pow(10.0, (double) GetHighestDecimalPrecision() * -1.0);
+
+    // The decimal places of the smallest value in core units.
+    double smallest_core = smallest * GetCoreUnitConversion();
+
+    std::ostringstream local_stream;
+
+    local_stream << std::setprecision(20) << smallest_core;
+    std::string smallest_core_str = local_stream.str();
+
+    unsigned int unit_precision_counter = 0;
+
+    // Use a flag to signal a decimal point has been located.
+    bool decimal_found = false;
+
+    // Run though the string and find any numbers after the decimal point.
+    for(unsigned int i = 0 ; i < smallest_core_str.size() ; ++i)
+    {
+        // Increment the counter only if the decimal was located.
+        if(decimal_found) ++unit_precision_counter;
+
+        // Set the flag if we run into a decimal point.
+        decimal_found |= (smallest_core_str.at(i) == '.');
+    }
+
+    return unit_precision_counter;
+}
+}
+
+#endif
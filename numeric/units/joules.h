@@ -0,0 +1,108 @@
+/*******************************************************************************
+
+    \file   joules.h
+
+    \brief  Class declaration for a unit of energy.
+
+*******************************************************************************/
+
+#ifndef JOULES_H
+#define JOULES_H
+
+// General Dependancies.
+#include "energy.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  Class for a declaration for joules.
+
+    \brief  Concrete class for a measurable energy unit.
+
+*******************************************************************************/
+class joules : public energy
+{
+public:
+
+    // Constructor.
+    joules();
+
+    // Copy Constructor.
+    joules(const joules & origJoules);
+
+    // Decimal number constructor.
+    joules(const double & decimalNumber);
+
+    // Base energy constructor.
+    joules(const energy & origBaseEnergy);
+
+    // Destructor.
+    virtual ~joules();
+
+    // The child class must define this for conversions.
+    virtual double GetCoreUnitConversion() const;
+};
+
+/*******************************************************************************
+
+    \brief  Constructor
+
+*******************************************************************************/
+inline joules::joules()
+{}
+
+/*******************************************************************************
+
+    \brief  Copy constructor
+
+*******************************************************************************/
+inline joules::joules(const joules & origJoules)
+    : energy(origJoules)
+{}
+
+/*******************************************************************************
+
+    \brief  Decimal constructor.
+
+*******************************************************************************/
+inline joules::joules(const double & decimalNumber)
+{
+    // Use our assignment operator to assign ourself.
+    SetData(decimalNumber * GetCoreUnitConversion());
+}
+
+/*******************************************************************************
+
+    \brief  Base energy constructor.
+
+*******************************************************************************/
+inline joules::joules(const energy & origBaseEnergy)
+    : energy(origBaseEnergy)
+{}
+
+/*******************************************************************************
+
+    \brief  Destructor
+
+*******************************************************************************/
+inline joules::~joules()
+{}
+
+/*******************************************************************************
+
+    \brief  The child class must define this for conversions.
+
+*******************************************************************************/
+inline double joules::GetCoreUnitConversion() const
+{
+    // Number of microjoules in a joule.
+    const long double ujToJ = 1000000.0L;
+
+    // Return our conversion.
+    return ((long double) CORE_UNITS_TO_ONE_MICROJOULE * ujToJ);
+}
+}
+
+#endif
+
@@ -0,0 +1,105 @@
+/*******************************************************************************
+
+    \file   kilocalories.h
+
+    \brief  Class declaration for a unit of energy.
+
+*******************************************************************************/
+
+#ifndef KILOCALORIES_H
+#define KILOCALORIES_H
+
+// General Dependancies.
+#include "energy.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  Class for a declaration for kilocalories.
+
+    \brief  Concrete class for a measurable energy unit.
+
+*******************************************************************************/
+class kilocalories : public energy
+{
+public:
+
+    // Constructor.
+    kilocalories();
+
+    // Copy Constructor.
+    kilocalories(const kilocalories & origKilocalories);
+
+    // Decimal number constructor.
+    kilocalories(const double & decimalNumber);
+
+    // Base energy constructor.
+    kilocalories(const energy & origBaseEnergy);
+
+    // Destructor.
+    virtual ~kilocalories();
+
+    // The child class must define this for conversions.
+    virtual double GetCoreUnitConversion() const;
+};
+
+/*******************************************************************************
+
+    \brief  Constructor
+
+*******************************************************************************/
+inline kilocalories::kilocalories()
+{}
+
+/*******************************************************************************
+
+    \brief  Copy constructor
+
+*******************************************************************************/
+inline kilocalories::kilocalories(const kilocalories & origKilocalories)
+    : energy(origKilocalories)
+{}
+
+/*******************************************************************************
+
+    \brief  Decimal constructor.
+
+*******************************************************************************/
+inline kilocalories::kilocalories(const double & decimalNumber)
+{
+    // Use our assignment operator to assign ourself.
+    SetData(decimalNumber * GetCoreUnitConversion());
+}
+
+/*******************************************************************************
+
+    \brief  Base energy constructor.
+
+*******************************************************************************/
+inline kilocalories::kilocalories(const energy & origBaseEnergy)
+    : energy(origBaseEnergy)
+{}
+
+/*******************************************************************************
+
+    \brief  Destructor
+
+*******************************************************************************/
+inline kilocalories::~kilocalories()
+{}
+
+/*******************************************************************************
+
+    \brief  The child class must define this for conversions.
+
+*******************************************************************************/
+inline double kilocalories::GetCoreUnitConversion() const
+{
+    // Return our conversion.
+    return ((long double) CORE_UNITS_TO_ONE_KILOCALORIE);
+}
+}
+
+#endif
+
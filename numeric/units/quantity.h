@@ -0,0 +1,649 @@
+/*******************************************************************************
+
+    \file   quantity.h
+
+    \brief  Compact, dynamically typed measurement.
+
+            any_quantity holds the raw core integer of any unit family with a
+            dimension tag and a unit id, in 16 bytes and without a vptr.  The
+            core is always in the family's core units, so changing the unit
+            a quantity is shown in never touches the core.  A concrete unit
+            object is only built on the stack when the quantity is visited.
+
+*******************************************************************************/
+
+#ifndef QUANTITY_H
+#define QUANTITY_H
+
+// Standard Library Dependancies.
+#include <string>
+#include <exception>
+
+// General Dependancies.
+#include "days.h"
+#include "feet.h"
+#include "mass.h"
+#include "time.h"
+#include "hours.h"
+#include "miles.h"
+#include "power.h"
+#include "speed.h"
+#include "watts.h"
+#include "energy.h"
+#include "inches.h"
+#include "joules.h"
+#include "kmpace.h"
+#include "length.h"
+#include "meters.h"
+#include "pounds.h"
+#include "minutes.h"
+#include "seconds.h"
+#include "milepace.h"
+#include "kilograms.h"
+#include "kilometers.h"
+#include "centimeters.h"
+#include "millimeters.h"
+#include "kilocalories.h"
+#include "milesperhour.h"
+#include "milliseconds.h"
+#include "kilometersperhour.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \brief  Unit families a quantity can belong to.
+
+*******************************************************************************/
+enum TDimension
+{
+    DIMENSION_NONE,
+    DIMENSION_LENGTH,
+    DIMENSION_MASS,
+    DIMENSION_TIME,
+    DIMENSION_SPEED,
+    DIMENSION_ENERGY,
+    DIMENSION_POWER
+};
+
+/*******************************************************************************
+
+    \brief  Concrete units a quantity can be shown in.
+
+*******************************************************************************/
+enum TUnitId
+{
+    UNIT_NONE,
+    UNIT_INCHES,
+    UNIT_FEET,
+    UNIT_MILLIMETERS,
+    UNIT_CENTIMETERS,
+    UNIT_METERS,
+    UNIT_KILOMETERS,
+    UNIT_MILES,
+    UNIT_POUNDS,
+    UNIT_KILOGRAMS,
+    UNIT_MILLISECONDS,
+    UNIT_SECONDS,
+    UNIT_MINUTES,
+    UNIT_HOURS,
+    UNIT_DAYS,
+    UNIT_KMPACE,
+    UNIT_MILEPACE,
+    UNIT_MPH,
+    UNIT_KPH,
+    UNIT_JOULES,
+    UNIT_KILOCALORIES,
+    UNIT_WATTS
+};
+
+/*******************************************************************************
+
+    \brief  Maps a concrete unit type to its dimension and unit id.  Only the
+            specializations below are defined.
+
+*******************************************************************************/
+template<class unitType>
+struct quantity_traits;
+
+#define QUANTITY_TRAITS(unitType, unitFamily, dimensionTag, unitTag)          \
+template<>                                                                    \
+struct quantity_traits<unitType>                                              \
+{                                                                             \
+    typedef unitFamily TFamily;                                               \
+    static TDimension GetDimension() { return dimensionTag; }                 \
+    static TUnitId GetUnitId() { return unitTag; }                            \
+};
+
+QUANTITY_TRAITS(inches, length, DIMENSION_LENGTH, UNIT_INCHES)
+QUANTITY_TRAITS(feet, length, DIMENSION_LENGTH, UNIT_FEET)
+QUANTITY_TRAITS(millimeters, length, DIMENSION_LENGTH, UNIT_MILLIMETERS)
+QUANTITY_TRAITS(centimeters, length, DIMENSION_LENGTH, UNIT_CENTIMETERS)
+QUANTITY_TRAITS(meters, length, DIMENSION_LENGTH, UNIT_METERS)
+QUANTITY_TRAITS(kilometers, length, DIMENSION_LENGTH, UNIT_KILOMETERS)
+QUANTITY_TRAITS(miles, length, DIMENSION_LENGTH, UNIT_MILES)
+QUANTITY_TRAITS(pounds, mass, DIMENSION_MASS, UNIT_POUNDS)
+QUANTITY_TRAITS(kilograms, mass, DIMENSION_MASS, UNIT_KILOGRAMS)
+QUANTITY_TRAITS(milliseconds, time, DIMENSION_TIME, UNIT_MILLISECONDS)
+QUANTITY_TRAITS(seconds, time, DIMENSION_TIME, UNIT_SECONDS)
+QUANTITY_TRAITS(minutes, time, DIMENSION_TIME, UNIT_MINUTES)
+QUANTITY_TRAITS(hours, time, DIMENSION_TIME, UNIT_HOURS)
+QUANTITY_TRAITS(days, time, DIMENSION_TIME, UNIT_DAYS)
+QUANTITY_TRAITS(kmpace, time, DIMENSION_TIME, UNIT_KMPACE)
+QUANTITY_TRAITS(milepace, time, DIMENSION_TIME, UNIT_MILEPACE)
+QUANTITY_TRAITS(mph, speed, DIMENSION_SPEED, UNIT_MPH)
+QUANTITY_TRAITS(kph, speed, DIMENSION_SPEED, UNIT_KPH)
+QUANTITY_TRAITS(joules, energy, DIMENSION_ENERGY, UNIT_JOULES)
+QUANTITY_TRAITS(kilocalories, energy, DIMENSION_ENERGY, UNIT_KILOCALORIES)
+QUANTITY_TRAITS(watts, power, DIMENSION_POWER, UNIT_WATTS)
+
+#undef QUANTITY_TRAITS
+
+/*******************************************************************************
+
+    \class  any_quantity
+
+    \brief  A measurement whose unit is only known at runtime.
+
+*******************************************************************************/
+class any_quantity
+{
+public:
+
+    // Constructor, an empty quantity.
+    any_quantity() : core(0), dimension(DIMENSION_NONE), unit(UNIT_NONE) {}
+
+    // Creates a quantity from a concrete unit.
+    template<class unitType>
+    static any_quantity From(const unitType & value)
+    {
+        any_quantity quantity;
+        quantity.core = value.GetData().GetRawData();
+        quantity.dimension = (unsigned char)
+            quantity_traits<unitType>::GetDimension();
+        quantity.unit = (unsigned char) quantity_traits<unitType>::GetUnitId();
+        return quantity;
+    }
+
+    // Creates a quantity from a raw core integer.
+    static any_quantity FromCore(TUnitId unitId, long long coreData)
+    {
+        any_quantity quantity;
+        quantity.core = coreData;
+        quantity.dimension = (unsigned char) GetUnitDimension(unitId);
+        quantity.unit = (unsigned char) unitId;
+        quantity.CheckRange(coreData);
+        return quantity;
+    }
+
+    // Gets the dimension of this quantity.
+    TDimension GetDimension() const
+    {
+        return (TDimension) dimension;
+    }
+
+    // Gets the unit this quantity is shown in.
+    TUnitId GetUnitId() const
+    {
+        return (TUnitId) unit;
+    }
+
+    // Gets the raw core integer.
+    long long GetCoreData() const
+    {
+        return core;
+    }
+
+    // True if the quantity holds nothing.
+    bool IsEmpty() const
+    {
+        return dimension == DIMENSION_NONE;
+    }
+
+    // Same quantity shown in another unit of the same dimension.
+    any_quantity ConvertTo(TUnitId unitId) const;
+
+    // Calls visitor(unitObject) with the concrete unit object.
+    template<class TVisitor>
+    void Visit(TVisitor & visitor) const;
+
+    // Value expressed in this quantity's unit.
+    double ToDouble() const;
+
+    // String of the value expressed in this quantity's unit.
+    std::string ToString() const;
+
+    // Addition, the result is shown in the left hand unit.
+    any_quantity operator+(const any_quantity & rhs) const;
+
+    // Subtraction, the result is shown in the left hand unit.
+    any_quantity operator-(const any_quantity & rhs) const;
+
+    // Addition increment operator overload.
+    any_quantity & operator+=(const any_quantity & rhs);
+
+    // Subtraction increment operator overload.
+    any_quantity & operator-=(const any_quantity & rhs);
+
+    // Equality operator overload, compares the physical amount.
+    bool operator==(const any_quantity & rhs) const;
+
+    // Inequality operator overload.
+    bool operator!=(const any_quantity & rhs) const;
+
+    // Less operator overload.
+    bool operator<(const any_quantity & rhs) const;
+
+    // Greater operator overload.
+    bool operator>(const any_quantity & rhs) const;
+
+    // Gets the dimension a unit id belongs to.
+    static TDimension GetUnitDimension(TUnitId unitId);
+
+private:
+
+    // Throws if the two quantities are not of the same dimension.
+    void CheckDimension(const any_quantity & rhs) const;
+
+    // Throws if the core is outside of what the family's decimal can hold.
+    void CheckRange(long long coreData) const;
+
+    // Raw core integer of the unit family.
+    long long core;
+
+    // TDimension of the quantity.
+    unsigned char dimension;
+
+    // TUnitId of the quantity.
+    unsigned char unit;
+};
+
+// The record layout is part of the interface, catch any growth at compile
+// time.
+typedef char any_quantity_size_check[sizeof(any_quantity) == 16 ? 1 : -1];
+
+/*******************************************************************************
+
+    \brief  Gets the dimension a unit id belongs to.
+
+    \param  TUnitId - Unit id.
+
+    \return TDimension - Dimension of the unit.
+
+*******************************************************************************/
+inline TDimension any_quantity::GetUnitDimension(TUnitId unitId)
+{
+    switch(unitId)
+    {
+    case UNIT_INCHES:
+    case UNIT_FEET:
+    case UNIT_MILLIMETERS:
+    case UNIT_CENTIMETERS:
+    case UNIT_METERS:
+    case UNIT_KILOMETERS:
+    case UNIT_MILES:
+        return DIMENSION_LENGTH;
+
+    case UNIT_POUNDS:
+    case UNIT_KILOGRAMS:
+        return DIMENSION_MASS;
+
+    case UNIT_MILLISECONDS:
+    case UNIT_SECONDS:
+    case UNIT_MINUTES:
+    case UNIT_HOURS:
+    case UNIT_DAYS:
+    case UNIT_KMPACE:
+    case UNIT_MILEPACE:
+        return DIMENSION_TIME;
+
+    case UNIT_MPH:
+    case UNIT_KPH:
+        return DIMENSION_SPEED;
+
+    case UNIT_JOULES:
+    case UNIT_KILOCALORIES:
+        return DIMENSION_ENERGY;
+
+    case UNIT_WATTS:
+        return DIMENSION_POWER;
+
+    default:
+        return DIMENSION_NONE;
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Same quantity shown in another unit of the same dimension.
+
+    \param  TUnitId - Unit to show the quantity in.
+
+    \return any_quantity - Converted quantity.
+
+*******************************************************************************/
+inline any_quantity any_quantity::ConvertTo(TUnitId unitId) const
+{
+    // The core is already in family core units, only the tag changes.
+    if(GetUnitDimension(unitId) != dimension) throw std::exception();
+
+    any_quantity converted = *this;
+    converted.unit = (unsigned char) unitId;
+    return converted;
+}
+
+/*******************************************************************************
+
+    \brief  Calls visitor(unitObject) with the concrete unit object.  The
+            visitor needs an operator() for every unit type, or for the
+            family base classes.
+
+    \param  TVisitor & - Visitor to call.
+
+*******************************************************************************/
+template<class TVisitor>
+inline void any_quantity::Visit(TVisitor & visitor) const
+{
+#define QUANTITY_VISIT(unitTag, unitType, unitPrecision)                      \
+    case unitTag:                                                             \
+    {                                                                         \
+        decimal<unitPrecision> data;                                          \
+        data.SetRawData(core);                                                \
+        unitType value;                                                       \
+        value.SetData(data);                                                  \
+        visitor(value);                                                       \
+        break;                                                                \
+    }
+
+    switch(unit)
+    {
+    QUANTITY_VISIT(UNIT_INCHES, inches, LENGTH_PRECISION)
+    QUANTITY_VISIT(UNIT_FEET, feet, LENGTH_PRECISION)
+    QUANTITY_VISIT(UNIT_MILLIMETERS, millimeters, LENGTH_PRECISION)
+    QUANTITY_VISIT(UNIT_CENTIMETERS, centimeters, LENGTH_PRECISION)
+    QUANTITY_VISIT(UNIT_METERS, meters, LENGTH_PRECISION)
+    QUANTITY_VISIT(UNIT_KILOMETERS, kilometers, LENGTH_PRECISION)
+    QUANTITY_VISIT(UNIT_MILES, miles, LENGTH_PRECISION)
+    QUANTITY_VISIT(UNIT_POUNDS, pounds, MASS_PRECISION)
+    QUANTITY_VISIT(UNIT_KILOGRAMS, kilograms, MASS_PRECISION)
+    QUANTITY_VISIT(UNIT_MILLISECONDS, milliseconds, TIME_PRECISION)
+    QUANTITY_VISIT(UNIT_SECONDS, seconds, TIME_PRECISION)
+    QUANTITY_VISIT(UNIT_MINUTES, minutes, TIME_PRECISION)
+    QUANTITY_VISIT(UNIT_HOURS, hours, TIME_PRECISION)
+    QUANTITY_VISIT(UNIT_DAYS, days, TIME_PRECISION)
+    QUANTITY_VISIT(UNIT_KMPACE, kmpace, TIME_PRECISION)
+    QUANTITY_VISIT(UNIT_MILEPACE, milepace, TIME_PRECISION)
+    QUANTITY_VISIT(UNIT_MPH, mph, SPEED_PRECISION)
+    QUANTITY_VISIT(UNIT_KPH, kph, SPEED_PRECISION)
+    QUANTITY_VISIT(UNIT_JOULES, joules, ENERGY_PRECISION)
+    QUANTITY_VISIT(UNIT_KILOCALORIES, kilocalories, ENERGY_PRECISION)
+    QUANTITY_VISIT(UNIT_WATTS, watts, POWER_PRECISION)
+
+    default:
+        // Nothing to visit in an empty quantity.
+        throw std::exception();
+    }
+
+#undef QUANTITY_VISIT
+}
+
+/*******************************************************************************
+
+    \brief  Visitor that reads the value of a unit object as a double.
+
+*******************************************************************************/
+struct any_quantity_double_visitor
+{
+    // Constructor.
+    any_quantity_double_visitor() : result(0.0) {}
+
+    // Reads the value through the unit's own conversion operator.
+    template<class unitType>
+    void operator()(const unitType & value)
+    {
+        result = (double) value;
+    }
+
+    // The value read.
+    double result;
+};
+
+/*******************************************************************************
+
+    \brief  Value expressed in this quantity's unit.
+
+    \return double - Value of the quantity.
+
+*******************************************************************************/
+inline double any_quantity::ToDouble() const
+{
+    any_quantity_double_visitor visitor;
+    Visit(visitor);
+    return visitor.result;
+}
+
+/*******************************************************************************
+
+    \brief  Visitor that reads the value of a unit object as a string.
+
+*******************************************************************************/
+struct any_quantity_string_visitor
+{
+    // Reads the value through the family's string conversion.
+    template<class unitType>
+    void operator()(const unitType & value)
+    {
+        result = (std::string) value;
+    }
+
+    // The value read.
+    std::string result;
+};
+
+/*******************************************************************************
+
+    \brief  String of the value expressed in this quantity's unit.
+
+    \return string - String representation of this object.
+
+*******************************************************************************/
+inline std::string any_quantity::ToString() const
+{
+    any_quantity_string_visitor visitor;
+    Visit(visitor);
+    return visitor.result;
+}
+
+/*******************************************************************************
+
+    \brief  Throws if the two quantities are not of the same dimension.
+
+*******************************************************************************/
+inline void any_quantity::CheckDimension(const any_quantity & rhs) const
+{
+    if(dimension != rhs.dimension || dimension == DIMENSION_NONE)
+    {
+        throw std::exception();
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Throws if the core is outside of what the family's decimal can
+            hold, the same bound the unit objects enforce.
+
+*******************************************************************************/
+inline void any_quantity::CheckRange(long long coreData) const
+{
+    long long lowest = 0;
+    long long highest = 0;
+
+    switch(dimension)
+    {
+    case DIMENSION_LENGTH:
+        lowest = decimal<LENGTH_PRECISION>::GetMinValue();
+        highest = decimal<LENGTH_PRECISION>::GetMaxValue();
+        break;
+    case DIMENSION_MASS:
+        lowest = decimal<MASS_PRECISION>::GetMinValue();
+        highest = decimal<MASS_PRECISION>::GetMaxValue();
+        break;
+    case DIMENSION_TIME:
+        lowest = decimal<TIME_PRECISION>::GetMinValue();
+        highest = decimal<TIME_PRECISION>::GetMaxValue();
+        break;
+    case DIMENSION_SPEED:
+        lowest = decimal<SPEED_PRECISION>::GetMinValue();
+        highest = decimal<SPEED_PRECISION>::GetMaxValue();
+        break;
+    case DIMENSION_ENERGY:
+        lowest = decimal<ENERGY_PRECISION>::GetMinValue();
+        highest = decimal<ENERGY_PRECISION>::GetMaxValue();
+        break;
+    case DIMENSION_POWER:
+        lowest = decimal<POWER_PRECISION>::GetMinValue();
+        highest = decimal<POWER_PRECISION>::GetMaxValue();
+        break;
+    default:
+        throw std::exception();
+    }
+
+    // If we throw an exception here, we over/underflowed.
+    if(coreData > highest || coreData < lowest) throw std::exception();
+}
+
+/*******************************************************************************
+
+    \brief  Addition operator overload.
+
+    \param  const any_quantity & - Quantity of the same dimension.
+
+    \return any_quantity - Sum, shown in the left hand unit.
+
+*******************************************************************************/
+inline any_quantity any_quantity::operator+(const any_quantity & rhs) const
+{
+    any_quantity retObj = *this;
+    retObj += rhs;
+    return retObj;
+}
+
+/*******************************************************************************
+
+    \brief  Subtraction operator overload.
+
+    \param  const any_quantity & - Quantity of the same dimension.
+
+    \return any_quantity - Difference, shown in the left hand unit.
+
+*******************************************************************************/
+inline any_quantity any_quantity::operator-(const any_quantity & rhs) const
+{
+    any_quantity retObj = *this;
+    retObj -= rhs;
+    return retObj;
+}
+
+/*******************************************************************************
+
+    \brief  Addition increment operator overload.
+
+    \param  const any_quantity & - Quantity of the same dimension.
+
+    \return any_quantity & - Reference to this object.
+
+*******************************************************************************/
+inline any_quantity & any_quantity::operator+=(const any_quantity & rhs)
+{
+    CheckDimension(rhs);
+
+    // The family bound is far from the long long limits, so the sum itself
+    // cannot overflow before it is checked.
+    const long long sum = core + rhs.core;
+    CheckRange(sum);
+
+    core = sum;
+    return *this;
+}
+
+/*******************************************************************************
+
+    \brief  Subtraction increment operator overload.
+
+    \param  const any_quantity & - Quantity of the same dimension.
+
+    \return any_quantity & - Reference to this object.
+
+*******************************************************************************/
+inline any_quantity & any_quantity::operator-=(const any_quantity & rhs)
+{
+    CheckDimension(rhs);
+
+    const long long difference = core - rhs.core;
+    CheckRange(difference);
+
+    core = difference;
+    return *this;
+}
+
+/*******************************************************************************
+
+    \brief  Equality operator overload.
+
+    \param  const any_quantity & - Quantity of the same dimension.
+
+    \return bool - True if both quantities are the same physical amount.
+
+*******************************************************************************/
+inline bool any_quantity::operator==(const any_quantity & rhs) const
+{
+    CheckDimension(rhs);
+    return core == rhs.core;
+}
+
+/*******************************************************************************
+
+    \brief  Inequality operator overload.
+
+    \param  const any_quantity & - Quantity of the same dimension.
+
+    \return bool - True if the quantities are different physical amounts.
+
+*******************************************************************************/
+inline bool any_quantity::operator!=(const any_quantity & rhs) const
+{
+    return !(*this == rhs);
+}
+
+/*******************************************************************************
+
+    \brief  Less operator overload.
+
+    \param  const any_quantity & - Quantity of the same dimension.
+
+    \return bool - True if comparison is correct, false if not.
+
+*******************************************************************************/
+inline bool any_quantity::operator<(const any_quantity & rhs) const
+{
+    CheckDimension(rhs);
+    return core < rhs.core;
+}
+
+/*******************************************************************************
+
+    \brief  Greater operator overload.
+
+    \param  const any_quantity & - Quantity of the same dimension.
+
+    \return bool - True if comparison is correct, false if not.
+
+*******************************************************************************/
+inline bool any_quantity::operator>(const any_quantity & rhs) const
+{
+    CheckDimension(rhs);
+    return core > rhs.core;
+}
+}
+
+#endif
@@ -0,0 +1,287 @@
+/*******************************************************************************
+
+    \file   quantity_table.h
+
+    \brief  Columnar table of dynamically typed measurements.
+
+            Each column is one contiguous vector of 16 byte any_quantity
+            records, so a column can hold lengths in one row and durations in
+            the next, and scanning a column streams through memory without any
+            per element allocation.
+
+*******************************************************************************/
+
+#ifndef QUANTITY_TABLE_H
+#define QUANTITY_TABLE_H
+
+// Standard Library Dependancies.
+#include <string>
+#include <vector>
+#include <exception>
+
+// General Dependancies.
+#include "quantity.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  quantity_table
+
+    \brief  Rows of measurements stored column by column.
+
+*******************************************************************************/
+class quantity_table
+{
+public:
+
+    // Constructor.
+    quantity_table(const std::vector<std::string> & columnNames);
+
+    // Destructor.
+    virtual ~quantity_table();
+
+    // Reserves room for the given number of rows in every column.
+    void Reserve(size_t rowCount);
+
+    // Appends a row of empty quantities, returns the row index.
+    size_t AddRow();
+
+    // Appends a row, one quantity per column, returns the row index.
+    size_t AddRow(const std::vector<any_quantity> & row);
+
+    // Sets one cell.
+    void Set(size_t row, size_t column, const any_quantity & quantity);
+
+    // Gets one cell.
+    const any_quantity & Get(size_t row, size_t column) const;
+
+    // Gets a whole column.
+    const std::vector<any_quantity> & GetColumn(size_t column) const;
+
+    // Gets the index of a column by name.
+    size_t GetColumnIndex(const std::string & columnName) const;
+
+    // Gets the number of rows.
+    size_t GetRowCount() const;
+
+    // Gets the number of columns.
+    size_t GetColumnCount() const;
+
+    // Sums the non empty cells of a column that belong to one dimension.
+    any_quantity Sum(size_t column, TDimension dimension) const;
+
+    // Counts the cells of a column that belong to one dimension.
+    size_t Count(size_t column, TDimension dimension) const;
+
+private:
+
+    // Name of each column.
+    std::vector<std::string> names;
+
+    // The cells, one vector per column.
+    std::vector<std::vector<any_quantity> > columns;
+
+    // Number of rows.
+    size_t rows;
+};
+
+/*******************************************************************************
+
+    \brief  Constructor
+
+    \param  const std::vector<std::string> & - Names of the columns.
+
+*******************************************************************************/
+inline quantity_table::quantity_table(
+    const std::vector<std::string> & columnNames)
+    :
+    names(columnNames),
+    columns(columnNames.size()),
+    rows(0)
+{}
+
+/*******************************************************************************
+
+    \brief  Destructor
+
+*******************************************************************************/
+inline quantity_table::~quantity_table() {}
+
+/*******************************************************************************
+
+    \brief  Reserves room for the given number of rows in every column.
+
+*******************************************************************************/
+inline void quantity_table::Reserve(size_t rowCount)
+{
+    for(size_t i = 0 ; i < columns.size() ; ++i)
+    {
+        columns[i].reserve(rowCount);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Appends a row of empty quantities.
+
+    \return size_t - Index of the new row.
+
+*******************************************************************************/
+inline size_t quantity_table::AddRow()
+{
+    for(size_t i = 0 ; i < columns.size() ; ++i)
+    {
+        columns[i].push_back(any_quantity());
+    }
+
+    return rows++;
+}
+
+/*******************************************************************************
+
+    \brief  Appends a row.
+
+    \param  const std::vector<any_quantity> & - One quantity per column.
+
+    \return size_t - Index of the new row.
+
+*******************************************************************************/
+inline size_t quantity_table::AddRow(const std::vector<any_quantity> & row)
+{
+    if(row.size() != columns.size()) throw std::exception();
+
+    for(size_t i = 0 ; i < columns.size() ; ++i)
+    {
+        columns[i].push_back(row[i]);
+    }
+
+    return rows++;
+}
+
+/*******************************************************************************
+
+    \brief  Sets one cell.
+
+*******************************************************************************/
+inline void quantity_table::Set(size_t row,
+                                size_t column,
+                                const any_quantity & quantity)
+{
+    columns.at(column).at(row) = quantity;
+}
+
+/*******************************************************************************
+
+    \brief  Gets one cell.
+
+*******************************************************************************/
+inline const any_quantity & quantity_table::Get(size_t row,
+                                                size_t column) const
+{
+    return columns.at(column).at(row);
+}
+
+/*******************************************************************************
+
+    \brief  Gets a whole column.
+
+*******************************************************************************/
+inline const std::vector<any_quantity> &
+quantity_table::GetColumn(size_t column) const
+{
+    return columns.at(column);
+}
+
+/*******************************************************************************
+
+    \brief  Gets the index of a column by name.
+
+*******************************************************************************/
+inline size_t quantity_table::GetColumnIndex(
+    const std::string & columnName) const
+{
+    for(size_t i = 0 ; i < names.size() ; ++i)
+    {
+        if(names[i] == columnName) return i;
+    }
+
+    // No such column.
+    throw std::exception();
+}
+
+/*******************************************************************************
+
+    \brief  Gets the number of rows.
+
+*******************************************************************************/
+inline size_t quantity_table::GetRowCount() const
+{
+    return rows;
+}
+
+/*******************************************************************************
+
+    \brief  Gets the number of columns.
+
+*******************************************************************************/
+inline size_t quantity_table::GetColumnCount() const
+{
+    return columns.size();
+}
+
+/*******************************************************************************
+
+    \brief  Sums the cells of a column that belong to one dimension, cells of
+            other dimensions and empty cells are skipped.
+
+    \param  size_t - Column index.
+    \param  TDimension - Dimension to sum.
+
+    \return any_quantity - Sum, empty if no cell matched.
+
+*******************************************************************************/
+inline any_quantity quantity_table::Sum(size_t column,
+                                        TDimension dimension) const
+{
+    const std::vector<any_quantity> & cells = columns.at(column);
+
+    any_quantity total;
+    for(size_t i = 0 ; i < cells.size() ; ++i)
+    {
+        if(cells[i].GetDimension() != dimension) continue;
+
+        // The first match sets the unit the total is shown in.
+        if(total.IsEmpty())
+        {
+            total = cells[i];
+        }
+        else
+        {
+            total += cells[i];
+        }
+    }
+
+    return total;
+}
+
+/*******************************************************************************
+
+    \brief  Counts the cells of a column that belong to one dimension.
+
+*******************************************************************************/
+inline size_t quantity_table::Count(size_t column, TDimension dimension) const
+{
+    const std::vector<any_quantity> & cells = columns.at(column);
+
+    size_t matches = 0;
+    for(size_t i = 0 ; i < cells.size() ; ++i)
+    {
+        matches += cells[i].GetDimension() == dimension ? 1 : 0;
+    }
+
+    return matches;
+}
+}
+
+#endif
@@ -11,12 +11,23 @@
 #ifndef UNIT_MATH_H
 #define UNIT_MATH_H
 
+// Standard Library Depedencies.
+#include <climits>
+#include <algorithm>
+#include <exception>
+
 // General Depedencies.
+#include "mass.h"
 #include "time.h"
+#include "power.h"
 #include "speed.h"
+#include "energy.h"
 #include "inches.h"
 #include "length.h"
 
+// Gross energy cost of moving one kilogram of body mass one kilometer.
+#define KILOCALORIES_PER_KILOGRAM_KILOMETER 1.0L
+
 namespace numeric
 {
 /*******************************************************************************
@@ -160,6 +171,415 @@ inline time operator/(const length & lhs, const speed & rhs)
     // Return a speed object.
     return retTime;
 }
+
+/*******************************************************************************
+
+    \brief  Unsigned integer of up to ACTIVITY_LIMBS 32 bit limbs, least
+            significant first, wide enough for the product of three cores
+            and the factor numerator.  The helpers only touch the limbs in
+            use, the limbs above them are kept zero.
+
+*******************************************************************************/
+enum { ACTIVITY_LIMBS = 8 };
+
+/*******************************************************************************
+
+    \brief  Drops the zero limbs at the top, keeping at least one.
+
+*******************************************************************************/
+inline void ActivityWideTrim(const unsigned int * wide, int & used)
+{
+    while(used > 1 && wide[used - 1] == 0) --used;
+}
+
+/*******************************************************************************
+
+    \brief  Multiplies a wide integer by a 64 bit number in place.
+
+*******************************************************************************/
+inline void ActivityWideMultiply(unsigned int * wide,
+                                 int & used,
+                                 unsigned long long factor)
+{
+    const unsigned long long halves[2] = { factor & 0xFFFFFFFFULL,
+                                           factor >> 32 };
+    const int factorLimbs = halves[1] != 0 ? 2 : 1;
+
+    unsigned int product[ACTIVITY_LIMBS] = { 0 };
+    for(int h = 0 ; h < factorLimbs ; ++h)
+    {
+        unsigned long long carry = 0;
+        for(int i = 0 ; i < used && i + h < ACTIVITY_LIMBS ; ++i)
+        {
+            const unsigned long long limb =
+                (unsigned long long) wide[i] * halves[h] +
+                product[i + h] + carry;
+
+            product[i + h] = (unsigned int) limb;
+            carry = limb >> 32;
+        }
+
+        if(used + h < ACTIVITY_LIMBS) product[used + h] = (unsigned int) carry;
+    }
+
+    used = std::min(used + factorLimbs, (int) ACTIVITY_LIMBS);
+    for(int i = 0 ; i < used ; ++i) wide[i] = product[i];
+    ActivityWideTrim(wide, used);
+}
+
+/*******************************************************************************
+
+    \brief  Adds a wide integer to another in place.
+
+*******************************************************************************/
+inline void ActivityWideAdd(unsigned int * wide,
+                            int & used,
+                            const unsigned int * addend,
+                            int addendUsed)
+{
+    const int limbs = std::max(used, addendUsed);
+
+    unsigned long long carry = 0;
+    for(int i = 0 ; i < limbs ; ++i)
+    {
+        const unsigned long long limb =
+            (unsigned long long) wide[i] + addend[i] + carry;
+
+        wide[i] = (unsigned int) limb;
+        carry = limb >> 32;
+    }
+
+    used = limbs;
+    if(carry != 0 && used < ACTIVITY_LIMBS) wide[used++] = (unsigned int) carry;
+}
+
+/*******************************************************************************
+
+    \brief  Divides a wide integer by a power of ten in place, rounding
+            toward zero.  The divisor is a template argument so the
+            compiler can turn each division into a multiplication.
+
+*******************************************************************************/
+template<unsigned int divisor>
+inline void ActivityWideDivide(unsigned int * wide, int & used)
+{
+    unsigned long long remainder = 0;
+    for(int i = used - 1 ; i >= 0 ; --i)
+    {
+        const unsigned long long limb = (remainder << 32) | wide[i];
+
+        wide[i] = (unsigned int) (limb / divisor);
+        remainder = limb % divisor;
+    }
+
+    ActivityWideTrim(wide, used);
+}
+
+/*******************************************************************************
+
+    \brief  Divides a wide integer by 10^digits in place, rounding toward
+            zero.
+
+*******************************************************************************/
+inline void ActivityWideDivideByTen(unsigned int * wide,
+                                    int & used,
+                                    int digits)
+{
+    for( ; digits >= 9 ; digits -= 9)
+    {
+        ActivityWideDivide<1000000000u>(wide, used);
+    }
+
+    switch(digits)
+    {
+    case 1: ActivityWideDivide<10u>(wide, used); break;
+    case 2: ActivityWideDivide<100u>(wide, used); break;
+    case 3: ActivityWideDivide<1000u>(wide, used); break;
+    case 4: ActivityWideDivide<10000u>(wide, used); break;
+    case 5: ActivityWideDivide<100000u>(wide, used); break;
+    case 6: ActivityWideDivide<1000000u>(wide, used); break;
+    case 7: ActivityWideDivide<10000000u>(wide, used); break;
+    case 8: ActivityWideDivide<100000000u>(wide, used); break;
+    default: break;
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Magnitude of a core, without overflow for the most negative one.
+
+*******************************************************************************/
+inline unsigned long long ActivityMagnitude(long long core)
+{
+    return core < 0 ? 0ULL - (unsigned long long) core
+                    : (unsigned long long) core;
+}
+
+/*******************************************************************************
+
+    \brief  Rounds the product of the factors over 10^digits to a core.
+
+            The product is kept exactly and divided with one rounding at
+            the end, half away from zero like the decimal type, so every
+            caller gets the correctly rounded core.
+
+    \param  const unsigned long long * - Factor magnitudes.
+    \param  int - Number of factors.
+    \param  bool - True if the result is negative.
+    \param  int - Decimal digits of the denominator.
+
+    \return long long - Rounded core data.
+
+    \note   Throws if the result does not fit a core.
+
+*******************************************************************************/
+inline long long ActivityWideRound(const unsigned long long * factors,
+                                   int count,
+                                   bool negative,
+                                   int digits)
+{
+    unsigned int wide[ACTIVITY_LIMBS] = { 1 };
+    int used = 1;
+    for(int f = 0 ; f < count ; ++f)
+    {
+        if(factors[f] != 1) ActivityWideMultiply(wide, used, factors[f]);
+    }
+
+    if(digits > 0)
+    {
+        // Dropping all but the last digit first is exact, what it drops
+        // can never carry the last digit past a half, so adding five and
+        // dropping the last digit rounds half away from zero.
+        unsigned int five[ACTIVITY_LIMBS] = { 5 };
+        ActivityWideDivideByTen(wide, used, digits - 1);
+        ActivityWideAdd(wide, used, five, 1);
+        ActivityWideDivide<10u>(wide, used);
+    }
+
+    if(used > 2) throw std::exception();
+
+    const unsigned long long magnitude =
+        ((unsigned long long) wide[1] << 32) | wide[0];
+    if(magnitude > (unsigned long long) LLONG_MAX) throw std::exception();
+
+    return negative ? -(long long) magnitude : (long long) magnitude;
+}
+
+/*******************************************************************************
+
+    \brief  Muliplies a power object with a time object, resulting in an
+            energy object.
+
+            power * time = energy.
+
+               microwatt core * time core
+               / 10^(3 + POWER_PRECISION + TIME_PRECISION - ENERGY_PRECISION)
+               = microjoule core
+
+            The 3 is milliseconds per second.
+
+    \param  const time & - Elapsed time the power was sustained.
+
+    \return energy - The resulting energy object from the operation.
+
+    \note   Throws if the result does not fit a core, or if the core units
+            of power, time and energy are not microwatts, milliseconds and
+            microjoules.
+
+*******************************************************************************/
+inline energy operator*(const power & lhs, const time & rhs)
+{
+    if(CORE_UNITS_TO_ONE_MICROWATT != 1 ||
+       CORE_UNITS_TO_ONE_MILLISECOND != 1 ||
+       CORE_UNITS_TO_ONE_MICROJOULE != 1) throw std::exception();
+
+    const long long powerCore = lhs.GetData().GetRawData();
+    const long long timeCore = rhs.GetData().GetRawData();
+    const unsigned long long factors[2] = { ActivityMagnitude(powerCore),
+                                            ActivityMagnitude(timeCore) };
+
+    decimal<ENERGY_PRECISION> data;
+    data.SetRawData(ActivityWideRound(factors,
+                                      2,
+                                      (powerCore < 0) != (timeCore < 0),
+                                      3 + (int) POWER_PRECISION +
+                                      (int) TIME_PRECISION -
+                                      (int) ENERGY_PRECISION));
+
+    energy retEnergy;
+    retEnergy.SetData(data);
+
+    return retEnergy;
+}
+
+/*******************************************************************************
+
+    \brief  Muliplies a time object with a power object, resulting in an
+            energy object.
+
+            time * power = energy.
+
+    \param  const power & - Power sustained over the elapsed time.
+
+    \return energy - The resulting energy object from the operation.
+
+*******************************************************************************/
+inline energy operator*(const time & lhs, const power & rhs)
+{
+    return rhs * lhs;
+}
+
+/*******************************************************************************
+
+    \brief  operator overload.
+
+               energy
+               ------ = power
+                time
+
+    \param  const time & - Time object to divide by.
+
+    \return power - The resulting power object from the operation.
+
+*******************************************************************************/
+inline power operator/(const energy & lhs, const time & rhs)
+{
+    const long double msInOneSec = 1000.0L;
+
+    // microjoules / seconds = microwatts.
+    power retPower;
+    retPower.SetData((long double) lhs.GetData() * msInOneSec /
+                     (long double) rhs.GetData());
+
+    return retPower;
+}
+
+/*******************************************************************************
+
+    \brief  operator overload.
+
+               energy
+               ------ = time
+               power
+
+    \param  const power & - Power object to divide by.
+
+    \return time - The resulting time object from the operation.
+
+*******************************************************************************/
+inline time operator/(const energy & lhs, const power & rhs)
+{
+    const long double msInOneSec = 1000.0L;
+
+    // microjoules / microwatts = seconds.
+    time retTime;
+    retTime.SetData((long double) lhs.GetData() * msInOneSec /
+                    (long double) rhs.GetData());
+
+    return retTime;
+}
+
+/*******************************************************************************
+
+    \brief  Energy spent moving a body mass at a speed for a time.
+
+            mass * speed * time * KILOCALORIES_PER_KILOGRAM_KILOMETER
+
+            Mass times distance is not an energy by itself, the locomotion
+            cost per kilogram and kilometer supplies the missing dimension.
+            The cores are used directly:
+
+               mass core * speed core * time core
+               * CORE_UNITS_TO_ONE_KILOCALORIE * 254
+               / 10^(1 + 9 + 6 + 3 + SPEED_PRECISION + TIME_PRECISION)
+               = microjoules
+
+            The 254 / 10 is millimeters per inch, then come micrograms per
+            kilogram, millimeters per kilometer, milliseconds per second and
+            the decimal places of the speed and time cores.
+
+    \param  const mass & - Body mass.
+    \param  const speed & - Average speed.
+    \param  const time & - Elapsed time.
+
+    \return energy - Energy spent.
+
+    \note   Throws if the result does not fit a core, or if
+            KILOCALORIES_PER_KILOGRAM_KILOMETER is not whole or the core
+            units are not the ones above.
+
+*******************************************************************************/
+inline energy ActivityEnergy(const mass & bodyMass,
+                             const speed & avgSpeed,
+                             const time & elapsed)
+{
+    const long double kilocalories = KILOCALORIES_PER_KILOGRAM_KILOMETER;
+    if(kilocalories != (long double) (unsigned long long) kilocalories ||
+       CORE_UNITS_TO_INCH_PER_SECOND != 1 ||
+       CORE_UNITS_TO_ONE_MILLISECOND != 1 ||
+       CORE_UNITS_TO_ONE_MICROJOULE != 1 ||
+       MASS_PRECISION != 0) throw std::exception();
+
+    const long long cores[3] = { bodyMass.GetData().GetRawData(),
+                                 avgSpeed.GetData().GetRawData(),
+                                 elapsed.GetData().GetRawData() };
+    const unsigned long long factors[5] =
+    {
+        ActivityMagnitude(cores[0]),
+        ActivityMagnitude(cores[1]),
+        ActivityMagnitude(cores[2]),
+        (unsigned long long) kilocalories * CORE_UNITS_TO_ONE_KILOCALORIE,
+        254ULL
+    };
+    const bool negative = (cores[0] < 0) != ((cores[1] < 0) != (cores[2] < 0));
+
+    decimal<ENERGY_PRECISION> data;
+    data.SetRawData(ActivityWideRound(factors,
+                                      5,
+                                      negative,
+                                      1 + 9 + 6 + 3 +
+                                      (int) SPEED_PRECISION +
+                                      (int) TIME_PRECISION -
+                                      (int) ENERGY_PRECISION));
+
+    energy retEnergy;
+    retEnergy.SetData(data);
+
+    return retEnergy;
+}
+
+/*******************************************************************************
+
+    \brief  Power sustained moving a body mass at a speed, the energy of
+            one second.  Rounded once, like ActivityEnergy().
+
+    \param  const mass & - Body mass.
+    \param  const speed & - Average speed.
+
+    \return power - Power sustained.
+
+    \note   Throws if the result does not fit a core.
+
+*******************************************************************************/
+inline power ActivityPower(const mass & bodyMass, const speed & avgSpeed)
+{
+    // Energy is in microjoules, over one second it is microwatts.
+    if(CORE_UNITS_TO_ONE_MICROWATT != 1 ||
+       ENERGY_PRECISION != POWER_PRECISION) throw std::exception();
+
+    // One second, the time core is in milliseconds.
+    time oneSecond;
+    oneSecond.SetData(1000.0L * CORE_UNITS_TO_ONE_MILLISECOND);
+
+    const energy spent = ActivityEnergy(bodyMass, avgSpeed, oneSecond);
+    decimal<POWER_PRECISION> data;
+    data.SetRawData(spent.GetData().GetRawData());
+
+    power retPower;
+    retPower.SetData(data);
+
+    return retPower;
+}
 }
 
 #endif
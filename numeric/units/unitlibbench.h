@@ -0,0 +1,550 @@
+/*******************************************************************************
+
+    \file   unitlibbench.h
+
+    \brief  Executes a throughput benchmark on the library.
+
+            Every concrete unit is run through the same operations the unit
+            library test checks (construction from a double, conversion to
+            the parent and back, +, -, comparison, ToString) and the unit_math
+            operators are timed on their own.  A scaling pass then works on
+            growing vectors of units.  The results are written as JSON so
+            runs can be compared when the unit hierarchy changes.
+
+            Heap allocations are only counted when
+            UNITLIBBENCH_COUNT_ALLOCATIONS is defined before this header is
+            included, in exactly one translation unit, see
+            allocation_counter.h.  Otherwise allocations are reported as
+            null.
+
+*******************************************************************************/
+
+#ifndef UNITLIBBENCH_H
+#define UNITLIBBENCH_H
+
+// Standard Library Dependancies.
+#include <ctime>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <ostream>
+#include <sstream>
+#include <algorithm>
+
+#ifdef _WIN32
+   #include <windows.h>
+#endif
+
+// General Dependancies.
+#include "../../numeric.h"
+#include "../allocation_counter.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \brief  Number of heap allocations made since the program started.
+
+*******************************************************************************/
+inline unsigned long long UnitLibBenchAllocationCount()
+{
+    return BenchAllocationCount();
+}
+
+/*******************************************************************************
+
+    \brief  True when the global operator new is counting allocations.
+
+*******************************************************************************/
+inline bool UnitLibBenchCountsAllocations()
+{
+    return BenchCountsAllocations();
+}
+
+/*******************************************************************************
+
+    \class  CUnitLibBenchTimer
+
+    \brief  Monotonic stopwatch with nanosecond resolution where available.
+
+*******************************************************************************/
+class CUnitLibBenchTimer
+{
+public:
+
+    // Constructor.
+    CUnitLibBenchTimer() : startTime(0.0) {}
+
+    // Starts the stopwatch.
+    void Start()
+    {
+        startTime = Now();
+    }
+
+    // Nanoseconds since the stopwatch was started.
+    double ElapsedNanoseconds() const
+    {
+        return Now() - startTime;
+    }
+
+private:
+
+    // Current time in nanoseconds.
+    static double Now()
+    {
+#ifdef _WIN32
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        return (double) counter.QuadPart * 1e9 / (double) frequency.QuadPart;
+#else
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (double) now.tv_sec * 1e9 + (double) now.tv_nsec;
+#endif
+    }
+
+    // Time the stopwatch was started.
+    double startTime;
+};
+
+/*******************************************************************************
+
+    \class  CUnitLibBenchReport
+
+    \brief  Collects the benchmark results and writes them as JSON.
+
+*******************************************************************************/
+class CUnitLibBenchReport
+{
+public:
+
+    // Constructor.
+    CUnitLibBenchReport() : sink(0.0) {}
+
+    // Starts timing an operation.
+    void Start()
+    {
+        allocationsAtStart = UnitLibBenchAllocationCount();
+        timer.Start();
+    }
+
+    // Stops timing an operation and records the result.  The names are
+    // taken as they are passed, a literal is only copied into a string
+    // after the clock and the allocation count have been read.
+    template<class unitNameType, class familyNameType, class operationType>
+    void Stop(const unitNameType & unitName,
+              const familyNameType & familyName,
+              const operationType & operation,
+              unsigned long operations)
+    {
+        const double nanoseconds = timer.ElapsedNanoseconds();
+        const unsigned long long allocations =
+            UnitLibBenchAllocationCount() - allocationsAtStart;
+
+        Record record;
+        record.nanoseconds = nanoseconds;
+        record.allocations = allocations;
+        record.unitName = unitName;
+        record.familyName = familyName;
+        record.operation = operation;
+        record.operations = operations == 0 ? 1 : operations;
+        records.push_back(record);
+    }
+
+    // Keeps results alive so the compiler cannot remove the timed work.
+    void Consume(double value)
+    {
+        sink += value;
+    }
+
+    // Writes all of the records as a JSON document.
+    void Write(std::ostream & out) const
+    {
+        out << "{\n  \"count_allocations\": "
+            << (UnitLibBenchCountsAllocations() ? "true" : "false")
+            << ",\n  \"results\": [";
+
+        for(size_t i = 0 ; i < records.size() ; ++i)
+        {
+            const Record & record = records[i];
+            const double nsPerOp = record.nanoseconds /
+                                   (double) record.operations;
+
+            out << (i == 0 ? "\n" : ",\n")
+                << "    {\"unit\": \"" << record.unitName
+                << "\", \"family\": \"" << record.familyName
+                << "\", \"op\": \"" << record.operation
+                << "\", \"ops\": " << record.operations
+                << ", \"ns_per_op\": " << nsPerOp
+                << ", \"ops_per_sec\": "
+                << (nsPerOp > 0.0 ? 1e9 / nsPerOp : 0.0)
+                << ", \"allocs_per_op\": ";
+
+            if(UnitLibBenchCountsAllocations())
+            {
+                out << (double) record.allocations / (double) record.operations;
+            }
+            else
+            {
+                out << "null";
+            }
+
+            out << "}";
+        }
+
+        out << "\n  ]\n}\n";
+    }
+
+private:
+
+    // One timed operation.
+    struct Record
+    {
+        std::string unitName;
+        std::string familyName;
+        std::string operation;
+        unsigned long operations;
+        unsigned long long allocations;
+        double nanoseconds;
+    };
+
+    // Stopwatch for the current operation.
+    CUnitLibBenchTimer timer;
+
+    // Allocation count when the current operation started.
+    unsigned long long allocationsAtStart;
+
+    // All of the recorded operations.
+    std::vector<Record> records;
+
+    // Result sink, volatile so the optimizer keeps the timed loops.
+    volatile double sink;
+};
+
+/*******************************************************************************
+
+    \brief  Constructs a unit from a double.  Pace units only construct from
+            a time object, they are specialized below.
+
+*******************************************************************************/
+template<class unitType>
+inline unitType UnitLibBenchConstruct(double value)
+{
+    return unitType(value);
+}
+
+template<>
+inline kmpace UnitLibBenchConstruct<kmpace>(double value)
+{
+    return kmpace(minutes(value));
+}
+
+template<>
+inline milepace UnitLibBenchConstruct<milepace>(double value)
+{
+    return milepace(minutes(value));
+}
+
+/*******************************************************************************
+
+    \brief  Small value used for the i-th operation.  The speed family only
+            holds a few inches per second, so every unit is fed values well
+            inside that range.
+
+*******************************************************************************/
+inline double UnitLibBenchValue(unsigned long i)
+{
+    return 0.25 + (double) (i & 7) * 0.001;
+}
+
+/*******************************************************************************
+
+    \class  CUnitLibBench
+
+    \brief  Benchmarks the operations that CUnitLibTest checks.
+
+*******************************************************************************/
+template<class unitType, class unitParent>
+class CUnitLibBench
+{
+public:
+
+    // Constructor.
+    CUnitLibBench(const std::string & unit, const std::string & family)
+        : unitName(unit), familyName(family) {}
+
+    // Destructor.
+    virtual ~CUnitLibBench() {}
+
+    // Execute the per operation benchmark.
+    void Run(CUnitLibBenchReport & report, unsigned long iterations);
+
+    // Execute the container scaling benchmark.
+    void RunScaling(CUnitLibBenchReport & report, unsigned long maxSize);
+
+private:
+
+    // Name of the concrete unit.
+    std::string unitName;
+
+    // Name of the unit family.
+    std::string familyName;
+};
+
+/*******************************************************************************
+
+    \brief  Run
+
+*******************************************************************************/
+template<class unitType, class unitParent>
+inline void CUnitLibBench<unitType, unitParent>::Run(
+    CUnitLibBenchReport & report,
+    unsigned long iterations)
+{
+    unsigned long i;
+
+    // Operands are built up front so only the operation itself is timed.
+    std::vector<unitType> lhs, rhs;
+    lhs.reserve(8);
+    rhs.reserve(8);
+    for(i = 0 ; i < 8 ; ++i)
+    {
+        const double value = UnitLibBenchValue(i);
+        lhs.push_back(UnitLibBenchConstruct<unitType>(value));
+        rhs.push_back(UnitLibBenchConstruct<unitType>(value + 0.003));
+    }
+
+    /*** Construction ***/
+    report.Start();
+    for(i = 0 ; i < iterations ; ++i)
+    {
+        unitType constructed =
+            UnitLibBenchConstruct<unitType>(UnitLibBenchValue(i));
+        report.Consume((double) constructed);
+    }
+    report.Stop(unitName, familyName, "construct", iterations);
+
+    /*** Conversion to the parent and back ***/
+    report.Start();
+    for(i = 0 ; i < iterations ; ++i)
+    {
+        unitParent parent = lhs[i & 7];
+        unitType converted = parent;
+        report.Consume((double) converted);
+    }
+    report.Stop(unitName, familyName, "convert", iterations);
+
+    /*** Addition ***/
+    report.Start();
+    for(i = 0 ; i < iterations ; ++i)
+    {
+        unitParent sum = lhs[i & 7] + rhs[i & 7];
+        report.Consume((double) sum);
+    }
+    report.Stop(unitName, familyName, "add", iterations);
+
+    /*** Subtraction ***/
+    report.Start();
+    for(i = 0 ; i < iterations ; ++i)
+    {
+        unitParent difference = lhs[i & 7] - rhs[i & 7];
+        report.Consume((double) difference);
+    }
+    report.Stop(unitName, familyName, "subtract", iterations);
+
+    /*** Comparison ***/
+    report.Start();
+    unsigned long lessCount = 0;
+    for(i = 0 ; i < iterations ; ++i)
+    {
+        lessCount += (lhs[i & 7] < rhs[(i + 1) & 7]) ? 1 : 0;
+        lessCount += (lhs[i & 7] == rhs[(i + 5) & 7]) ? 1 : 0;
+    }
+    report.Consume((double) lessCount);
+    report.Stop(unitName, familyName, "compare", iterations * 2);
+
+    /*** String conversion ***/
+    report.Start();
+    for(i = 0 ; i < iterations ; ++i)
+    {
+        std::string text = lhs[i & 7].ToString();
+        report.Consume((double) text.size());
+    }
+    report.Stop(unitName, familyName, "to_string", iterations);
+}
+
+/*******************************************************************************
+
+    \brief  RunScaling
+
+*******************************************************************************/
+template<class unitType, class unitParent>
+inline void CUnitLibBench<unitType, unitParent>::RunScaling(
+    CUnitLibBenchReport & report,
+    unsigned long maxSize)
+{
+    for(unsigned long size = 1000 ; size <= maxSize ; size *= 10)
+    {
+        std::ostringstream suffix;
+        suffix << "_" << size;
+
+        // Labels are built before timing so their allocations are not
+        // counted.
+        const std::string fillLabel = "bulk_fill" + suffix.str();
+        const std::string reduceLabel = "bulk_reduce" + suffix.str();
+        const std::string sortLabel = "bulk_sort" + suffix.str();
+
+        /*** Fill a container ***/
+        report.Start();
+        std::vector<unitType> container;
+        for(unsigned long i = 0 ; i < size ; ++i)
+        {
+            container.push_back(
+                UnitLibBenchConstruct<unitType>(UnitLibBenchValue(i * 7)));
+        }
+        report.Stop(unitName, familyName, fillLabel, size);
+
+        /*** Reduce a container ***/
+        report.Start();
+        double total = 0.0;
+        for(unsigned long i = 0 ; i < size ; ++i)
+        {
+            total += (double) container[i];
+        }
+        report.Consume(total);
+        report.Stop(unitName, familyName, reduceLabel, size);
+
+        /*** Sort a container ***/
+        report.Start();
+        std::sort(container.begin(), container.end());
+        report.Consume((double) container[0]);
+        report.Stop(unitName, familyName, sortLabel, size);
+    }
+}
+
+/*******************************************************************************
+
+    \brief  Benchmarks the unit_math operators.
+
+*******************************************************************************/
+inline void ExecuteUnitMathBenchmark(CUnitLibBenchReport & report,
+                                     unsigned long iterations)
+{
+    unsigned long i;
+
+    report.Start();
+    for(i = 0 ; i < iterations ; ++i)
+    {
+        length distance = mph(UnitLibBenchValue(i)) * minutes(10);
+        report.Consume((double) distance);
+    }
+    report.Stop("unit_math", "length", "speed_times_time", iterations);
+
+    report.Start();
+    for(i = 0 ; i < iterations ; ++i)
+    {
+        speed pace = miles(UnitLibBenchValue(i)) / hours(2);
+        report.Consume((double) pace);
+    }
+    report.Stop("unit_math", "speed", "length_over_time", iterations);
+
+    report.Start();
+    for(i = 0 ; i < iterations ; ++i)
+    {
+        time elapsed = miles(UnitLibBenchValue(i)) / mph(0.5);
+        report.Consume((double) elapsed);
+    }
+    report.Stop("unit_math", "time", "length_over_speed", iterations);
+
+    report.Start();
+    for(i = 0 ; i < iterations ; ++i)
+    {
+        energy spent = watts(UnitLibBenchValue(i)) * minutes(1);
+        report.Consume((double) spent);
+    }
+    report.Stop("unit_math", "energy", "power_times_time", iterations);
+
+    report.Start();
+    for(i = 0 ; i < iterations ; ++i)
+    {
+        power rate = joules(UnitLibBenchValue(i)) / seconds(2);
+        report.Consume((double) rate);
+    }
+    report.Stop("unit_math", "power", "energy_over_time", iterations);
+
+    report.Start();
+    for(i = 0 ; i < iterations ; ++i)
+    {
+        energy spent = ActivityEnergy(kilograms(70),
+                                      kph(UnitLibBenchValue(i)),
+                                      hours(1));
+        report.Consume((double) spent);
+    }
+    report.Stop("unit_math", "energy", "activity_energy", iterations);
+}
+
+/*******************************************************************************
+
+    \brief  ExecuteUnitLibraryBenchmark
+
+    \param  std::ostream & - Stream the JSON results are written to.
+    \param  unsigned long - Number of times each operation is timed.
+    \param  unsigned long - Largest container for the scaling pass, zero
+                            skips the scaling pass.
+
+*******************************************************************************/
+inline void ExecuteUnitLibraryBenchmark(std::ostream & out,
+                                        unsigned long iterations = 100000,
+                                        unsigned long scalingSize = 100000)
+{
+    CUnitLibBenchReport report;
+
+#define UNITLIBBENCH_RUN(unitType, unitParent)                                \
+    {                                                                         \
+        CUnitLibBench<unitType, unitParent> bench(#unitType, #unitParent);    \
+        bench.Run(report, iterations);                                        \
+        if(scalingSize != 0) bench.RunScaling(report, scalingSize);           \
+    }
+
+    /*** Length ***/
+    UNITLIBBENCH_RUN(inches, length)
+    UNITLIBBENCH_RUN(feet, length)
+    UNITLIBBENCH_RUN(millimeters, length)
+    UNITLIBBENCH_RUN(centimeters, length)
+    UNITLIBBENCH_RUN(meters, length)
+    UNITLIBBENCH_RUN(kilometers, length)
+    UNITLIBBENCH_RUN(miles, length)
+
+    /*** Mass ***/
+    UNITLIBBENCH_RUN(pounds, mass)
+    UNITLIBBENCH_RUN(kilograms, mass)
+
+    /*** Time ***/
+    UNITLIBBENCH_RUN(milliseconds, time)
+    UNITLIBBENCH_RUN(seconds, time)
+    UNITLIBBENCH_RUN(minutes, time)
+    UNITLIBBENCH_RUN(hours, time)
+    UNITLIBBENCH_RUN(days, time)
+    UNITLIBBENCH_RUN(kmpace, time)
+    UNITLIBBENCH_RUN(milepace, time)
+
+    /*** Speed ***/
+    UNITLIBBENCH_RUN(mph, speed)
+    UNITLIBBENCH_RUN(kph, speed)
+
+    /*** Energy and Power ***/
+    UNITLIBBENCH_RUN(joules, energy)
+    UNITLIBBENCH_RUN(kilocalories, energy)
+    UNITLIBBENCH_RUN(watts, power)
+
+#undef UNITLIBBENCH_RUN
+
+    /*** Unit Math ***/
+    ExecuteUnitMathBenchmark(report, iterations);
+
+    report.Write(out);
+}
+}
+
+#endif
@@ -304,6 +304,133 @@ inline void CUnitLibTest<unitType, unitParent>::Test()
     assert(unitBaseLengthTest == baseClassConvTest);
 }
 
+/*******************************************************************************
+ 
+    \brief  Energy and power units, and the activity helpers.
+ 
+*******************************************************************************/
+inline void ExecuteEnergyTest()
+{
+    /*** Energy Test Suite ***/
+    CUnitLibTest<joules, energy> joulesTestObj;
+    joulesTestObj.Test();
+    assert(kilocalories(1) == joules(4184));
+
+    CUnitLibTest<kilocalories, energy> kcalTestObj;
+    kcalTestObj.Test();
+
+    /*** Power Test Suite ***/
+    CUnitLibTest<watts, power> wattsTestObj;
+    wattsTestObj.Test();
+    assert(watts(100) * seconds(60) == joules(6000));
+    assert(joules(6000) / minutes(1) == watts(100));
+    assert(hours(1) == hours(joules(360000) / watts(100)));
+
+    // Half a microjoule rounds away from zero, less than half rounds down.
+    const power microwatt = watts(0.000001);
+    const power negative = watts(-0.000001);
+    assert((microwatt * milliseconds(500)).GetData().GetRawData() == 1);
+    assert((negative * milliseconds(500)).GetData().GetRawData() == -1);
+    assert((microwatt * milliseconds(499)).GetData().GetRawData() == 0);
+
+    // Running a kilometer burns about a kilocalorie per kilogram.
+    energy oneKmEnergy = ActivityEnergy(kilograms(70), kph(0.5), hours(2));
+    assert(fabs((double) kilocalories(oneKmEnergy) - 70.0) < 1e-6);
+
+    // The exact product of the cores is rounded once, and a sign change
+    // only changes the sign.
+    for(int i = 0 ; i < 1000 ; ++i)
+    {
+        const mass bodyMass = kilograms(40 + i % 80);
+        const speed avgSpeed = kph(0.05 + (i % 300) / 1000.0);
+        const time elapsed = minutes(1 + i % 120);
+        const long long spent =
+            ActivityEnergy(bodyMass, avgSpeed, elapsed).GetData().GetRawData();
+
+        const long double expected =
+            (long double) bodyMass.GetData().GetRawData() *
+            (long double) avgSpeed.GetData().GetRawData() *
+            (long double) elapsed.GetData().GetRawData() *
+            4184000000.0L * 254.0L / 1e31L;
+        assert(fabs((long double) spent - expected) <= 0.5L + 1e-3L);
+
+        const energy negated =
+            ActivityEnergy(kilograms(-40 - i % 80), avgSpeed, elapsed);
+        assert(negated.GetData().GetRawData() == -spent);
+    }
+
+    // Power is the energy of one second.
+    assert(ActivityPower(kilograms(70), kph(0.3)).GetData().GetRawData() ==
+           ActivityEnergy(kilograms(70), kph(0.3), seconds(1))
+               .GetData().GetRawData());
+}
+
+/*******************************************************************************
+ 
+    \brief  Civil date conversions.
+ 
+*******************************************************************************/
+inline void ExecuteCalendarTest()
+{
+    /*** Calendar Test Suite ***/
+    assert(DaysFromCivil(1970, 1, 1) == 0);
+    assert(DaysFromCivil(2000, 3, 1) == 11017);
+    assert(CivilFromDays(-1) == civildate(1969, 12, 31));
+    assert(CivilFromDays(19782) == civildate(2024, 2, 29));
+    assert(Weekday(0) == 4);
+    assert(WeekKey(-3) == 0 && WeekKey(-4) == -1);
+    assert(MonthKey(DaysFromCivil(2024, 2, 29)) == 2024 * 12 + 1);
+
+    for(long long z = -800000 ; z < 800000 ; z += 37)
+    {
+        civildate date = CivilFromDays(z);
+        assert(DaysFromCivil(date.year, date.month, date.day) == z);
+    }
+
+    assert(DayNumber(days(5) + hours(23)) == 5);
+    assert(DayNumber(days(0) - hours(1)) == -1);
+    assert(DayNumber(days(3), 19779) == 19782);
+    assert(DaysFromDayNumber(19782, 19779) == days(3));
+}
+
+/*******************************************************************************
+ 
+    \brief  Type erased quantities and the quantity table.
+ 
+*******************************************************************************/
+inline void ExecuteQuantityTest()
+{
+    /*** Quantity Test Suite ***/
+    any_quantity oneMileQuantity = any_quantity::From(miles(1));
+    any_quantity oneHourQuantity = any_quantity::From(hours(1));
+    assert(oneMileQuantity.GetDimension() == DIMENSION_LENGTH);
+    assert(oneMileQuantity.ConvertTo(UNIT_FEET).ToDouble() == 5280.0);
+    assert(oneMileQuantity == any_quantity::From(feet(5280)));
+    assert(oneHourQuantity + any_quantity::From(minutes(30)) ==
+           any_quantity::From(minutes(90)));
+
+    bool mixedDimensionThrew = false;
+    try
+    {
+        oneMileQuantity + oneHourQuantity;
+    }
+    catch(...)
+    {
+        mixedDimensionThrew = true;
+    }
+    assert(mixedDimensionThrew);
+
+    std::vector<std::string> columnNames(1, "value");
+    quantity_table telemetry(columnNames);
+    telemetry.AddRow(std::vector<any_quantity>(1, oneMileQuantity));
+    telemetry.AddRow(std::vector<any_quantity>(1, oneHourQuantity));
+    telemetry.AddRow(std::vector<any_quantity>(1,
+                                               any_quantity::From(feet(10))));
+    assert(telemetry.Count(0, DIMENSION_LENGTH) == 2);
+    assert(telemetry.Sum(0, DIMENSION_LENGTH) ==
+           any_quantity::From(feet(5290)));
+}
+
 /*******************************************************************************
  
     \brief  ExecuteUnitLibraryTest
@@ -311,6 +438,12 @@ inline void CUnitLibTest<unitType, unitParent>::Test()
 *******************************************************************************/
 void ExecuteUnitLibraryTest()
 {
+    // These suites stand alone, and run before the original suites so a
+    // failure there does not hide them.
+    ExecuteEnergyTest();
+    ExecuteCalendarTest();
+    ExecuteQuantityTest();
+
     /*** Length Test Suite ***/
     CUnitLibTest<inches, length> inchesTestObj;
     inchesTestObj.Test();
@@ -0,0 +1,108 @@
+/*******************************************************************************
+
+    \file   watts.h
+
+    \brief  Class declaration for a unit of power.
+
+*******************************************************************************/
+
+#ifndef WATTS_H
+#define WATTS_H
+
+// General Dependancies.
+#include "power.h"
+
+namespace numeric
+{
+/*******************************************************************************
+
+    \class  Class for a declaration for watts.
+
+    \brief  Concrete class for a measurable power unit.
+
+*******************************************************************************/
+class watts : public power
+{
+public:
+
+    // Constructor.
+    watts();
+
+    // Copy Constructor.
+    watts(const watts & origWatts);
+
+    // Decimal number constructor.
+    watts(const double & decimalNumber);
+
+    // Base power constructor.
+    watts(const power & origBasePower);
+
+    // Destructor.
+    virtual ~watts();
+
+    // The child class must define this for conversions.
+    virtual double GetCoreUnitConversion() const;
+};
+
+/*******************************************************************************
+
+    \brief  Constructor
+
+*******************************************************************************/
+inline watts::watts()
+{}
+
+/*******************************************************************************
+
+    \brief  Copy constructor
+
+*******************************************************************************/
+inline watts::watts(const watts & origWatts)
+    : power(origWatts)
+{}
+
+/*******************************************************************************
+
+    \brief  Decimal constructor.
+
+*******************************************************************************/
+inline watts::watts(const double & decimalNumber)
+{
+    // Use our assignment operator to assign ourself.
+    SetData(decimalNumber * GetCoreUnitConversion());
+}
+
+/*******************************************************************************
+
+    \brief  Base power constructor.
+
+*******************************************************************************/
+inline watts::watts(const power & origBasePower)
+    : power(origBasePower)
+{}
+
+/*******************************************************************************
+
+    \brief  Destructor
+
+*******************************************************************************/
+inline watts::~watts()
+{}
+
+/*******************************************************************************
+
+    \brief  The child class must define this for conversions.
+
+*******************************************************************************/
+inline double watts::GetCoreUnitConversion() const
+{
+    // Number of microwatts in a watt.
+    const long double uwToW = 1000000.0L;
+
+    // Return our conversion.
+    return ((long double) CORE_UNITS_TO_ONE_MICROWATT * uwToW);
+}
+}
+
+#endif
+
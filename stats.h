@@ -8,4 +8,5 @@
  
 *******************************************************************************/ 
 // Include for all stats headers.
+#include "stats/fft.h"
 #include "stats/stats.h"
@@ -0,0 +1,90 @@
+/******************************************************************************/
+//
+/*! \file
+
+    \brief  Radix-2 fast Fourier transform, in place, for the correlations
+            in stats.h.
+
+*******************************************************************************/
+
+#ifndef STATS_FFT_H
+#define STATS_FFT_H
+
+// Standard library dependencies.
+#include <cmath>
+#include <vector>
+#include <complex>
+#include <cstddef>
+#include <exception>
+
+namespace Stats
+{
+/******************************************************************************/
+//
+/*! \brief  Smallest power of two not below size.
+
+*******************************************************************************/
+inline size_t FFTSize(size_t size)
+{
+    size_t power = 1;
+    while(power < size) power <<= 1;
+
+    return power;
+}
+
+/******************************************************************************/
+//
+/*! \brief  Transforms data in place.  The inverse is scaled by 1/N, so an
+            inverse after a forward gives the input back.
+
+    \note   Throws if the size is not a power of two.
+
+*******************************************************************************/
+inline void FFT(std::vector<std::complex<double> > & data, bool inverse)
+{
+    const size_t size = data.size();
+    if(size == 0 || (size & (size - 1)) != 0) throw std::exception();
+
+    // Bit reversed order, so the butterflies work on neighbours.
+    for(size_t i = 1, j = 0 ; i < size ; ++i)
+    {
+        size_t bit = size >> 1;
+        for( ; j & bit ; bit >>= 1) j ^= bit;
+        j ^= bit;
+
+        if(i < j) std::swap(data[i], data[j]);
+    }
+
+    const double pi = 3.14159265358979323846;
+    for(size_t length = 2 ; length <= size ; length <<= 1)
+    {
+        const double angle = (inverse ? 2.0 : -2.0) * pi / (double) length;
+        const size_t half = length / 2;
+
+        for(size_t k = 0 ; k < half ; ++k)
+        {
+            // Each twiddle from its own angle, no drift from repeated
+            // multiplication on long transforms.
+            const std::complex<double> twiddle(std::cos(angle * (double) k),
+                                               std::sin(angle * (double) k));
+
+            for(size_t start = 0 ; start < size ; start += length)
+            {
+                const std::complex<double> even = data[start + k];
+                const std::complex<double> odd = data[start + k + half] *
+                                                 twiddle;
+
+                data[start + k] = even + odd;
+                data[start + k + half] = even - odd;
+            }
+        }
+    }
+
+    if(inverse)
+    {
+        const double scale = 1.0 / (double) size;
+        for(size_t i = 0 ; i < size ; ++i) data[i] *= scale;
+    }
+}
+}
+#endif
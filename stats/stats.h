@@ -14,31 +14,60 @@
 // Standard library dependencies.
 #include <cmath>
 #include <vector>
+#include <complex>
+#include <cstddef>
 #include <algorithm>
 
+#include "fft.h"
+
+// Widest vector kernel the compiler targets, plain loops otherwise.
+#if defined(__AVX2__)
+#define STATS_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || \
+      (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STATS_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+// Samples per run in Correlation(), summed plainly before the runs are
+// added with compensation.
+#define CORRELATION_BLOCK 1024
+
+// Below this many samples in the shorter series CrossCorrelation() always
+// sums directly.
+#define CROSS_CORRELATION_FFT_MIN 32
+
+// Work of the FFT path per N log N, against one product of the direct path.
+#define CROSS_CORRELATION_FFT_COST 48.0
+
 namespace Stats
 {
 /******************************************************************************/
 //
-/*! \brief
+/*! \brief  Cross correlation by the definition, for short series.
+
+            result[n] is the sum of f_func[k] * g_func[k + n] over every k
+            with both in range, for n up to the longer size.  The results
+            are appended to result.
 
 *******************************************************************************/
-void CrossCorrelation(const std::vector<double> & f_func,
-                      const std::vector<double> & g_func,
-                      std::vector<double> & result)
+inline void CrossCorrelationDirect(const std::vector<double> & f_func,
+                                   const std::vector<double> & g_func,
+                                   std::vector<double> & result)
 {
-	long long max_size = std::max(f_func.size(), g_func.size());
+    const size_t max_size = std::max(f_func.size(), g_func.size());
 
-    for(int n = 0 ; n < max_size ; ++n)
+    for(size_t n = 0 ; n < max_size ; ++n)
     {
+        // Only the k that have both f_func[k] and g_func[k + n].
+        const size_t end = n < g_func.size() ?
+                           std::min(f_func.size(), g_func.size() - n) : 0;
+
         double sum = 0.0;
-        for(int k = 0 ; k < max_size ; ++k)
+        for(size_t k = 0 ; k < end ; ++k)
         {
-            try
-            {
-                sum += f_func.at(k) * g_func.at(k + n);
-            }
-            catch(...){}
+            sum += f_func[k] * g_func[k + n];
         }
 
         result.push_back(sum);
@@ -47,65 +76,480 @@ void CrossCorrelation(const std::vector<double> & f_func,
 
 /******************************************************************************/
 //
-/*! \brief
+/*! \brief  Cross correlation through the FFT, same results as
+            CrossCorrelationDirect() to rounding.
+
+            Both series go through one complex transform, f_func as the real
+            part and g_func as the imaginary part, and are separated by
+            symmetry.  The transform is long enough that no lag wraps around
+            onto another.
 
 *******************************************************************************/
-double Correlation(const std::vector<double> & f_func,
-                   const std::vector<double> & g_func)
+inline void CrossCorrelationFFT(const std::vector<double> & f_func,
+                                const std::vector<double> & g_func,
+                                std::vector<double> & result)
 {
-	long long max_size = std::max(f_func.size(), g_func.size());
+    const size_t max_size = std::max(f_func.size(), g_func.size());
+    if(f_func.empty() || g_func.empty())
+    {
+        result.insert(result.end(), max_size, 0.0);
+        return;
+    }
 
-    double sumPaired = 0.0;
-    for(int n = 0 ; n < max_size ; ++n)
+    const size_t size = FFTSize(f_func.size() + g_func.size() - 1);
+
+    std::vector<std::complex<double> > data(size);
+    for(size_t i = 0 ; i < size ; ++i)
     {
-        try
-        {
-            sumPaired += f_func.at(n) * g_func.at(n);
-        }
-        catch(...) {}
+        data[i] = std::complex<double>(i < f_func.size() ? f_func[i] : 0.0,
+                                       i < g_func.size() ? g_func[i] : 0.0);
     }
 
-    double fsum = 0.0;
-    double gsum = 0.0;
-    double fsqed_sums = 0.0;
-    double gsqed_sums = 0.0;
+    FFT(data, false);
 
-    for(int n = 0 ; n < max_size ; ++n)
+    // conj(F) * G, with F and G taken apart from the shared transform.
+    std::vector<std::complex<double> > product(size);
+    for(size_t k = 0 ; k < size ; ++k)
     {
-        try
-        {
-            fsum += f_func.at(n);
-        }
-        catch(...) {}
+        const std::complex<double> z = data[k];
+        const std::complex<double> mirror = std::conj(data[(size - k) &
+                                                           (size - 1)]);
 
-        try
-        {
-            fsqed_sums += f_func.at(n) * f_func.at(n);
-        }
-        catch(...) {}
+        const std::complex<double> f_k = (z + mirror) * 0.5;
+        const std::complex<double> g_k = (z - mirror) *
+                                         std::complex<double>(0.0, -0.5);
 
-        try
-        {
-            gsum += g_func.at(n);
-        }
-        catch(...) {}
+        product[k] = std::conj(f_k) * g_k;
+    }
+
+    FFT(product, true);
+
+    // Lags past the end of g_func have nothing to multiply.
+    for(size_t n = 0 ; n < max_size ; ++n)
+    {
+        result.push_back(n < g_func.size() ? product[n].real() : 0.0);
+    }
+}
+
+/******************************************************************************/
+//
+/*! \brief  Cross correlation of f_func against g_func, appended to result.
+
+            result[n] is the sum of f_func[k] * g_func[k + n] over every k
+            with both in range, for n up to the longer size.  Short series
+            are summed directly, long ones through the FFT, whichever does
+            less work.
+
+*******************************************************************************/
+inline void CrossCorrelation(const std::vector<double> & f_func,
+                             const std::vector<double> & g_func,
+                             std::vector<double> & result)
+{
+    const size_t shorter = std::min(f_func.size(), g_func.size());
+    const size_t size = FFTSize(f_func.size() + g_func.size());
+
+    // Products by the definition against a few transforms of size N log N.
+    const double direct = (double) f_func.size() * (double) g_func.size();
+    const double transform = CROSS_CORRELATION_FFT_COST *
+                             (double) size * std::log((double) size + 1.0);
+
+    if(shorter < CROSS_CORRELATION_FFT_MIN || direct <= transform)
+    {
+        CrossCorrelationDirect(f_func, g_func, result);
+    }
+    else
+    {
+        CrossCorrelationFFT(f_func, g_func, result);
+    }
+}
+
+/******************************************************************************/
+//
+/*! \brief  Adds a value to a running sum, keeping the rounding error of
+            each add in carry (Neumaier).  The sum is sum + carry.
+
+*******************************************************************************/
+inline void CompensatedAdd(double & sum, double & carry, double value)
+{
+    const double total = sum + value;
+    if(std::fabs(sum) >= std::fabs(value))
+    {
+        carry += (sum - total) + value;
+    }
+    else
+    {
+        carry += (value - total) + sum;
+    }
+
+    sum = total;
+}
+
+/******************************************************************************/
+//
+/*! \brief  Plain sums over one short run where both series have values,
+            each less its shift.
+
+            sums gets f * g, f, g, f * f and g * g, in that order.  The
+            vector lanes each keep their own partial sums, so the adds
+            inside a run are already spread out like a pairwise sum.
+
+*******************************************************************************/
+inline void CorrelationBlock(const double * f,
+                             const double * g,
+                             size_t count,
+                             double f_shift,
+                             double g_shift,
+                             double sums[5])
+{
+    size_t i = 0;
+
+#if defined(STATS_SIMD_AVX2)
+    const __m256d fshift = _mm256_set1_pd(f_shift);
+    const __m256d gshift = _mm256_set1_pd(g_shift);
+    __m256d fg = _mm256_setzero_pd();
+    __m256d fs = _mm256_setzero_pd();
+    __m256d gs = _mm256_setzero_pd();
+    __m256d ff = _mm256_setzero_pd();
+    __m256d gg = _mm256_setzero_pd();
+
+    for( ; i + 4 <= count ; i += 4)
+    {
+        const __m256d x = _mm256_sub_pd(_mm256_loadu_pd(f + i), fshift);
+        const __m256d y = _mm256_sub_pd(_mm256_loadu_pd(g + i), gshift);
+
+        fg = _mm256_add_pd(fg, _mm256_mul_pd(x, y));
+        fs = _mm256_add_pd(fs, x);
+        gs = _mm256_add_pd(gs, y);
+        ff = _mm256_add_pd(ff, _mm256_mul_pd(x, x));
+        gg = _mm256_add_pd(gg, _mm256_mul_pd(y, y));
+    }
+
+    double lanes[5][4];
+    _mm256_storeu_pd(lanes[0], fg);
+    _mm256_storeu_pd(lanes[1], fs);
+    _mm256_storeu_pd(lanes[2], gs);
+    _mm256_storeu_pd(lanes[3], ff);
+    _mm256_storeu_pd(lanes[4], gg);
+
+    for(int s = 0 ; s < 5 ; ++s)
+    {
+        sums[s] = (lanes[s][0] + lanes[s][1]) + (lanes[s][2] + lanes[s][3]);
+    }
+#elif defined(STATS_SIMD_SSE2)
+    const __m128d fshift = _mm_set1_pd(f_shift);
+    const __m128d gshift = _mm_set1_pd(g_shift);
+    __m128d fg = _mm_setzero_pd();
+    __m128d fs = _mm_setzero_pd();
+    __m128d gs = _mm_setzero_pd();
+    __m128d ff = _mm_setzero_pd();
+    __m128d gg = _mm_setzero_pd();
+
+    for( ; i + 2 <= count ; i += 2)
+    {
+        const __m128d x = _mm_sub_pd(_mm_loadu_pd(f + i), fshift);
+        const __m128d y = _mm_sub_pd(_mm_loadu_pd(g + i), gshift);
+
+        fg = _mm_add_pd(fg, _mm_mul_pd(x, y));
+        fs = _mm_add_pd(fs, x);
+        gs = _mm_add_pd(gs, y);
+        ff = _mm_add_pd(ff, _mm_mul_pd(x, x));
+        gg = _mm_add_pd(gg, _mm_mul_pd(y, y));
+    }
+
+    double lanes[5][2];
+    _mm_storeu_pd(lanes[0], fg);
+    _mm_storeu_pd(lanes[1], fs);
+    _mm_storeu_pd(lanes[2], gs);
+    _mm_storeu_pd(lanes[3], ff);
+    _mm_storeu_pd(lanes[4], gg);
+
+    for(int s = 0 ; s < 5 ; ++s)
+    {
+        sums[s] = lanes[s][0] + lanes[s][1];
+    }
+#else
+    for(int s = 0 ; s < 5 ; ++s) sums[s] = 0.0;
+#endif
+
+    // Whatever the vectors did not cover.
+    for( ; i < count ; ++i)
+    {
+        const double x = f[i] - f_shift;
+        const double y = g[i] - g_shift;
+
+        sums[0] += x * y;
+        sums[1] += x;
+        sums[2] += y;
+        sums[3] += x * x;
+        sums[4] += y * y;
+    }
+}
 
-        try
+/******************************************************************************/
+//
+/*! \brief  Plain sums over one short run of a single series less its
+            shift, x then x * x.
+
+*******************************************************************************/
+inline void SeriesBlock(const double * x,
+                        size_t count,
+                        double shift,
+                        double sums[2])
+{
+    size_t i = 0;
+
+#if defined(STATS_SIMD_AVX2)
+    const __m256d xshift = _mm256_set1_pd(shift);
+    __m256d xs = _mm256_setzero_pd();
+    __m256d xx = _mm256_setzero_pd();
+
+    for( ; i + 4 <= count ; i += 4)
+    {
+        const __m256d v = _mm256_sub_pd(_mm256_loadu_pd(x + i), xshift);
+        xs = _mm256_add_pd(xs, v);
+        xx = _mm256_add_pd(xx, _mm256_mul_pd(v, v));
+    }
+
+    double lanes[2][4];
+    _mm256_storeu_pd(lanes[0], xs);
+    _mm256_storeu_pd(lanes[1], xx);
+
+    for(int s = 0 ; s < 2 ; ++s)
+    {
+        sums[s] = (lanes[s][0] + lanes[s][1]) + (lanes[s][2] + lanes[s][3]);
+    }
+#elif defined(STATS_SIMD_SSE2)
+    const __m128d xshift = _mm_set1_pd(shift);
+    __m128d xs = _mm_setzero_pd();
+    __m128d xx = _mm_setzero_pd();
+
+    for( ; i + 2 <= count ; i += 2)
+    {
+        const __m128d v = _mm_sub_pd(_mm_loadu_pd(x + i), xshift);
+        xs = _mm_add_pd(xs, v);
+        xx = _mm_add_pd(xx, _mm_mul_pd(v, v));
+    }
+
+    double lanes[2][2];
+    _mm_storeu_pd(lanes[0], xs);
+    _mm_storeu_pd(lanes[1], xx);
+
+    for(int s = 0 ; s < 2 ; ++s) sums[s] = lanes[s][0] + lanes[s][1];
+#else
+    sums[0] = 0.0;
+    sums[1] = 0.0;
+#endif
+
+    for( ; i < count ; ++i)
+    {
+        const double v = x[i] - shift;
+        sums[0] += v;
+        sums[1] += v * v;
+    }
+}
+
+/******************************************************************************/
+//
+/*! \brief  Pearson correlation of f_func and g_func.
+
+            The shorter series counts as zero past its end, but the count
+            is the longer size.  One pass, split into the range both series
+            cover and the tail only the longer one covers.  Each range is
+            summed in short vector runs, and the runs are added up with
+            compensation, so long series keep their accuracy.  Each series
+            is summed less its first sample, which leaves the correlation
+            alone but keeps the squares small for series far from zero.
+
+*******************************************************************************/
+inline double Correlation(const std::vector<double> & f_func,
+                          const std::vector<double> & g_func)
+{
+    const size_t max_size = std::max(f_func.size(), g_func.size());
+    const size_t common = std::min(f_func.size(), g_func.size());
+
+    const double f_shift = f_func.empty() ? 0.0 : f_func[0];
+    const double g_shift = g_func.empty() ? 0.0 : g_func[0];
+
+    // sumPaired, fsum, gsum, fsqed_sums and gsqed_sums, with their carries.
+    double sums[5] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+    double carries[5] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+    double block[5];
+
+    for(size_t start = 0 ; start < common ; start += CORRELATION_BLOCK)
+    {
+        const size_t count = std::min((size_t) CORRELATION_BLOCK,
+                                      common - start);
+
+        CorrelationBlock(&f_func[start],
+                         &g_func[start],
+                         count,
+                         f_shift,
+                         g_shift,
+                         block);
+        for(int s = 0 ; s < 5 ; ++s)
         {
-            gsqed_sums += g_func.at(n) * g_func.at(n);
+            CompensatedAdd(sums[s], carries[s], block[s]);
         }
-        catch(...) {}
     }
 
+    // The tail of the longer series, into its sum and its squares.
+    const bool f_longer = f_func.size() > common;
+    const std::vector<double> & longer = f_longer ? f_func : g_func;
+    const double longer_shift = f_longer ? f_shift : g_shift;
+    const int sum_index = f_longer ? 1 : 2;
+    const int square_index = sum_index + 2;
+
+    double tail_sum = 0.0;
+    double tail_carry = 0.0;
+    for(size_t start = common ; start < max_size ; start += CORRELATION_BLOCK)
+    {
+        const size_t count = std::min((size_t) CORRELATION_BLOCK,
+                                      max_size - start);
+
+        SeriesBlock(&longer[start], count, longer_shift, block);
+        CompensatedAdd(tail_sum, tail_carry, block[0]);
+        CompensatedAdd(sums[square_index], carries[square_index], block[1]);
+    }
+
+    // Past its end the shorter series is zero, so less its shift it is
+    // the same constant for every sample of the tail.
+    if(max_size > common)
+    {
+        const double tail = tail_sum + tail_carry;
+        const double shorter = -(f_longer ? g_shift : f_shift);
+        const double count = (double) (max_size - common);
+
+        CompensatedAdd(sums[sum_index], carries[sum_index], tail);
+        CompensatedAdd(sums[0], carries[0], shorter * tail);
+        CompensatedAdd(sums[3 - sum_index],
+                       carries[3 - sum_index],
+                       shorter * count);
+        CompensatedAdd(sums[5 - sum_index],
+                       carries[5 - sum_index],
+                       shorter * shorter * count);
+    }
+
+    const double size = (double) max_size;
+    const double sumPaired = sums[0] + carries[0];
+    const double fsum = sums[1] + carries[1];
+    const double gsum = sums[2] + carries[2];
+    const double fsqed_sums = sums[3] + carries[3];
+    const double gsqed_sums = sums[4] + carries[4];
+
     double fsum_sq = fsum * fsum;
     double gsum_sq = gsum * gsum;
 
-    double score = ((max_size * sumPaired) - (fsum * gsum)) /
-                   (sqrt(((max_size * fsqed_sums) - fsum_sq) *
-                         ((max_size * gsqed_sums) - gsum_sq)));
+    double score = ((size * sumPaired) - (fsum * gsum)) /
+                   (sqrt(((size * fsqed_sums) - fsum_sq) *
+                         ((size * gsqed_sums) - gsum_sq)));
 
     return score;
 }
+
+/******************************************************************************/
+//
+/*! \class  CorrelationAccumulator
+
+    \brief  Pearson correlation of pairs that arrive one at a time.
+
+            Keeps the count, the means and the co-moments, updated by
+            Welford's method, so memory does not grow with the series and
+            no sum is ever squared.  Accumulators filled on different
+            threads are combined with Merge() (Chan et al.) and give the
+            same value as one accumulator fed every pair.  One accumulator
+            is not safe to share between threads, give each thread its
+            own.
+
+*******************************************************************************/
+class CorrelationAccumulator
+{
+public:
+
+    // Constructor, no pairs yet.
+    CorrelationAccumulator()
+    {
+        Clear();
+    }
+
+    // Forgets every pair.
+    void Clear()
+    {
+        _count = 0;
+        _fmean = 0.0;
+        _gmean = 0.0;
+        _fm2 = 0.0;
+        _gm2 = 0.0;
+        _comoment = 0.0;
+    }
+
+    // Adds one pair.
+    void Push(double f_value, double g_value)
+    {
+        ++_count;
+        const double count = (double) _count;
+
+        const double fdelta = f_value - _fmean;
+        const double gdelta = g_value - _gmean;
+        _fmean += fdelta / count;
+        _gmean += gdelta / count;
+
+        // One delta from before the mean moved, one from after.
+        _fm2 += fdelta * (f_value - _fmean);
+        _gm2 += gdelta * (g_value - _gmean);
+        _comoment += fdelta * (g_value - _gmean);
+    }
+
+    // Adds every pair another accumulator has seen.
+    void Merge(const CorrelationAccumulator & other)
+    {
+        if(other._count == 0) return;
+        if(_count == 0)
+        {
+            *this = other;
+            return;
+        }
+
+        const double count = (double) _count;
+        const double other_count = (double) other._count;
+        const double total = count + other_count;
+
+        const double fdelta = other._fmean - _fmean;
+        const double gdelta = other._gmean - _gmean;
+        const double weight = count * other_count / total;
+
+        _fmean += fdelta * other_count / total;
+        _gmean += gdelta * other_count / total;
+        _fm2 += other._fm2 + fdelta * fdelta * weight;
+        _gm2 += other._gm2 + gdelta * gdelta * weight;
+        _comoment += other._comoment + fdelta * gdelta * weight;
+        _count += other._count;
+    }
+
+    // The correlation of the pairs so far, NaN while either series has no
+    // spread, as Correlation() gives.
+    double Value() const
+    {
+        return _comoment / sqrt(_fm2 * _gm2);
+    }
+
+    // Pairs seen.
+    unsigned long long Count() const
+    {
+        return _count;
+    }
+
+private:
+
+    unsigned long long _count;
+
+    double _fmean;
+    double _gmean;
+
+    // Sums of squared deviations, and of the deviation products.
+    double _fm2;
+    double _gm2;
+    double _comoment;
+};
 }
 #endif
 
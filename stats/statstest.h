@@ -0,0 +1,231 @@
+/******************************************************************************/
+//
+/*! \file
+
+    \brief  Executes a test on the correlations in stats.h, against plain
+            sums written the way the definitions read.
+
+*******************************************************************************/
+
+#ifndef STATS_TEST_H
+#define STATS_TEST_H
+
+// Standard library dependencies.
+#include <cmath>
+#include <vector>
+#include <complex>
+#include <cassert>
+#include <cstddef>
+
+#include "stats.h"
+
+namespace Stats
+{
+/******************************************************************************/
+//
+/*! \brief  Small deterministic generator, uniform in [-1, 1).
+
+*******************************************************************************/
+inline double StatsTestRandom(unsigned long & state)
+{
+    state = state * 1103515245ul + 12345ul;
+    return (double) ((state >> 8) & 0xFFFFFFul) / (double) 0x800000ul - 1.0;
+}
+
+/******************************************************************************/
+//
+/*! \brief  A series of size samples around offset.
+
+*******************************************************************************/
+inline std::vector<double> StatsTestSeries(unsigned long & state,
+                                           size_t size,
+                                           double offset)
+{
+    std::vector<double> series(size);
+    for(size_t i = 0 ; i < size ; ++i)
+    {
+        series[i] = offset + StatsTestRandom(state);
+    }
+
+    return series;
+}
+
+/******************************************************************************/
+//
+/*! \brief  Pearson correlation in two passes, long double, the shorter
+            series zero past its end as Correlation() has it.
+
+*******************************************************************************/
+inline double StatsTestCorrelation(const std::vector<double> & f_func,
+                                   const std::vector<double> & g_func)
+{
+    const size_t size = std::max(f_func.size(), g_func.size());
+
+    long double fmean = 0.0;
+    long double gmean = 0.0;
+    for(size_t i = 0 ; i < size ; ++i)
+    {
+        fmean += i < f_func.size() ? f_func[i] : 0.0;
+        gmean += i < g_func.size() ? g_func[i] : 0.0;
+    }
+    fmean /= (long double) size;
+    gmean /= (long double) size;
+
+    long double fm2 = 0.0;
+    long double gm2 = 0.0;
+    long double comoment = 0.0;
+    for(size_t i = 0 ; i < size ; ++i)
+    {
+        const long double f = (i < f_func.size() ? f_func[i] : 0.0) - fmean;
+        const long double g = (i < g_func.size() ? g_func[i] : 0.0) - gmean;
+        fm2 += f * f;
+        gm2 += g * g;
+        comoment += f * g;
+    }
+
+    return (double) (comoment / sqrtl(fm2 * gm2));
+}
+
+/******************************************************************************/
+//
+/*! \brief  FFT round trip, and CrossCorrelation() against the direct sums
+            on both sides of the FFT cut over.
+
+*******************************************************************************/
+inline void ExecuteCrossCorrelationTest()
+{
+    unsigned long state = 1;
+
+    std::vector<std::complex<double> > signal(256);
+    for(size_t i = 0 ; i < signal.size() ; ++i)
+    {
+        signal[i] = std::complex<double>(StatsTestRandom(state),
+                                         StatsTestRandom(state));
+    }
+
+    std::vector<std::complex<double> > transformed = signal;
+    FFT(transformed, false);
+    FFT(transformed, true);
+    for(size_t i = 0 ; i < signal.size() ; ++i)
+    {
+        assert(std::abs(transformed[i] - signal[i]) < 1e-12);
+    }
+
+    const size_t sizes[][2] =
+    {
+        { 1, 1 }, { 3, 5 }, { 31, 31 }, { 32, 40 }, { 33, 17 },
+        { 100, 100 }, { 1000, 250 }, { 4097, 4096 }, { 5000, 60 }
+    };
+
+    for(size_t c = 0 ; c < sizeof(sizes) / sizeof(sizes[0]) ; ++c)
+    {
+        const std::vector<double> f_func =
+            StatsTestSeries(state, sizes[c][0], 0.5);
+        const std::vector<double> g_func =
+            StatsTestSeries(state, sizes[c][1], -0.25);
+
+        std::vector<double> direct;
+        std::vector<double> fast;
+        std::vector<double> chosen;
+        CrossCorrelationDirect(f_func, g_func, direct);
+        CrossCorrelationFFT(f_func, g_func, fast);
+        CrossCorrelation(f_func, g_func, chosen);
+
+        assert(direct.size() == std::max(sizes[c][0], sizes[c][1]));
+        assert(fast.size() == direct.size() && chosen.size() == direct.size());
+
+        // Each lag sums at most the shorter size of products up to 2.25.
+        const double tolerance =
+            1e-12 * 2.25 * (double) std::min(sizes[c][0], sizes[c][1]);
+        for(size_t n = 0 ; n < direct.size() ; ++n)
+        {
+            assert(fabs(fast[n] - direct[n]) <= tolerance);
+            assert(fabs(chosen[n] - direct[n]) <= tolerance);
+        }
+    }
+}
+
+/******************************************************************************/
+//
+/*! \brief  Correlation() against the two pass reference.
+            Some series are far from zero, where one pass sums lose the most.
+            CorrelationAccumulator is checked on a million pairs, pushed
+            whole and in four merged parts.
+
+*******************************************************************************/
+inline void ExecuteCorrelationTest()
+{
+    unsigned long state = 2;
+
+    const size_t sizes[][2] =
+    {
+        { 2, 2 }, { 7, 3 }, { 1023, 1025 }, { 4096, 4096 }, { 10000, 9000 }
+    };
+
+    const double offsets[] =
+    {
+        1e6,
+        0.5
+    };
+
+    for(size_t o = 0 ; o < sizeof(offsets) / sizeof(offsets[0]) ; ++o)
+    {
+        for(size_t c = 0 ; c < sizeof(sizes) / sizeof(sizes[0]) ; ++c)
+        {
+            const double offset = offsets[o];
+            std::vector<double> f_func =
+                StatsTestSeries(state, sizes[c][0], offset);
+            std::vector<double> g_func =
+                StatsTestSeries(state, sizes[c][1], offset);
+
+            // Tie g to f so the correlation is well away from zero.
+            const size_t common = std::min(f_func.size(), g_func.size());
+            for(size_t i = 0 ; i < common ; ++i)
+            {
+                g_func[i] += f_func[i] - offset;
+            }
+
+            const double expected = StatsTestCorrelation(f_func, g_func);
+            assert(fabs(Correlation(f_func, g_func) - expected) < 1e-9);
+        }
+    }
+
+    // A million pairs, pushed in four parts and merged, against one pass.
+    const size_t pairs = 1000000;
+    std::vector<double> f_func = StatsTestSeries(state, pairs, 1e6);
+    std::vector<double> g_func = StatsTestSeries(state, pairs, 1e6);
+    for(size_t i = 0 ; i < pairs ; ++i) g_func[i] += 0.5 * (f_func[i] - 1e6);
+
+    CorrelationAccumulator whole;
+    CorrelationAccumulator parts[4];
+    for(size_t i = 0 ; i < pairs ; ++i)
+    {
+        whole.Push(f_func[i], g_func[i]);
+        parts[i * 4 / pairs].Push(f_func[i], g_func[i]);
+    }
+
+    CorrelationAccumulator merged;
+    for(size_t p = 0 ; p < 4 ; ++p) merged.Merge(parts[p]);
+
+    const double expected = StatsTestCorrelation(f_func, g_func);
+    assert(whole.Count() == pairs && merged.Count() == pairs);
+    assert(fabs(whole.Value() - expected) < 1e-9);
+    assert(fabs(merged.Value() - expected) < 1e-9);
+    assert(fabs(Correlation(f_func, g_func) - expected) < 1e-9);
+
+    merged.Clear();
+    assert(merged.Count() == 0);
+}
+
+/******************************************************************************/
+//
+/*! \brief  Executes every stats test.
+
+*******************************************************************************/
+inline void ExecuteStatsTest()
+{
+    ExecuteCrossCorrelationTest();
+    ExecuteCorrelationTest();
+}
+}
+#endif
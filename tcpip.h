@@ -8,3 +8,4 @@
  
 *******************************************************************************/ 
 // Include for all tcpip headers.
+#include "tcpip/socket.h"
@@ -0,0 +1,295 @@
+/******************************************************************************/
+//
+/*! \brief  Blocking TCP socket over BSD sockets, or Winsock on windows.
+            Every call either does all of its work or throws, except the
+            receives, which report the peer closing as a short read.  Link
+            with ws2_32 on windows.
+
+*******************************************************************************/
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+
+#ifdef _WIN32
+   #include <winsock2.h>
+   #include <ws2tcpip.h>
+   #ifdef _MSC_VER
+      #pragma comment(lib, "ws2_32.lib")
+   #endif
+#else
+   #include <unistd.h>
+   #include <netdb.h>
+   #include <sys/types.h>
+   #include <sys/socket.h>
+   #include <netinet/in.h>
+   #include <netinet/tcp.h>
+   #include <arpa/inet.h>
+#endif
+
+/******************************************************************************/
+//
+/*! \namespace  TcpIp
+
+    \brief      TCP/IP wrappers.
+
+*******************************************************************************/
+namespace TcpIp
+{
+#ifdef _WIN32
+   typedef SOCKET Handle;
+   const Handle INVALID_HANDLE = INVALID_SOCKET;
+#else
+   typedef int Handle;
+   const Handle INVALID_HANDLE = -1;
+#endif
+
+/******************************************************************************/
+//
+/*! \class  Socket
+
+    \brief  Owns one socket handle, closed when the object is destroyed.
+
+*******************************************************************************/
+class Socket
+{
+public:
+
+   // Constructor, no socket yet.
+   Socket ()
+      : _handle(INVALID_HANDLE)
+   {
+      Startup();
+   }
+
+   // Destructor.
+   ~Socket ()
+   {
+      Close();
+   }
+
+   // Connects to a host and port, throws if it cannot.
+   void Connect (const char * host, unsigned short port)
+   {
+      Close();
+
+      addrinfo hints;
+      std::memset(&hints, 0, sizeof(hints));
+      hints.ai_family = AF_INET;
+      hints.ai_socktype = SOCK_STREAM;
+      hints.ai_protocol = IPPROTO_TCP;
+
+      addrinfo * found = 0;
+      if(getaddrinfo(host, 0, &hints, &found) != 0 || found == 0)
+      {
+         throw std::exception();
+      }
+
+      sockaddr_in address;
+      std::memcpy(&address, found->ai_addr, sizeof(address));
+      address.sin_port = htons(port);
+      freeaddrinfo(found);
+
+      _handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+      if(_handle == INVALID_HANDLE) throw std::exception();
+
+      if(connect(_handle, (sockaddr *) &address, sizeof(address)) != 0)
+      {
+         Close();
+         throw std::exception();
+      }
+   }
+
+   // Listens on a port, zero picks a free one.  Loopback only unless told
+   // otherwise.
+   void Listen (unsigned short port, bool loopbackOnly = true,
+                int backlog = SOMAXCONN)
+   {
+      Close();
+
+      _handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+      if(_handle == INVALID_HANDLE) throw std::exception();
+
+      // A restarted server can take its port straight back.
+      int reuse = 1;
+      setsockopt(_handle, SOL_SOCKET, SO_REUSEADDR,
+                 (const char *) &reuse, sizeof(reuse));
+
+      sockaddr_in address;
+      std::memset(&address, 0, sizeof(address));
+      address.sin_family = AF_INET;
+      address.sin_port = htons(port);
+      address.sin_addr.s_addr = htonl(loopbackOnly ? INADDR_LOOPBACK
+                                                   : INADDR_ANY);
+
+      if(bind(_handle, (sockaddr *) &address, sizeof(address)) != 0 ||
+         listen(_handle, backlog) != 0)
+      {
+         Close();
+         throw std::exception();
+      }
+   }
+
+   // Waits for a connection and hands it to client.  A signal, or a client
+   // that gave up before it was accepted, is waited through.  False on any
+   // other failure, the listener being interrupted or closed or the process
+   // being out of handles, and the caller decides whether to try again.
+   bool Accept (Socket & client)
+   {
+      client.Close();
+
+      while(true)
+      {
+         const Handle accepted = accept(_handle, 0, 0);
+         if(accepted != INVALID_HANDLE)
+         {
+            client._handle = accepted;
+            return true;
+         }
+
+#ifdef _WIN32
+         const int error = WSAGetLastError();
+         if(error != WSAEINTR && error != WSAECONNRESET) return false;
+#else
+         if(errno != EINTR && errno != ECONNABORTED && errno != EPROTO)
+         {
+            return false;
+         }
+#endif
+      }
+   }
+
+   // The local port, for a socket listening on port zero.
+   unsigned short GetPort () const
+   {
+      sockaddr_in address;
+#ifdef _WIN32
+      int size = sizeof(address);
+#else
+      socklen_t size = sizeof(address);
+#endif
+      if(getsockname(_handle, (sockaddr *) &address, &size) != 0)
+      {
+         throw std::exception();
+      }
+
+      return ntohs(address.sin_port);
+   }
+
+   // Turns off Nagle, so small frames go out straight away.
+   void SetNoDelay (bool noDelay)
+   {
+      int flag = noDelay ? 1 : 0;
+      setsockopt(_handle, IPPROTO_TCP, TCP_NODELAY,
+                 (const char *) &flag, sizeof(flag));
+   }
+
+   // Sends every byte, throws if the connection fails.
+   void SendAll (const void * data, size_t size)
+   {
+      const char * bytes = (const char *) data;
+      while(size > 0)
+      {
+         const int chunk = size > 65536 ? 65536 : (int) size;
+         const int sent = send(_handle, bytes, chunk, SEND_FLAGS);
+         if(sent <= 0) throw std::exception();
+
+         bytes += sent;
+         size -= (size_t) sent;
+      }
+   }
+
+   // Receives what is there, up to size.  Zero when the peer has closed.
+   size_t Receive (void * data, size_t size)
+   {
+      const int chunk = size > 65536 ? 65536 : (int) size;
+      const int received = recv(_handle, (char *) data, chunk, 0);
+
+      return received > 0 ? (size_t) received : 0;
+   }
+
+   // Receives exactly size bytes, false if the peer closed first.
+   bool ReceiveAll (void * data, size_t size)
+   {
+      char * bytes = (char *) data;
+      while(size > 0)
+      {
+         const size_t received = Receive(bytes, size);
+         if(received == 0) return false;
+
+         bytes += received;
+         size -= received;
+      }
+
+      return true;
+   }
+
+   // Stops both directions, waking a thread blocked in Accept() or a
+   // receive.  The handle stays valid until Close().
+   void Interrupt ()
+   {
+      if(_handle == INVALID_HANDLE) return;
+
+#ifdef _WIN32
+      // Winsock does not wake accept() on shutdown, only on close.
+      if(shutdown(_handle, SD_BOTH) != 0)
+      {
+         closesocket(_handle);
+         _handle = INVALID_HANDLE;
+      }
+#else
+      shutdown(_handle, SHUT_RDWR);
+#endif
+   }
+
+   // Closes the socket.
+   void Close ()
+   {
+      if(_handle == INVALID_HANDLE) return;
+
+#ifdef _WIN32
+      closesocket(_handle);
+#else
+      close(_handle);
+#endif
+      _handle = INVALID_HANDLE;
+   }
+
+   bool IsOpen () const
+   {
+      return _handle != INVALID_HANDLE;
+   }
+
+private:
+
+   // Not copyable, the handle has one owner.
+   Socket (const Socket &);
+   Socket & operator= (const Socket &);
+
+#ifdef _WIN32
+   enum { SEND_FLAGS = 0 };
+#else
+   // A peer that has gone must not kill the process with SIGPIPE.
+   enum { SEND_FLAGS = MSG_NOSIGNAL };
+#endif
+
+   // Starts Winsock once per process.
+   static void Startup ()
+   {
+#ifdef _WIN32
+      static bool started = false;
+      if(!started)
+      {
+         WSADATA data;
+         if(WSAStartup(MAKEWORD(2, 2), &data) != 0) throw std::exception();
+         started = true;
+      }
+#endif
+   }
+
+   Handle _handle;
+};
+}
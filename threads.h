@@ -8,8 +8,11 @@
  
 *******************************************************************************/
 
-// Include for all windows thread headers.
+// Include for all windows or posix thread headers.
 #ifdef _WIN32
    #include "threads/winthreads/winthread.h"
    #include "threads/winthreads/synchronization.h"
+#else
+   #include "threads/posixthreads/posixthread.h"
+   #include "threads/posixthreads/synchronization.h"
 #endif
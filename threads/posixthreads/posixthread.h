@@ -0,0 +1,97 @@
+/******************************************************************************/
+//
+/*! \brief  Posix thread with the same interface as WinThread::Thread.  The
+            thread is created suspended, Resume() starts it.  Link with
+            -pthread.
+
+*******************************************************************************/
+
+#pragma once
+
+#include <pthread.h>
+#include <exception>
+#include "synchronization.h"
+
+/******************************************************************************/
+//
+/*! \namespace  PosixThread
+
+    \brief      Posix counterpart of the WinThread namespace.
+
+*******************************************************************************/
+namespace PosixThread
+{
+/******************************************************************************/
+//
+/*! \class  Thread
+
+    \brief
+
+*******************************************************************************/
+class Thread
+{
+public:
+
+   Thread (void * (* pFun)(void * arg))
+      : _pFun(pFun), _pArg(reinterpret_cast<void *>(this)), _started(false)
+   {}
+
+   Thread (void * (* pFun)(void * arg), void * pArg)
+      : _pFun(pFun), _pArg(pArg), _started(false)
+   {}
+
+   ~Thread ()
+   {
+      // A thread that was started must be joined before it is released.
+      WaitForThreadToDie();
+   }
+
+   void Resume ()
+   {
+      if(_started) return;
+
+      if(pthread_create (&_tid, 0, _pFun, _pArg) != 0)
+      {
+         throw std::exception();
+      }
+
+      _started = true;
+   }
+
+   void SetExecutionCompleteEvent ()
+   {
+      // Joining is enough to know the thread is done, kept so code can be
+      // written once for both thread types.
+   }
+
+   void WaitForThreadToDie ()
+   {
+      if(IsThreadActive())
+      {
+         pthread_join (_tid, 0);
+         _started = false;
+      }
+   }
+
+   bool IsThreadActive ()
+   {
+      return _started;
+   }
+
+private:
+
+   // Not copyable, the thread id has one owner.
+   Thread (const Thread &);
+   Thread & operator= (const Thread &);
+
+   // Thread function and its argument, kept until Resume().
+   void * (* _pFun)(void * arg);
+   void * _pArg;
+
+   // thread id.
+   pthread_t _tid;
+
+   // True from Resume() until the thread is joined.
+   bool _started;
+};
+}
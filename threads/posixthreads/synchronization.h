@@ -0,0 +1,199 @@
+/******************************************************************************/
+//
+/*! \brief  Utility for synchronizing threads in posix applications, using
+            pthread_mutex_t.  Same interface as the windows version, create a
+            Mutex object for the memory to protect and a Lock object in the
+            scope of each thread critical operation.
+
+            {
+               Lock lockObj(MyVariableMutex);
+
+               ++Variable;
+            }
+
+*******************************************************************************/
+
+#pragma once
+
+#include <ctime>
+#include <cerrno>
+#include <pthread.h>
+#include <exception>
+
+/******************************************************************************/
+//
+/*! \namespace  PosixThread
+
+    \brief      Posix counterpart of the WinThread namespace.
+
+*******************************************************************************/
+namespace PosixThread
+{
+/******************************************************************************/
+//
+/*! \class  Mutex
+
+    \brief  It is equivalent to the pthread_mutex_t object.  To use, just
+            instantiate Mutex to aquire a pthread_mutex_t.
+
+*******************************************************************************/
+class Mutex
+{
+   friend class Lock;
+
+public:
+
+   // Constructor.
+   Mutex ()
+   {
+      if(pthread_mutex_init (& _mutex, 0) != 0) throw std::exception();
+   }
+
+   // Destructor.
+   ~Mutex ()
+   {
+      pthread_mutex_destroy (& _mutex);
+   }
+
+private:
+
+   // Not copyable, the mutex lives where it was initialized.
+   Mutex (const Mutex &);
+   Mutex & operator= (const Mutex &);
+
+   // This is called when the mutex is needed to be locked.
+   void Acquire ()
+   {
+      if(pthread_mutex_lock (& _mutex) != 0) throw std::exception();
+   }
+
+   // This is called when the mutex is needed to be released.
+   void Release ()
+   {
+      pthread_mutex_unlock (& _mutex);
+   }
+
+   pthread_mutex_t _mutex;
+};
+
+/******************************************************************************/
+//
+/*! \class  Lock
+
+    \brief  This object is a mechanism for locking a Mutex.  To use just
+            instantiate the object, with the corresponding Mutex in the
+            as the parameter in the constructor.  This will automatically lock.
+            When the lock object is destroyed, then the Mutex is released.
+
+*******************************************************************************/
+class Lock
+{
+public:
+
+   // Acquire the mutex.
+   Lock ( Mutex & mutex )
+      : _mutex(mutex)
+   {
+      _mutex.Acquire();
+   }
+
+   // Release the mutex.
+   ~Lock ()
+   {
+      _mutex.Release();
+   }
+
+private:
+
+   // Mutex passed in the constructor.
+   Mutex & _mutex;
+};
+
+/******************************************************************************/
+//
+/*! \class  Event
+
+    \brief  Auto reset event, the posix counterpart of a windows event made
+            with CreateEvent(0, FALSE, FALSE, 0).  Set() wakes one thread in
+            Wait(), and is remembered if no thread is waiting yet.
+
+*******************************************************************************/
+class Event
+{
+public:
+
+   // Constructor, not set.
+   Event ()
+      : _set(false)
+   {
+      if(pthread_mutex_init (& _mutex, 0) != 0) throw std::exception();
+      if(pthread_cond_init (& _condition, 0) != 0)
+      {
+         pthread_mutex_destroy (& _mutex);
+         throw std::exception();
+      }
+   }
+
+   // Destructor.
+   ~Event ()
+   {
+      pthread_cond_destroy (& _condition);
+      pthread_mutex_destroy (& _mutex);
+   }
+
+   // Sets the event, waking one waiting thread.
+   void Set ()
+   {
+      pthread_mutex_lock (& _mutex);
+      _set = true;
+      pthread_cond_signal (& _condition);
+      pthread_mutex_unlock (& _mutex);
+   }
+
+   // Waits until the event is set, then clears it.
+   void Wait ()
+   {
+      pthread_mutex_lock (& _mutex);
+      while(!_set) pthread_cond_wait (& _condition, & _mutex);
+      _set = false;
+      pthread_mutex_unlock (& _mutex);
+   }
+
+   // Waits up to milliseconds for the event, then clears it.  False if the
+   // time ran out first.
+   bool Wait (unsigned long milliseconds)
+   {
+      timespec deadline;
+      clock_gettime (CLOCK_REALTIME, & deadline);
+      deadline.tv_sec += (time_t) (milliseconds / 1000);
+      deadline.tv_nsec += (long) (milliseconds % 1000) * 1000000L;
+      if(deadline.tv_nsec >= 1000000000L)
+      {
+         ++deadline.tv_sec;
+         deadline.tv_nsec -= 1000000000L;
+      }
+
+      pthread_mutex_lock (& _mutex);
+      while(!_set)
+      {
+         if(pthread_cond_timedwait (& _condition, & _mutex, & deadline) ==
+            ETIMEDOUT) break;
+      }
+      const bool set = _set;
+      _set = false;
+      pthread_mutex_unlock (& _mutex);
+
+      return set;
+   }
+
+private:
+
+   // Not copyable, the condition lives where it was initialized.
+   Event (const Event &);
+   Event & operator= (const Event &);
+
+   pthread_mutex_t _mutex;
+   pthread_cond_t _condition;
+   bool _set;
+};
+}
@@ -140,4 +140,57 @@ private:
    // Mutex passed in the constructor.
    Mutex & _mutex;
 };
+
+/******************************************************************************/
+//
+/*! \class  Event
+
+    \brief  Auto reset event.  Set() wakes one thread in Wait(), and is
+            remembered if no thread is waiting yet.
+
+*******************************************************************************/
+class Event
+{
+public:
+
+   // Constructor, not set.
+   Event ()
+   {
+      _event = CreateEvent(NULL, FALSE, FALSE, NULL);
+      if(_event == NULL) throw std::exception("Create Failed.");
+   }
+
+   // Destructor.
+   ~Event ()
+   {
+      CloseHandle (_event);
+   }
+
+   // Sets the event, waking one waiting thread.
+   void Set ()
+   {
+      SetEvent (_event);
+   }
+
+   // Waits until the event is set, then clears it.
+   void Wait ()
+   {
+      WaitForSingleObject (_event, INFINITE);
+   }
+
+   // Waits up to milliseconds for the event, then clears it.  False if the
+   // time ran out first.
+   bool Wait (unsigned long milliseconds)
+   {
+      return WaitForSingleObject (_event, milliseconds) == WAIT_OBJECT_0;
+   }
+
+private:
+
+   // Not copyable, owns the handle.
+   Event (const Event &);
+   Event & operator= (const Event &);
+
+   HANDLE _event;
+};
 }